@@ -0,0 +1,166 @@
+// Per-call overhead of OpenVerifyFile on the data path, against calling the native file directly
+// and against the previous wrapper (an out-of-line forward with a trace line per call, filtered
+// out at the default log level), with OpenVerifyIoTrace off and sampling one call in 100.
+//
+// Usage: openverify_file_bench [calls]
+// The native file is a stub XrdSfsFile whose data calls return immediately, so the numbers are
+// the wrapper's own cost. Every call goes through an XrdSfsFile*, as it does from the protocol.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+#include "XrdOfsOpenVerify.hh"
+
+namespace {
+
+class StubFile : public XrdSfsFile {
+   public:
+    int open(const char*, XrdSfsFileOpenMode, mode_t, const XrdSecEntity*, const char*) override { return SFS_OK; }
+    int close() override { return SFS_OK; }
+    int fctl(const int, const char*, XrdOucErrInfo&) override { return SFS_OK; }
+    const char* FName() override { return "/store/data/file.root"; }
+    int getMmap(void**, off_t&) override { return SFS_ERROR; }
+    XrdSfsXferSize pgRead(XrdSfsFileOffset, char*, XrdSfsXferSize rdlen, uint32_t*, uint64_t) override {
+        return rdlen;
+    }
+    int read(XrdSfsFileOffset, XrdSfsXferSize) override { return SFS_OK; }
+    XrdSfsXferSize read(XrdSfsFileOffset, char*, XrdSfsXferSize buffer_size) override { return buffer_size; }
+    int read(XrdSfsAio*) override { return SFS_OK; }
+    XrdSfsXferSize write(XrdSfsFileOffset, const char*, XrdSfsXferSize buffer_size) override { return buffer_size; }
+    int write(XrdSfsAio*) override { return SFS_OK; }
+    int sync() override { return SFS_OK; }
+    int sync(XrdSfsAio*) override { return SFS_OK; }
+    int stat(struct stat*) override { return SFS_OK; }
+    int truncate(XrdSfsFileOffset) override { return SFS_OK; }
+    int getCXinfo(char[4], int& cxrsz) override {
+        cxrsz = 0;
+        return SFS_OK;
+    }
+    int SendData(XrdSfsDio*, XrdSfsFileOffset, XrdSfsXferSize size) override { return size; }
+};
+
+// The previous wrapper's data path: every forward out of line, each with its trace line.
+class TracedWrapper : public XrdSfsFile {
+   public:
+    TracedWrapper(XrdSfsFile* wrapped, OpenVerifyLog& log)
+        : XrdSfsFile(wrapped->error), m_wrapped(wrapped), m_log(log) {}
+
+    int open(const char*, XrdSfsFileOpenMode, mode_t, const XrdSecEntity*, const char*) override;
+    int close() override;
+    int fctl(const int, const char*, XrdOucErrInfo&) override;
+    const char* FName() override;
+    int getMmap(void**, off_t&) override;
+    XrdSfsXferSize pgRead(XrdSfsFileOffset offset, char* buffer, XrdSfsXferSize rdlen, uint32_t* csvec,
+                          uint64_t opts) override;
+    int read(XrdSfsFileOffset, XrdSfsXferSize) override;
+    XrdSfsXferSize read(XrdSfsFileOffset offset, char* buffer, XrdSfsXferSize buffer_size) override;
+    int read(XrdSfsAio*) override;
+    XrdSfsXferSize write(XrdSfsFileOffset, const char*, XrdSfsXferSize) override;
+    int write(XrdSfsAio*) override;
+    int sync() override;
+    int sync(XrdSfsAio*) override;
+    int stat(struct stat*) override;
+    int truncate(XrdSfsFileOffset) override;
+    int getCXinfo(char[4], int&) override;
+    int SendData(XrdSfsDio* sfDio, XrdSfsFileOffset offset, XrdSfsXferSize size) override;
+
+   private:
+    XrdSfsFile* m_wrapped;
+    OpenVerifyLog& m_log;
+};
+
+int TracedWrapper::open(const char* n, XrdSfsFileOpenMode m, mode_t c, const XrdSecEntity* e, const char* o) {
+    return m_wrapped->open(n, m, c, e, o);
+}
+int TracedWrapper::close() { return m_wrapped->close(); }
+int TracedWrapper::fctl(const int cmd, const char* args, XrdOucErrInfo& ei) { return m_wrapped->fctl(cmd, args, ei); }
+const char* TracedWrapper::FName() { return m_wrapped->FName(); }
+int TracedWrapper::getMmap(void** addr, off_t& size) { return m_wrapped->getMmap(addr, size); }
+XrdSfsXferSize TracedWrapper::pgRead(XrdSfsFileOffset offset, char* buffer, XrdSfsXferSize rdlen, uint32_t* csvec,
+                                     uint64_t opts) {
+    m_log.Debug("FileWrapper::pgRead(offset, buffer)");
+    return m_wrapped->pgRead(offset, buffer, rdlen, csvec, opts);
+}
+int TracedWrapper::read(XrdSfsFileOffset offset, XrdSfsXferSize amount) { return m_wrapped->read(offset, amount); }
+XrdSfsXferSize TracedWrapper::read(XrdSfsFileOffset offset, char* buffer, XrdSfsXferSize buffer_size) {
+    m_log.Debug("FileWrapper::read(offset, buffer)");
+    return m_wrapped->read(offset, buffer, buffer_size);
+}
+int TracedWrapper::read(XrdSfsAio* aio) { return m_wrapped->read(aio); }
+XrdSfsXferSize TracedWrapper::write(XrdSfsFileOffset offset, const char* buffer, XrdSfsXferSize size) {
+    return m_wrapped->write(offset, buffer, size);
+}
+int TracedWrapper::write(XrdSfsAio* aio) { return m_wrapped->write(aio); }
+int TracedWrapper::sync() { return m_wrapped->sync(); }
+int TracedWrapper::sync(XrdSfsAio* aio) { return m_wrapped->sync(aio); }
+int TracedWrapper::stat(struct stat* buf) { return m_wrapped->stat(buf); }
+int TracedWrapper::truncate(XrdSfsFileOffset size) { return m_wrapped->truncate(size); }
+int TracedWrapper::getCXinfo(char cxtype[4], int& cxrsz) { return m_wrapped->getCXinfo(cxtype, cxrsz); }
+int TracedWrapper::SendData(XrdSfsDio* sfDio, XrdSfsFileOffset offset, XrdSfsXferSize size) {
+    m_log.Debug("FileWrapper::SendData");
+    return m_wrapped->SendData(sfDio, offset, size);
+}
+
+// Keeps the compiler from seeing which XrdSfsFile the loop calls into.
+XrdSfsFile* Opaque(XrdSfsFile* f) {
+    asm volatile("" : "+r"(f));
+    return f;
+}
+
+void Run(const char* name, XrdSfsFile* file, uint64_t calls) {
+    char buffer[64];
+    uint32_t csvec[1];
+    int64_t sink = 0;
+    file = Opaque(file);
+
+    auto time = [&](const char* op, auto&& call) {
+        const auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < calls; ++i) sink += call(static_cast<XrdSfsFileOffset>(i));
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        const double ns = std::chrono::duration<double, std::nano>(elapsed).count();
+        std::cout << name << op << ns / static_cast<double>(calls) << " ns/call\n";
+    };
+    time(" read      ", [&](XrdSfsFileOffset off) { return file->read(off, buffer, sizeof(buffer)); });
+    time(" pgRead    ", [&](XrdSfsFileOffset off) { return file->pgRead(off, buffer, sizeof(buffer), csvec, 0); });
+    time(" SendData  ", [&](XrdSfsFileOffset off) { return file->SendData(nullptr, off, 1); });
+    if (sink == 42) std::cout << "";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const uint64_t calls = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 50'000'000ull;
+    // No metrics file.
+    setenv("XRD_OPENVERIFY_METRICS_PATH", "", 1);
+
+    OpenVerifyLog log([](OpenVerifyLog::Level, const char*) {}, OpenVerifyLog::Level::Info, 1024);
+    OpenVerifyMetrics metrics;
+    OpenVerifyCache cache;
+    OpenVerifySingleFlight single_flight(metrics);
+    OpenVerifyHostReliability host_reliability(metrics);
+    OpenVerifyRetryBudget retry_budget(metrics);
+    OpenVerifyResumeState resume_state;
+    OpenVerifyRedirectCache redirect_cache;
+    OpenVerifyIoTrace io_off(metrics, 0, std::chrono::milliseconds(100), 64);
+    OpenVerifyIoTrace io_sampled(metrics, 100, std::chrono::milliseconds(100), 64);
+    OpenVerifyOpenTrace open_trace("", 100, std::chrono::milliseconds(1000), 1);
+    OpenVerifyExecutor executor(metrics);
+
+    StubFile native;
+    StubFile traced_native;
+    StubFile wrapped_native;
+    StubFile sampled_native;
+    TracedWrapper traced(&traced_native, log);
+    OpenVerifyFile wrapper(&wrapped_native, log, cache, metrics, single_flight, host_reliability, retry_budget,
+                           resume_state, redirect_cache, io_off, open_trace, executor, false);
+    OpenVerifyFile sampled(&sampled_native, log, cache, metrics, single_flight, host_reliability, retry_budget,
+                           resume_state, redirect_cache, io_sampled, open_trace, executor, false);
+
+    Run("native            ", &native, calls);
+    Run("traced wrapper    ", &traced, calls);
+    Run("OpenVerifyFile    ", &wrapper, calls);
+    Run("io sampled 1/100  ", &sampled, calls);
+    return 0;
+}
@@ -0,0 +1,213 @@
+// Allocations and time per open for the opaque handling on the open path: the previous
+// copy-and-substr helpers versus one OpenVerifyOpaque view shared by every consumer.
+//
+// Usage: openverify_opaque_bench [opens]
+// Each simulated open reads openverify.timeout and tried, builds the redirector opaque for three
+// attempts with a growing tried= list, extracts the bearer token and builds the verify URL for
+// the last attempt.
+
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+#include "OpenVerifyOpaque.hh"
+
+namespace {
+std::atomic<uint64_t> g_allocations{0};
+}  // namespace
+
+void* operator new(std::size_t n) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+const char* const kOpaque =
+    "cms.tid=job-1234567&authz=Bearer%20eyJhbGciOiJSUzI1NiJ9.eyJzdWIiOiJ1c2VyIn0.c2lnbmF0dXJl&"
+    "openverify.timeout=30&xrd.appname=cmsRun&oss.lcl=1";
+const char* const kHosts[] = {"a.example.org:1094", "b.example.org:1094", "c.example.org:1094"};
+const std::string kKey = "d.example.org:1094//store/data/file.root";
+
+// Previous helpers, as they were on the open path.
+namespace legacy {
+
+std::string OpaqueValue(const char* opaque, const std::string& name) {
+    if (!opaque) return std::string();
+    const std::string s(opaque);
+    const std::string needle = name + "=";
+    for (size_t pos = 0; pos < s.size();) {
+        size_t end = s.find('&', pos);
+        if (end == std::string::npos) end = s.size();
+        if (s.compare(pos, needle.size(), needle) == 0) {
+            return s.substr(pos + needle.size(), end - pos - needle.size());
+        }
+        pos = end + 1;
+    }
+    return std::string();
+}
+
+int HexValue(char c) {
+    const unsigned char uc = static_cast<unsigned char>(c);
+    if (uc >= '0' && uc <= '9') return uc - '0';
+    if (uc >= 'a' && uc <= 'f') return 10 + (uc - 'a');
+    if (uc >= 'A' && uc <= 'F') return 10 + (uc - 'A');
+    return -1;
+}
+
+std::string UrlDecode(const std::string& in) {
+    std::string out;
+    out.reserve(in.size());
+    for (size_t i = 0; i < in.size(); ++i) {
+        const char c = in[i];
+        if (c == '%' && i + 2 < in.size() && std::isxdigit(static_cast<unsigned char>(in[i + 1])) &&
+            std::isxdigit(static_cast<unsigned char>(in[i + 2]))) {
+            out.push_back(static_cast<char>((HexValue(in[i + 1]) << 4) | HexValue(in[i + 2])));
+            i += 2;
+            continue;
+        }
+        out.push_back(c == '+' ? ' ' : c);
+    }
+    return out;
+}
+
+std::string ToLowerCopy(const std::string& in) {
+    std::string out = in;
+    for (char& c : out) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return out;
+}
+
+std::string TrimAsciiWhitespace(const std::string& in) {
+    size_t first = 0;
+    while (first < in.size() && std::isspace(static_cast<unsigned char>(in[first])) != 0) ++first;
+    size_t last = in.size();
+    while (last > first && std::isspace(static_cast<unsigned char>(in[last - 1])) != 0) --last;
+    return in.substr(first, last - first);
+}
+
+bool TryExtractTokenFromOpaque(const char* opaque, std::string& outToken) {
+    outToken.clear();
+    if (!opaque || !*opaque) return false;
+    std::string q = (*opaque == '?') ? std::string(opaque + 1) : std::string(opaque);
+    size_t start = 0;
+    while (start <= q.size()) {
+        size_t end = q.find('&', start);
+        if (end == std::string::npos) end = q.size();
+        const std::string pair = q.substr(start, end - start);
+        if (!pair.empty()) {
+            size_t eq = pair.find('=');
+            const std::string rawKey = (eq == std::string::npos) ? pair : pair.substr(0, eq);
+            const std::string rawValue = (eq == std::string::npos) ? std::string() : pair.substr(eq + 1);
+            const std::string key = ToLowerCopy(UrlDecode(rawKey));
+            std::string value = UrlDecode(rawValue);
+            if (key == "authorization" || key == "authz" || key == "bearer" || key == "bearer_token" ||
+                key == "token" || key == "access_token") {
+                value = TrimAsciiWhitespace(value);
+                const std::string bearerPrefix = "bearer ";
+                if (ToLowerCopy(value).compare(0, bearerPrefix.size(), bearerPrefix) == 0) {
+                    value = TrimAsciiWhitespace(value.substr(bearerPrefix.size()));
+                }
+                if (!value.empty()) {
+                    outToken = value;
+                    return true;
+                }
+            }
+        }
+        if (end == q.size()) break;
+        start = end + 1;
+    }
+    return false;
+}
+
+size_t Open(const char* opaque) {
+    size_t sink = OpaqueValue(opaque, "openverify.timeout").size() + OpaqueValue(opaque, "tried").size();
+    std::string tried_hosts;
+    std::string opaque_str;
+    for (const char* host : kHosts) {
+        tried_hosts = tried_hosts.empty() ? std::string(host) : tried_hosts + "," + host;
+        opaque_str = opaque ? opaque : "";
+        if (!tried_hosts.empty()) {
+            size_t tried_pos = opaque_str.find("tried=");
+            if (tried_pos != std::string::npos) {
+                size_t end_pos = opaque_str.find('&', tried_pos);
+                if (end_pos == std::string::npos) {
+                    opaque_str += "," + tried_hosts;
+                } else {
+                    opaque_str.insert(end_pos, "," + tried_hosts);
+                }
+            } else {
+                opaque_str += "&tried=" + tried_hosts;
+            }
+        }
+    }
+    std::string token;
+    TryExtractTokenFromOpaque(opaque_str.c_str(), token);
+    std::string url = "root://";
+    url += kKey;
+    url.push_back('?');
+    url.append(opaque_str);
+    url.append("&xrd.ztn=/tmp/xrdovAbCdEf");
+    return sink + token.size() + url.size();
+}
+
+}  // namespace legacy
+
+size_t OpenWithView(const char* opaque) {
+    const OpenVerifyOpaque parsed(opaque);
+    size_t sink = parsed.Find("openverify.timeout").size() + parsed.Find("tried").size();
+    std::string tried_hosts;
+    std::string opaque_str;
+    for (const char* host : kHosts) {
+        if (!tried_hosts.empty()) tried_hosts += ',';
+        tried_hosts += host;
+        opaque_str.clear();
+        opaque_str.reserve(parsed.SizeWithTried(tried_hosts));
+        parsed.AppendWithTried(opaque_str, tried_hosts);
+    }
+    std::string token;
+    parsed.FindToken(token);
+    std::string url;
+    url.reserve(7 + kKey.size() + 1 + parsed.SizeWithTried(tried_hosts) + 26);
+    url = "root://";
+    url += kKey;
+    url.push_back('?');
+    parsed.AppendWithTried(url, tried_hosts);
+    url.append("&xrd.ztn=/tmp/xrdovAbCdEf");
+    return sink + token.size() + url.size();
+}
+
+template <typename Fn>
+void Run(const char* name, uint64_t opens, Fn&& open) {
+    size_t sink = 0;
+    const uint64_t allocs_before = g_allocations.load();
+    const auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < opens; ++i) sink += open(kOpaque);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    const uint64_t allocs = g_allocations.load() - allocs_before;
+    std::cout << name << ": " << static_cast<double>(allocs) / static_cast<double>(opens) << " allocations/open, "
+              << std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(opens)
+              << " ns/open (checksum " << sink << ")\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const uint64_t opens = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000ull;
+    Run("legacy helpers   ", opens, legacy::Open);
+    Run("OpenVerifyOpaque ", opens, OpenWithView);
+    return 0;
+}
@@ -17,6 +17,15 @@ class OpenVerifyCache {
    public:
     enum class Status { Miss, Positive, Negative };
 
+    // Point-in-time size figures for export. Entries that expired but have not been purged by
+    // Expire() yet are still counted.
+    struct Stats {
+        size_t positive_entries{0};
+        size_t negative_entries{0};
+        size_t nodes{0};
+        size_t approx_bytes{0};
+    };
+
     OpenVerifyCache() = default;
     OpenVerifyCache(const OpenVerifyCache&) = delete;
     OpenVerifyCache& operator=(const OpenVerifyCache&) = delete;
@@ -40,6 +49,8 @@ class OpenVerifyCache {
 
     void Reset();
 
+    Stats GetStats() const;
+
    private:
     struct Entry {
         Status status;
@@ -55,6 +66,8 @@ class OpenVerifyCache {
 
     static std::vector<std::string> SplitPath(const std::string& path);
     Node* TraverseCreate(const std::vector<std::string>& segments);
+    void CountEntry(const Entry* entry, int delta);
+    void PutEntry(const std::string& key, Status status, std::chrono::steady_clock::time_point expiry);
     const Node* Traverse(const std::vector<std::string>& segments) const;
 
     std::mutex m_shutdown_lock;
@@ -67,4 +80,10 @@ class OpenVerifyCache {
 
     mutable std::shared_mutex m_mutex;
     Node m_root;
+
+    // Maintained under m_mutex (exclusive) for GetStats().
+    size_t m_positive_entries{0};
+    size_t m_negative_entries{0};
+    size_t m_nodes{0};       // excluding m_root
+    size_t m_key_bytes{0};   // sum of segment lengths held by child nodes
 };
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <chrono>
+
+// Controlled-delay overload detector for the verify admission queues (CoDel as adapted for
+// request queues: adaptive LIFO plus a short queue timeout while a standing queue persists).
+//
+// Every admission reports how long the oldest leader in its queue has queued (its sojourn time),
+// whichever leader is admitted. When an interval ends and the smallest sojourn seen during it was
+// above `target`, the queue never drained in that interval: it is a standing queue, and the
+// detector reports overload until an interval whose minimum is back under target. A leader
+// admitted straight away has a sojourn of zero, so any moment of slack clears the state.
+//
+// Not thread-safe; OpenVerifySingleFlight calls it under its admission mutex.
+class OpenVerifyCoDel {
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    OpenVerifyCoDel(bool enabled, std::chrono::milliseconds target, std::chrono::milliseconds interval)
+        : m_enabled(enabled), m_target(target), m_interval(interval) {}
+
+    bool Enabled() const { return m_enabled; }
+    bool Overloaded() const { return m_overloaded; }
+    std::chrono::milliseconds Target() const { return m_target; }
+
+    // Closes the current interval if it has run out. Call before acting on Overloaded().
+    void Tick(Clock::time_point now) {
+        if (!m_enabled || now < m_interval_end) return;
+        // An interval without admissions carries no evidence; keep the previous verdict.
+        if (m_have_sample) m_overloaded = m_min_sojourn > m_target;
+        m_interval_end = now + m_interval;
+        m_have_sample = false;
+    }
+
+    void OnAdmit(Clock::duration sojourn, Clock::time_point now) {
+        if (!m_enabled) return;
+        Tick(now);
+        if (!m_have_sample || sojourn < m_min_sojourn) {
+            m_min_sojourn = sojourn;
+            m_have_sample = true;
+        }
+    }
+
+    // While overloaded, a waiter queued longer than target is not going to be served in time.
+    bool ShouldShed(Clock::duration sojourn) const { return m_enabled && m_overloaded && sojourn > m_target; }
+
+   private:
+    const bool m_enabled;
+    const std::chrono::milliseconds m_target;
+    const std::chrono::milliseconds m_interval;
+
+    bool m_overloaded{false};
+    bool m_have_sample{false};
+    Clock::duration m_min_sojourn{0};
+    Clock::time_point m_interval_end{};
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Verify admission limit, either fixed or adapted from observed verify latency.
+//
+// Adaptive mode follows TCP Vegas: the no-load latency (rtt_noload) is the lowest window mean
+// seen since the last re-baseline, and every closed sample window estimates the verifies that
+// are queueing somewhere downstream as
+//
+//     queue = limit * (1 - rtt_noload / rtt_window)
+//
+// Below alpha the limit grows by log10(limit) (only if the limit was actually used during the
+// window); above beta it shrinks by the same step. The limit always stays within [min, max].
+//
+// Only latency samples come in. Verifies that timed out are not reported at all: they are one
+// host's trouble, left to its partition cap and circuit breaker, and counting them here would
+// shrink the limit for every host.
+//
+// Not thread-safe; OpenVerifySingleFlight calls it under its FIFO mutex.
+class OpenVerifyConcurrencyLimit {
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        bool adaptive{false};
+        size_t initial{32};
+        size_t min{4};
+        size_t max{256};
+        // A window closes after this many samples and at least min_window time.
+        size_t window_samples{16};
+        std::chrono::milliseconds min_window{250};
+        // Re-baseline rtt_noload after this many windows so it can follow a slower steady state.
+        size_t rebaseline_windows{200};
+    };
+
+    explicit OpenVerifyConcurrencyLimit(const Options& opts);
+
+    size_t Limit() const { return m_limit; }
+    bool Adaptive() const { return m_opts.adaptive; }
+    // Current no-load latency estimate; zero until the first window closes.
+    Clock::duration NoLoadLatency() const { return m_rtt_noload; }
+
+    // Reports one finished verify. `inflight` is the admitted count when it started. Returns true
+    // if the limit changed.
+    bool OnSample(Clock::duration rtt, size_t inflight, Clock::time_point now = Clock::now());
+
+   private:
+    bool SetLimit(double limit);
+    void CloseWindow(Clock::time_point now);
+
+    const Options m_opts;
+    size_t m_limit;
+
+    Clock::duration m_rtt_noload{0};
+    size_t m_windows_since_baseline{0};
+
+    Clock::time_point m_window_start{};
+    size_t m_window_count{0};
+    Clock::duration m_window_rtt_sum{0};
+    size_t m_window_max_inflight{0};
+};
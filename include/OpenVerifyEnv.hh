@@ -0,0 +1,30 @@
+#pragma once
+
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+
+// Integer settings read from XRD_OPENVERIFY_* environment variables. The whole value must be a
+// decimal integer that fits an int; anything else ("auto", "8x", "") leaves the default.
+
+// Parses `name` into `out`; false when unset, empty or not a whole int.
+inline bool ParseIntEnv(const char* name, int& out) {
+    const char* p = std::getenv(name);
+    if (!p || !*p) return false;
+    const char* end = p + std::strlen(p);
+    const auto [ptr, ec] = std::from_chars(p, end, out);
+    return ec == std::errc() && ptr == end;
+}
+
+// `name` as a positive integer; `dflt` when unset, empty, zero, negative or not a number.
+inline int ReadIntEnvOrDefault(const char* name, int dflt) {
+    int v = 0;
+    return ParseIntEnv(name, v) && v > 0 ? v : dflt;
+}
+
+// As above, but 0 is a valid setting (e.g. "off"); `dflt` when unset, empty, negative or not a
+// number.
+inline int ReadNonNegativeIntEnvOrDefault(const char* name, int dflt) {
+    int v = 0;
+    return ParseIntEnv(name, v) && v >= 0 ? v : dflt;
+}
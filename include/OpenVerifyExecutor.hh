@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "OpenVerifyMetrics.hh"
+
+// Plugin-owned worker pool for verify work (starting detached verifies; also meant for background
+// refreshes and probes), sized by XRD_OPENVERIFY_EXECUTOR_THREADS (default 32) independently of
+// the xrootd thread pool. 0 turns the pool off and runs every job inline on its caller.
+//
+// Work stealing: every worker owns a deque. Jobs submitted from a worker go to its own deque and
+// are taken newest-first; jobs from other threads are spread round-robin. A worker whose deque
+// is empty steals the oldest job of another worker before it goes to sleep.
+//
+// Pool size, busy workers, queued jobs, executed jobs and steals are sampled into the metrics
+// exposition.
+class OpenVerifyExecutor {
+   public:
+    // Completion handle of one submitted job. Waiting is an atomic wait; no mutex or future.
+    class Completion {
+       public:
+        void Wait() const { m_done.wait(false, std::memory_order_acquire); }
+        bool Done() const { return m_done.load(std::memory_order_acquire); }
+
+       private:
+        friend class OpenVerifyExecutor;
+        void Finish() {
+            m_done.store(true, std::memory_order_release);
+            m_done.notify_all();
+        }
+
+        std::atomic<bool> m_done{false};
+    };
+
+    explicit OpenVerifyExecutor(OpenVerifyMetrics& metrics);
+    OpenVerifyExecutor(OpenVerifyMetrics& metrics, size_t threads);
+    OpenVerifyExecutor(const OpenVerifyExecutor&) = delete;
+    OpenVerifyExecutor& operator=(const OpenVerifyExecutor&) = delete;
+    // Runs the jobs still queued, then joins the workers.
+    ~OpenVerifyExecutor();
+
+    // Queues `job`, or runs it inline when the pool is off; exceptions it throws are swallowed.
+    std::shared_ptr<Completion> Submit(std::function<void()> job);
+
+    size_t Threads() const { return m_workers.size(); }
+    uint64_t Steals() const { return m_steals.load(std::memory_order_relaxed); }
+    uint64_t Executed() const { return m_executed.load(std::memory_order_relaxed); }
+
+   private:
+    struct Job {
+        std::function<void()> fn;
+        std::shared_ptr<Completion> done;
+    };
+
+    struct Worker {
+        std::mutex mtx;
+        std::deque<Job> jobs;
+        std::thread thread;
+    };
+
+    bool OnWorkerThread() const;
+    bool TryPop(size_t self, Job& job);
+    bool TrySteal(size_t self, Job& job);
+    void RunJob(Job& job);
+    void WorkerLoop(size_t self);
+
+    // Metrics collector: pool gauges and counters.
+    void WriteExposition(std::ostream& out, const std::string& lbl);
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::atomic<size_t> m_next{0};
+    // Jobs submitted and not yet taken by a worker.
+    std::atomic<size_t> m_queued{0};
+    std::atomic<size_t> m_busy{0};
+    std::atomic<uint64_t> m_executed{0};
+    std::atomic<uint64_t> m_steals{0};
+
+    std::mutex m_idle_mtx;
+    std::condition_variable m_idle_cv;
+    bool m_stop{false};  // guarded by m_idle_mtx
+
+    OpenVerifyMetrics& m_metrics;
+    int m_collector_id{-1};
+};
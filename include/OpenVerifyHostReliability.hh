@@ -1,49 +1,119 @@
 #pragma once
 
+#include <array>
 #include <chrono>
 #include <cstdint>
 #include <mutex>
+#include <ostream>
 #include <string>
 #include <unordered_map>
 
+#include "OpenVerifyMetrics.hh"
+
 // Per-(host,port) verify outcomes only (post-redirect): attempts, successes, failures.
-// Host health uses EWMA scoring with hysteresis.
+// Host health uses EWMA scoring with hysteresis over a sliding window of per-second buckets,
+// driving a closed -> open -> half-open circuit breaker.
+//
+// Per-host gauges are rendered into the OpenVerifyMetrics exposition at export time.
+// XRD_OPENVERIFY_HOST_METRICS_MAX caps how many hosts get per-host series (default 50);
+// quarantined hosts are exported first, then the least healthy.
 class OpenVerifyHostReliability {
    public:
-    OpenVerifyHostReliability();
+    enum class BreakerState { Closed, Open, HalfOpen };
+
+    explicit OpenVerifyHostReliability(OpenVerifyMetrics& metrics);
     OpenVerifyHostReliability(const OpenVerifyHostReliability&) = delete;
     OpenVerifyHostReliability& operator=(const OpenVerifyHostReliability&) = delete;
+    ~OpenVerifyHostReliability();
+
+    // Add a site to the tried list if its breaker is open, or half-open with all trial slots taken.
+    bool AvoidSite(const std::string& host, int port,
+                   std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
 
-    // Add a site to the tried list if its ewma score is below threshold
-    bool AvoidSite(const std::string& host, int port);
+    void RecordVerifySuccess(const std::string& host, int port,
+                             std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+    void RecordVerifyFailure(const std::string& host, int port, uint16_t xrdcl_code,
+                             std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
 
-    void RecordVerifySuccess(const std::string& host, int port);
-    void RecordVerifyFailure(const std::string& host, int port, uint16_t xrdcl_code);
+    // Current breaker state; Closed for hosts never seen.
+    BreakerState State(const std::string& host, int port);
 
    private:
+    // Seconds covered by the sliding window; one bucket per second.
+    static constexpr size_t kWindowBuckets = 120;
+
+    struct WindowBucket {
+        int64_t second{-1};  // steady_clock second this bucket currently holds
+        uint32_t successes{0};
+        uint32_t failures{0};
+    };
+
     struct HostStats {
-        uint64_t successes{0}; // openverify success counts for host
-        uint64_t failures{0};  // openveify failure counts for host
+        std::string host;
+        int port{-1};
+        // Ring buffer of per-second outcome counts; buckets older than the window are ignored.
+        std::array<WindowBucket, kWindowBuckets> window{};
         double ewma_health{0.0};
-        bool healthy{true};
-        // Deadline after which the next probe is allowed. 
+        std::chrono::steady_clock::time_point ewma_updated_at{};
+        BreakerState state{BreakerState::Closed};
+        // When the breaker last left Closed; used to measure recovery time.
+        std::chrono::steady_clock::time_point opened_at{};
+        // Open: deadline after which the breaker moves to half-open.
+        // HalfOpen: deadline after which unresolved trial slots are handed out again.
         std::chrono::steady_clock::time_point next_probe_at{};
+        uint32_t trials_admitted{0};
+        uint32_t trial_successes{0};
+        uint32_t trial_failures{0};
+        // Lifetime half-open trial outcomes, exported per host.
+        uint64_t probe_successes{0};
+        uint64_t probe_failures{0};
+    };
+
+    // Breaker transitions collected under m_mtx and reported to metrics after it is released.
+    struct BreakerEvents {
+        uint32_t opened{0};
+        uint32_t half_opened{0};
+        bool closed{false};
+        std::chrono::steady_clock::duration recovery{};
     };
 
     static std::string HostPortKey(const std::string& host, int port);
-    void UpdateHealthState(HostStats& stats);
+    static int64_t SecondOf(std::chrono::steady_clock::time_point t);
+    static double HealthAt(const HostStats& stats, std::chrono::steady_clock::time_point now);
+    HostStats& StatsFor(const std::string& host, int port);
+    bool AvoidSiteLocked(const std::string& host, int port, std::chrono::steady_clock::time_point now,
+                         BreakerEvents& events);
+    void RecordOutcome(HostStats& stats, bool success, std::chrono::steady_clock::time_point now);
+    uint64_t WindowAttempts(const HostStats& stats, std::chrono::steady_clock::time_point now) const;
+    void DecayEwma(HostStats& stats, std::chrono::steady_clock::time_point now) const;
+    void UpdateHealthState(HostStats& stats, std::chrono::steady_clock::time_point now, BreakerEvents& events);
+    void UpdateHalfOpenState(HostStats& stats, std::chrono::steady_clock::time_point now, BreakerEvents& events);
+    void OpenBreaker(HostStats& stats, std::chrono::steady_clock::time_point now, BreakerEvents& events);
+    void EmitBreakerEvents(const BreakerEvents& events);
+    // Metrics collector: per-host gauges, capped at m_export_limit hosts.
+    void WriteExposition(std::ostream& out, const std::string& lbl);
 
     // we keep separate alpha for failures and success
     // to ensure faster recovery on success but still smoother
     // transition to diabled on failure
     const double m_ewma_alpha_fail;
     const double m_ewma_alpha_success;
+    // Minimum attempts inside the sliding window before the breaker may open.
     const uint64_t m_min_attempts;
     // Create a dead band of thresholds to not oscillate
     // between healthy and otherwise
     const double m_quarantine_threshold;
     const double m_recover_threshold;
     const std::chrono::seconds m_probe_cooldown;
+    // Concurrent trial requests let through while half-open.
+    const uint32_t m_half_open_trials;
+    // Fraction of half-open trials that must succeed to close the breaker.
+    const double m_half_open_success_ratio;
+    // Maximum hosts with per-host series in the exposition (XRD_OPENVERIFY_HOST_METRICS_MAX).
+    const size_t m_export_limit;
+
+    OpenVerifyMetrics& m_metrics;
+    int m_collector_id{-1};
 
     std::mutex m_mtx;
     std::unordered_map<std::string, HostStats> m_hoststat_map;
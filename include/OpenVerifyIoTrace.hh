@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "OpenVerifyLatencyHistogram.hh"
+#include "OpenVerifyMetrics.hh"
+#include "OpenVerifyStripedCounter.hh"
+
+// Sampled latency of the file data calls OpenVerifyFile forwards to the native file.
+//
+// XRD_OPENVERIFY_IO_SAMPLE: time one call in N per thread (default 0: off). While off, a data call
+// pays one load and a branch and nothing is exported. While on, every call is counted with its
+// bytes, and the sampled ones are timed into a per-operation histogram.
+//
+// XRD_OPENVERIFY_IO_SLOW_MS (default 100): sampled calls at least this slow are also kept, with
+// path, offset and size, in a ring of the last XRD_OPENVERIFY_IO_SLOW_RING (default 64) that
+// SlowOps() returns. The caller logs them too, at most one line per kSlowLogInterval: under
+// storage trouble every sampled call is slow, and the log ring is not meant to take them all.
+// read(XrdSfsAio*) is timed until it returns, which for a truly asynchronous read is the
+// submission only.
+//
+// Exported through OpenVerifyMetrics::AddCollector: xrootd_openverify_io_calls_total{op},
+// xrootd_openverify_io_bytes_total{op}, xrootd_openverify_io_duration_seconds{op} (histogram),
+// xrootd_openverify_io_slow_total and xrootd_openverify_io_slow_op_seconds{op,slot}, one gauge
+// per ring entry, slot 0 the newest. Path and offset stay out of the labels so the number of
+// series is bounded by the ring size.
+class OpenVerifyIoTrace {
+   public:
+    enum class Op { Read, PgRead, Write, Sync, SendData, ReadAio };
+    static constexpr size_t kOps = 6;
+    static constexpr std::chrono::seconds kSlowLogInterval{1};
+
+    struct SlowOp {
+        Op op;
+        std::string path;
+        int64_t offset;
+        int64_t bytes;
+        std::chrono::steady_clock::duration duration;
+        uint64_t seq;  // increases by one per slow call, so samples stay distinct
+    };
+
+    explicit OpenVerifyIoTrace(OpenVerifyMetrics& metrics);
+    OpenVerifyIoTrace(OpenVerifyMetrics& metrics, uint32_t sample_every, std::chrono::milliseconds slow_threshold,
+                      size_t slow_capacity);
+    OpenVerifyIoTrace(const OpenVerifyIoTrace&) = delete;
+    OpenVerifyIoTrace& operator=(const OpenVerifyIoTrace&) = delete;
+    ~OpenVerifyIoTrace();
+
+    bool Enabled() const { return m_sample_every != 0; }
+
+    // Whether the calling thread should time its next call; only meaningful while Enabled().
+    bool Sample() {
+        static thread_local uint32_t countdown = 0;
+        if (countdown > 0) {
+            --countdown;
+            return false;
+        }
+        countdown = m_sample_every - 1;
+        return true;
+    }
+
+    // A call of `op` that moved `bytes`.
+    void Count(Op op, int64_t bytes) {
+        m_calls[static_cast<size_t>(op)].Add();
+        if (bytes > 0) m_bytes[static_cast<size_t>(op)].Add(static_cast<uint64_t>(bytes));
+    }
+
+    // A sampled call's duration; slow ones also go to the ring. Returns how many slow calls to
+    // report in a log line for this one: itself plus those not logged since the last line, or 0
+    // if the call was fast or a line went out less than kSlowLogInterval ago.
+    uint64_t Observe(Op op, std::chrono::steady_clock::duration d, const char* path, int64_t offset,
+                     int64_t bytes) {
+        m_duration[static_cast<size_t>(op)].Observe(d);
+        if (d < m_slow_threshold) return 0;
+        return RecordSlow(op, d, path, offset, bytes);
+    }
+
+    // Newest first.
+    std::vector<SlowOp> SlowOps() const;
+
+    static const char* OpLabel(Op op);
+
+   private:
+    uint64_t RecordSlow(Op op, std::chrono::steady_clock::duration d, const char* path, int64_t offset,
+                        int64_t bytes);
+    // Metrics collector: the families above, only while Enabled().
+    void WriteExposition(std::ostream& out, const std::string& lbl);
+
+    const uint32_t m_sample_every;
+    const std::chrono::steady_clock::duration m_slow_threshold;
+    const size_t m_slow_capacity;
+
+    std::array<OpenVerifyStripedCounter, kOps> m_calls;
+    std::array<OpenVerifyStripedCounter, kOps> m_bytes;
+    std::array<OpenVerifyLatencyHistogram, kOps> m_duration;
+
+    // Slow calls are rare next to the data path (sampled, and over the threshold), so the ring
+    // is a plain deque under a mutex.
+    mutable std::mutex m_slow_mtx;
+    std::deque<SlowOp> m_slow;  // oldest first
+    uint64_t m_slow_total{0};
+    uint64_t m_slow_unlogged{0};
+    std::chrono::steady_clock::time_point m_next_slow_log{};
+
+    OpenVerifyMetrics& m_metrics;
+    int m_collector_id{-1};
+};
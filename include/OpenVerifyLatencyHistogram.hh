@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// Lock-free log-linear latency histogram (HDR-style): microsecond values are bucketed by
+// power-of-two magnitude, each split into kSubBuckets linear sub-buckets, giving ~12% relative
+// precision from 1 us up to ~18 minutes (larger values land in the last bucket). Observe() is
+// three relaxed atomic adds.
+//
+// Export folds the fine buckets into fixed Prometheus `le` bounds (kExportBoundsSeconds). A fine
+// bucket is counted under the first bound that is >= its upper edge, so bucket counts err on the
+// slow side by at most one sub-bucket.
+class OpenVerifyLatencyHistogram {
+   public:
+    static constexpr std::array<double, 16> kExportBoundsSeconds = {
+        0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025,
+        0.05,   0.1,     0.25,   0.5,   1.0,    2.5,   5.0,  10.0};
+
+    OpenVerifyLatencyHistogram() = default;
+    OpenVerifyLatencyHistogram(const OpenVerifyLatencyHistogram&) = delete;
+    OpenVerifyLatencyHistogram& operator=(const OpenVerifyLatencyHistogram&) = delete;
+
+    void Observe(std::chrono::steady_clock::duration d) {
+        const auto us_signed = std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+        const uint64_t us = us_signed > 0 ? static_cast<uint64_t>(us_signed) : 0;
+        m_buckets[BucketIndex(us)].fetch_add(1, std::memory_order_relaxed);
+        m_sum_us.fetch_add(us, std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t Count() const { return m_count.load(std::memory_order_relaxed); }
+
+    // Writes <name>_bucket / _sum / _count samples. `labels` is the inner label list
+    // (e.g. `step="open",xrootd_instance="x"`), possibly empty.
+    void WriteTo(std::ostream& out, const std::string& name, const std::string& labels) const {
+        const std::string sep = labels.empty() ? std::string() : (labels + ",");
+        const std::string own = labels.empty() ? std::string() : ("{" + labels + "}");
+
+        uint64_t cumulative = 0;
+        size_t fine = 0;
+        for (double bound : kExportBoundsSeconds) {
+            const double bound_us = bound * 1e6;
+            while (fine < kBuckets && static_cast<double>(BucketUpperUs(fine)) <= bound_us) {
+                cumulative += m_buckets[fine].load(std::memory_order_relaxed);
+                ++fine;
+            }
+            out << name << "_bucket{" << sep << "le=\"" << bound << "\"} " << cumulative << "\n";
+        }
+        // +Inf must equal _count; read count once and use it for both.
+        const uint64_t count = m_count.load(std::memory_order_relaxed);
+        const uint64_t sum_us = m_sum_us.load(std::memory_order_relaxed);
+        // Print the microsecond sum exactly; default stream precision would round large sums.
+        std::string frac = std::to_string(sum_us % 1000000);
+        frac.insert(0, 6 - frac.size(), '0');
+        out << name << "_bucket{" << sep << "le=\"+Inf\"} " << count << "\n"
+            << name << "_sum" << own << " " << sum_us / 1000000 << "." << frac << "\n"
+            << name << "_count" << own << " " << count << "\n";
+    }
+
+    // Writes the # HELP / # TYPE header for a histogram family.
+    static void WriteHeader(std::ostream& out, const std::string& name, const std::string& help) {
+        out << "# HELP " << name << " " << help << "\n# TYPE " << name << " histogram\n";
+    }
+
+   private:
+    static constexpr unsigned kSubBits = 3;
+    static constexpr uint64_t kSubBuckets = 1u << kSubBits;
+    // Largest magnitude tracked: 2^30 us (~18 min).
+    static constexpr unsigned kMaxExponent = 30;
+    static constexpr size_t kBuckets = (kMaxExponent - kSubBits + 2) * kSubBuckets;
+
+    static size_t BucketIndex(uint64_t us) {
+        if (us < kSubBuckets) return static_cast<size_t>(us);
+        const unsigned e = static_cast<unsigned>(std::bit_width(us)) - 1;
+        if (e > kMaxExponent) return kBuckets - 1;
+        const uint64_t sub = (us >> (e - kSubBits)) & (kSubBuckets - 1);
+        return static_cast<size_t>((e - kSubBits + 1) * kSubBuckets + sub);
+    }
+
+    // Exclusive upper edge of a fine bucket, in microseconds.
+    static uint64_t BucketUpperUs(size_t index) {
+        if (index < kSubBuckets) return index + 1;
+        const unsigned e = static_cast<unsigned>(index / kSubBuckets) + kSubBits - 1;
+        const uint64_t sub = index % kSubBuckets;
+        return (kSubBuckets + sub + 1) << (e - kSubBits);
+    }
+
+    std::array<std::atomic<uint64_t>, kBuckets> m_buckets{};
+    std::atomic<uint64_t> m_sum_us{0};
+    std::atomic<uint64_t> m_count{0};
+};
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <atomic>
+#include <charconv>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+
+#include "OpenVerifyMpscRing.hh"
+
+// Messages below this level are compiled out (0 debug, 1 info, 2 warn, 3 error).
+#ifndef OPENVERIFY_LOG_COMPILED_LEVEL
+#define OPENVERIFY_LOG_COMPILED_LEVEL 0
+#endif
+
+// Leveled, asynchronous plugin log. A message below the runtime level (XRD_OPENVERIFY_LOG_LEVEL:
+// debug | info | warn | error, default info) costs one relaxed load and a branch; its arguments
+// are not formatted. Enabled messages are formatted straight into a slot of a bounded lock-free
+// MPSC ring (XRD_OPENVERIFY_LOG_QUEUE slots, default 8192) and written to the sink (normally
+// XrdSysError) by a background thread, so no caller waits on the logger. When the ring is full
+// the message is dropped and counted; the drain thread reports the drop count.
+//
+// Wrapper tracing (close, fctl, every filesystem call) is logged at debug; open-path decisions at
+// info. File data calls are not traced; with XRD_OPENVERIFY_IO_SAMPLE on, a sampled call over the
+// slow threshold is logged at warn, at most once a second (OpenVerifyIoTrace).
+class OpenVerifyLog {
+   public:
+    enum class Level { Debug = 0, Info = 1, Warn = 2, Error = 3 };
+    using Sink = std::function<void(Level, const char* line)>;
+
+    // Longest message kept; longer ones are cut and end in "...".
+    static constexpr size_t kLineMax = 480;
+
+    explicit OpenVerifyLog(Sink sink);
+    OpenVerifyLog(Sink sink, Level level, size_t capacity);
+    OpenVerifyLog(const OpenVerifyLog&) = delete;
+    OpenVerifyLog& operator=(const OpenVerifyLog&) = delete;
+    // Writes out everything queued, then stops the drain thread.
+    ~OpenVerifyLog();
+
+    static const char* LevelName(Level level);
+
+    void SetLevel(Level level) { m_level.store(static_cast<int>(level), std::memory_order_relaxed); }
+    bool Enabled(Level level) const {
+        return static_cast<int>(level) >= OPENVERIFY_LOG_COMPILED_LEVEL &&
+               static_cast<int>(level) >= m_level.load(std::memory_order_relaxed);
+    }
+
+    // Arguments (C strings, strings, string views, integers) are joined with single spaces.
+    template <typename... Args>
+    void Debug(const Args&... args) {
+        Log<Level::Debug>(args...);
+    }
+    template <typename... Args>
+    void Info(const Args&... args) {
+        Log<Level::Info>(args...);
+    }
+    template <typename... Args>
+    void Warn(const Args&... args) {
+        Log<Level::Warn>(args...);
+    }
+    template <typename... Args>
+    void Error(const Args&... args) {
+        Log<Level::Error>(args...);
+    }
+
+    // Blocks until everything queued so far has reached the sink.
+    void Flush();
+
+    uint64_t Dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+   private:
+    struct Slot {
+        Level level{Level::Info};
+        size_t len{0};
+        char text[kLineMax + 1];
+    };
+
+    template <Level L, typename... Args>
+    void Log(const Args&... args) {
+        if constexpr (static_cast<int>(L) >= OPENVERIFY_LOG_COMPILED_LEVEL) {
+            if (static_cast<int>(L) < m_level.load(std::memory_order_relaxed)) return;
+            size_t pos;
+            Slot* slot = m_ring.Claim(pos);
+            if (!slot) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            slot->level = L;
+            slot->len = 0;
+            (Append(*slot, args), ...);
+            slot->text[slot->len] = '\0';
+            m_ring.Publish(pos);
+        }
+    }
+
+    static void AppendText(Slot& slot, const char* p, size_t n);
+    static void Append(Slot& slot, const char* s) { AppendText(slot, s ? s : "(null)", s ? std::strlen(s) : 6); }
+    static void Append(Slot& slot, std::string_view s) { AppendText(slot, s.data(), s.size()); }
+    static void Append(Slot& slot, const std::string& s) { AppendText(slot, s.data(), s.size()); }
+    template <typename T, std::enable_if_t<std::is_integral_v<T>, int> = 0>
+    static void Append(Slot& slot, T v) {
+        char buf[24];
+        const auto res = std::to_chars(buf, buf + sizeof(buf), v);
+        AppendText(slot, buf, static_cast<size_t>(res.ptr - buf));
+    }
+
+    // Consumer side, drain thread only.
+    size_t DrainOnce();
+    void DrainLoop();
+
+    const Sink m_sink;
+    std::atomic<int> m_level;
+    OpenVerifyMpscRing<Slot> m_ring;
+    std::atomic<uint64_t> m_dropped{0};
+    uint64_t m_dropped_reported{0};  // drain thread only
+
+    std::mutex m_wake_mtx;
+    std::condition_variable m_wake_cv;
+    bool m_stop{false};  // guarded by m_wake_mtx
+    std::thread m_thread;
+};
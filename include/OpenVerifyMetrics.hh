@@ -1,11 +1,23 @@
 #pragma once
 
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <ostream>
 #include <string>
+#include <thread>
 #include <unordered_map>
 
+#include "OpenVerifyLatencyHistogram.hh"
+#include "OpenVerifyMetricsHttp.hh"
+#include "OpenVerifyStripedCounter.hh"
+#include "OpenVerifyTopK.hh"
+
 // In-memory counters for OpenVerify cache / verify runs; optional text file mirror (Prometheus text format).
 //
 // XRD_OPENVERIFY_METRICS_PATH: absolute path of the .prom file to write. For node_exporter, use
@@ -13,12 +25,56 @@
 // falls back to <getcwd()>/openverify_metrics.prom. Set to an empty string to disable file export.
 // On startup the file is rewritten from current counters (zeros) so disk cannot lag after restart.
 //
+// XRD_OPENVERIFY_METRICS_HTTP_PORT: if set to a port number, serve the same exposition body on
+// http://<addr>:<port>/metrics, rendered per scrape (OpenVerifyMetricsHttpServer). The listen address
+// is XRD_OPENVERIFY_METRICS_HTTP_ADDR (default 127.0.0.1). When the HTTP endpoint is serving and
+// XRD_OPENVERIFY_METRICS_PATH is unset, no file is written; set both to get both exports. If the
+// endpoint cannot start, the default file is written instead and HttpStartError() says why.
+//
+// XRD_OPENVERIFY_METRICS_FLUSH_MS: interval of the background flusher thread (default 5000).
+// Record* calls only bump striped counters; the flusher rewrites the file when any counter changed since
+// the last write, and at least once a minute so gauges and the file mtime stay fresh. A final
+// flush runs on destruction.
+//
 // XRD_OPENVERIFY_METRICS_INSTANCE: optional xrootd_instance label value (recommended when several
 // daemons write into one collector dir). If unset, defaults to the basename of getcwd(); if set
 // but empty, the label is omitted.
 //
 // xrootd_openverify_verify_failures_total counts failed verify runs (after a cache miss) with
-// labels host, port (or "none"), and reason.
+// labels host, port (or "none"), and reason. Only the heaviest failing (host, port) targets get
+// their own series: a Space-Saving table of XRD_OPENVERIFY_FAILURE_HOSTS_MAX entries (default:
+// XRD_OPENVERIFY_HOST_METRICS_MAX) picks them, and everything else, including the counts of targets
+// pushed out of the table, is folded into host="other",port="none" per reason.
+//
+// xrootd_openverify_host_breaker_transitions_total counts per-host circuit breaker transitions;
+// xrootd_openverify_host_recovery_seconds (summary) measures time from a breaker opening until
+// half-open trials close it again.
+//
+// xrootd_openverify_stalls_total{result} counts stalls from the wrapped OFS handed back to the
+// client (returned) and client retries that picked up the stalled open's state (resumed).
+//
+// xrootd_openverify_open_deadline_exceeded_total counts opens that returned their best answer so
+// far because the per-open deadline (XRD_OPENVERIFY_OPEN_DEADLINE_MS) ran out.
+//
+// xrootd_openverify_retry_budget_total{result} counts first attempts paying into the shared retry
+// budget (deposited) and retries it allowed (withdrawn) or refused (exhausted).
+//
+// xrootd_openverify_redirect_cache_total{result} counts opens answered from the redirect cache
+// (OpenVerifyRedirectCache) without the wrapped OFS (hit), and cached targets dropped because
+// their host's breaker left closed or their verify turned negative (invalidated).
+//
+// Latency histograms (seconds): xrootd_openverify_queue_wait_seconds (leader FIFO admission),
+// xrootd_openverify_follower_wait_seconds, xrootd_openverify_xrdcl_step_seconds{step},
+// xrootd_openverify_verify_duration_seconds{host,port} and xrootd_openverify_open_duration_seconds
+// (whole OpenVerifyFile::open for every open-verify open, whatever its outcome). Per-host verify
+// series are capped at XRD_OPENVERIFY_HOST_METRICS_MAX hosts (default 50); later hosts share
+// host="other".
+// xrootd_openverify_class_queue_wait_seconds{class} splits leader queue wait by fair-queuing
+// class, for the first XRD_OPENVERIFY_CLASS_METRICS_MAX classes (default 20); later ones share
+// class="other".
+//
+// Other components (e.g. OpenVerifyHostReliability) append gauge families through AddCollector;
+// collectors run while the exposition body is rendered and must not call back into Record*.
 //
 // XRD_OPENVERIFY_OBSERVE: if set to exactly 1, OpenVerify records cache
 // miss/hit metrics and runs open_verify only on cache miss (same as enforce), but does not
@@ -27,9 +83,16 @@
 //
 class OpenVerifyMetrics {
    public:
+    // XrdCl operations issued by open_verify, timed individually.
+    enum class XrdClStep { Open, Stat, VectorRead, Close };
+    // How an open proceeds when the verifier itself is overloaded: return the redirect
+    // unverified, stall the client, or fail the open.
+    enum class DegradeAction { Open, Stall, Fail };
+
     OpenVerifyMetrics();
     OpenVerifyMetrics(const OpenVerifyMetrics&) = delete;
     OpenVerifyMetrics& operator=(const OpenVerifyMetrics&) = delete;
+    ~OpenVerifyMetrics();
 
     void RecordCacheMiss();
     void RecordCacheHitPositive();
@@ -41,39 +104,156 @@ class OpenVerifyMetrics {
     void RecordQueueAdmissionAdmitted();
     void RecordQueueAdmissionFull();
     void RecordQueueAdmissionTimeout();
+    // Waiter dropped by CoDel queue management before its timeout.
+    void RecordQueueAdmissionShed();
     // Single-flight request role split.
     void RecordSingleFlightLeader();
     void RecordSingleFlightFollower();
+    // A follower gave up waiting for its leader, or a leader for the verify it started.
+    void RecordSingleFlightTimeout(bool leader);
+    // An open skipped verification because admission was refused (queue full, timed out or shed).
+    void RecordOverloadDegrade(DegradeAction action);
+    // A stall from the wrapped OFS went back to the client; a later open resumed its state.
+    void RecordStallReturned();
+    void RecordStallResumed();
+    // An open stopped verifying or retrying because its deadline passed.
+    void RecordOpenDeadlineExceeded();
+    // Retry budget (OpenVerifyRetryBudget): first attempts, and retries granted or refused.
+    void RecordRetryBudgetDeposit();
+    void RecordRetryBudgetWithdraw(bool granted);
+    // Redirect cache (OpenVerifyRedirectCache): opens answered from it, entries dropped.
+    void RecordRedirectCacheHit();
+    void RecordRedirectCacheInvalidated();
+    // Host circuit breaker transitions (OpenVerifyHostReliability).
+    void RecordHostBreakerOpened();
+    void RecordHostBreakerHalfOpened();
+    // Breaker closed after half-open trials; `recovery` is the time since it opened.
+    void RecordHostBreakerClosed(std::chrono::steady_clock::duration recovery);
+
+    // Latency observations.
+    void ObserveQueueWait(std::chrono::steady_clock::duration d);
+    // Queue wait of a leader in a fair-queuing class (in addition to ObserveQueueWait).
+    void ObserveClassQueueWait(const std::string& client_class, std::chrono::steady_clock::duration d);
+    void ObserveFollowerWait(std::chrono::steady_clock::duration d);
+    void ObserveXrdClStep(XrdClStep step, std::chrono::steady_clock::duration d);
+    void ObserveVerify(const std::string& host, int port, std::chrono::steady_clock::duration d);
+    void ObserveOpen(std::chrono::steady_clock::duration d);
 
     bool FileExportEnabled() const { return !m_path.empty(); }
+    // Port of the embedded /metrics endpoint; 0 when disabled or it failed to start.
+    uint16_t HttpPort() const { return m_http ? m_http->Port() : 0; }
+    // Why the endpoint asked for could not start ("127.0.0.1:9100: Address already in use");
+    // empty if it is serving or was not asked for.
+    const std::string& HttpStartError() const { return m_http_error; }
+
+    // Current Prometheus text exposition (counters, histograms, collector output).
+    std::string BuildExpositionBody() const;
+
+    // Rewrites the metrics file immediately; normally left to the flusher thread.
+    void Flush();
+
+    // Writes extra metric families; `lbl` is the ",xrootd_instance=..." suffix (possibly empty)
+    // to append inside each sample's label set.
+    using Collector = std::function<void(std::ostream& out, const std::string& lbl)>;
+    // Returns an id for RemoveCollector; collectors must be removed before their owner is destroyed.
+    int AddCollector(Collector collector);
+    void RemoveCollector(int id);
+
+    // Prometheus label value escaping and port label ("none" for port < 0), shared with collectors.
+    static std::string EscapeLabelValue(const std::string& in);
+    static std::string PortLabel(int port);
+    // Writes a single-sample gauge family; `labels` is the inner label list, possibly empty.
+    static void WriteGauge(std::ostream& out, const std::string& name, const std::string& help,
+                           const std::string& labels, double value);
 
    private:
-    struct PerFailureMetrics {
+    // Failure counts of one tracked (host, port), keyed by escaped reason.
+    struct FailureTarget {
         std::string host_esc;
         std::string port_lbl;
-        std::string reason_esc;
-        std::atomic<uint64_t> count{0};
+        std::map<std::string, uint64_t> by_reason;
     };
 
-    PerFailureMetrics& EnsureFailure(const std::string& host, int port, const std::string& reason);
-    std::string BuildExpositionBody() const;
-    void Flush();
+    struct PerHostLatency {
+        std::string host_esc;
+        std::string port_lbl;
+        OpenVerifyLatencyHistogram verify;
+    };
+
+    struct PerClassLatency {
+        std::string class_esc;
+        OpenVerifyLatencyHistogram wait;
+    };
+
+    PerHostLatency& EnsureHostLatency(const std::string& host, int port);
+    PerClassLatency& EnsureClassLatency(const std::string& client_class);
+    // Sum of all counters; changes whenever any Record* ran since the previous call.
+    uint64_t CounterGeneration() const;
+    void StartFlushThread();
+    void StopFlushThread();
+    void FlushThread();
 
     std::string m_path;
     std::string m_instance_label;  // optional "xrootd_instance" label value (from env)
     std::mutex m_write_mtx;
 
-    std::atomic<uint64_t> m_cache_miss{0};
-    std::atomic<uint64_t> m_cache_hit_positive{0};
-    std::atomic<uint64_t> m_cache_hit_negative{0};
-    std::atomic<uint64_t> m_verify_success{0};
-    std::atomic<uint64_t> m_verify_failure{0};
-    std::atomic<uint64_t> m_queue_admitted{0};
-    std::atomic<uint64_t> m_queue_full{0};
-    std::atomic<uint64_t> m_queue_timeout{0};
-    std::atomic<uint64_t> m_singleflight_leader{0};
-    std::atomic<uint64_t> m_singleflight_follower{0};
+    // Counters are striped across cache-line-padded slots (OpenVerifyStripedCounter) so that
+    // Record* from many xrootd threads does not contend on shared lines; reads sum the slots.
+
+    const std::chrono::milliseconds m_flush_interval;
+    std::mutex m_flush_lock;
+    std::condition_variable m_flush_cv;
+    bool m_flush_stop{false};
+    std::thread m_flush_thread;
+
+    OpenVerifyStripedCounter m_cache_miss;
+    OpenVerifyStripedCounter m_cache_hit_positive;
+    OpenVerifyStripedCounter m_cache_hit_negative;
+    OpenVerifyStripedCounter m_verify_success;
+    OpenVerifyStripedCounter m_verify_failure;
+    OpenVerifyStripedCounter m_queue_admitted;
+    OpenVerifyStripedCounter m_queue_full;
+    OpenVerifyStripedCounter m_queue_timeout;
+    OpenVerifyStripedCounter m_queue_shed;
+    OpenVerifyStripedCounter m_singleflight_leader;
+    OpenVerifyStripedCounter m_singleflight_follower;
+    OpenVerifyStripedCounter m_follower_timeout;
+    OpenVerifyStripedCounter m_leader_timeout;
+    std::array<OpenVerifyStripedCounter, 3> m_overload_degrade;  // indexed by DegradeAction
+    OpenVerifyStripedCounter m_stall_returned;
+    OpenVerifyStripedCounter m_stall_resumed;
+    OpenVerifyStripedCounter m_open_deadline_exceeded;
+    OpenVerifyStripedCounter m_retry_deposited;
+    OpenVerifyStripedCounter m_retry_granted;
+    OpenVerifyStripedCounter m_retry_exhausted;
+    OpenVerifyStripedCounter m_redirect_cache_hit;
+    OpenVerifyStripedCounter m_redirect_cache_invalidated;
+    OpenVerifyStripedCounter m_breaker_opened;
+    OpenVerifyStripedCounter m_breaker_half_opened;
+    OpenVerifyStripedCounter m_breaker_closed;
+    OpenVerifyStripedCounter m_recovery_ms_sum;
 
+    OpenVerifyLatencyHistogram m_queue_wait;
+    OpenVerifyLatencyHistogram m_follower_wait;
+    std::array<OpenVerifyLatencyHistogram, 4> m_xrdcl_steps;  // indexed by XrdClStep
+    OpenVerifyLatencyHistogram m_open_duration;
+
+    const size_t m_host_latency_limit;  // XRD_OPENVERIFY_HOST_METRICS_MAX
+    mutable std::mutex m_host_latency_mtx;
+    std::unordered_map<std::string, std::unique_ptr<PerHostLatency>> m_verify_by_host;
+    const size_t m_class_latency_limit;  // XRD_OPENVERIFY_CLASS_METRICS_MAX
+    std::unordered_map<std::string, std::unique_ptr<PerClassLatency>> m_wait_by_class;  // m_host_latency_mtx
+
+    mutable std::mutex m_collector_mtx;
+    int m_next_collector_id{0};
+    std::map<int, Collector> m_collectors;
+
+    // Failures are rare next to lookups (each one already paid for a remote round trip), so the
+    // breakdown is kept as plain counts under one mutex.
     mutable std::mutex m_failure_mtx;
-    mutable std::unordered_map<std::string, std::unique_ptr<PerFailureMetrics>> m_failures_by_target_reason;
+    OpenVerifyTopK<FailureTarget> m_failure_targets;
+    std::map<std::string, uint64_t> m_failures_other;  // escaped reason -> count
+
+    std::unique_ptr<OpenVerifyMetricsHttpServer> m_http;
+    std::string m_http_error;
 };
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Minimal embedded HTTP/1.x listener serving GET /metrics for Prometheus scrapes.
+//
+// One thread multiplexes the listening socket and up to kMaxConnections clients with poll()
+// over non-blocking sockets. The exposition body is rendered only when a scrape arrives, so
+// nothing is written to disk between scrapes. Every response closes the connection.
+class OpenVerifyMetricsHttpServer {
+   public:
+    using Renderer = std::function<std::string()>;
+
+    explicit OpenVerifyMetricsHttpServer(Renderer render);
+    OpenVerifyMetricsHttpServer(const OpenVerifyMetricsHttpServer&) = delete;
+    OpenVerifyMetricsHttpServer& operator=(const OpenVerifyMetricsHttpServer&) = delete;
+    ~OpenVerifyMetricsHttpServer();
+
+    // Binds `address` (an IPv4 literal, normally 127.0.0.1) on `port` (0 picks an ephemeral port)
+    // and starts the serving thread. Returns false if the socket could not be set up; StartError()
+    // then holds the errno (EINVAL for an address that does not parse).
+    bool Start(const std::string& address, uint16_t port);
+    void Stop();
+
+    // Port actually bound; 0 before a successful Start().
+    uint16_t Port() const { return m_port; }
+    int StartError() const { return m_start_error; }
+
+   private:
+    struct Connection {
+        int fd{-1};
+        std::string in;
+        std::string out;
+        size_t out_off{0};
+        std::chrono::steady_clock::time_point deadline;
+    };
+
+    static constexpr size_t kMaxConnections = 16;
+    static constexpr size_t kMaxRequestBytes = 8192;
+
+    void Serve();
+    void AcceptAll();
+    // Returns false when the connection is finished and should be closed.
+    bool OnReadable(Connection& c);
+    bool OnWritable(Connection& c);
+    std::string BuildResponse(const std::string& request_head);
+
+    Renderer m_render;
+    int m_listen_fd{-1};
+    int m_wake_pipe[2]{-1, -1};
+    uint16_t m_port{0};
+    int m_start_error{0};
+    std::vector<Connection> m_conns;
+    std::thread m_thread;
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+// Bounded lock-free multi-producer, single-consumer ring (after Vyukov's bounded queue). A
+// producer claims a slot, fills the value in place and publishes it; claiming is one CAS on the
+// head and never waits, and fails when the ring is full. One consumer thread reads published
+// slots in claim order. Capacity is rounded up to a power of two.
+//
+// Slot values are reused, not reconstructed: producers overwrite whatever fields they use.
+template <typename T>
+class OpenVerifyMpscRing {
+   public:
+    explicit OpenVerifyMpscRing(size_t capacity) : m_mask(RoundUpPow2(capacity) - 1), m_cells(new Cell[m_mask + 1]) {
+        for (size_t i = 0; i <= m_mask; ++i) m_cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+    OpenVerifyMpscRing(const OpenVerifyMpscRing&) = delete;
+    OpenVerifyMpscRing& operator=(const OpenVerifyMpscRing&) = delete;
+
+    // Producer: reserves the next slot, or nullptr when the ring is full. `pos` goes to Publish.
+    T* Claim(size_t& pos) {
+        pos = m_head.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = m_cells[pos & m_mask];
+            const size_t seq = cell.seq.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) return &cell.value;
+            } else if (diff < 0) {
+                return nullptr;
+            } else {
+                pos = m_head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Producer: hands the slot claimed at `pos` to the consumer.
+    void Publish(size_t pos) { m_cells[pos & m_mask].seq.store(pos + 1, std::memory_order_release); }
+
+    // Consumer: the oldest published value, or nullptr if the next slot is not published yet.
+    T* Front() {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        Cell& cell = m_cells[tail & m_mask];
+        return cell.seq.load(std::memory_order_acquire) == tail + 1 ? &cell.value : nullptr;
+    }
+
+    // Consumer: releases the slot Front() returned.
+    void Pop() {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        m_cells[tail & m_mask].seq.store(tail + m_mask + 1, std::memory_order_release);
+        m_tail.store(tail + 1, std::memory_order_release);
+    }
+
+    // Slots claimed and slots consumed so far; a flush waits until Consumed() reaches Claimed().
+    size_t Claimed() const { return m_head.load(std::memory_order_acquire); }
+    size_t Consumed() const { return m_tail.load(std::memory_order_acquire); }
+
+    size_t Capacity() const { return m_mask + 1; }
+
+   private:
+    struct Cell {
+        std::atomic<size_t> seq{0};
+        T value;
+    };
+
+    static size_t RoundUpPow2(size_t n) {
+        size_t p = 2;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    const size_t m_mask;
+    std::unique_ptr<Cell[]> m_cells;
+    alignas(64) std::atomic<size_t> m_head{0};  // next position to claim
+    alignas(64) std::atomic<size_t> m_tail{0};  // next position to consume
+};
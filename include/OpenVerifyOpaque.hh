@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Indexed, non-owning view of an opaque ("k1=v1&k2=v2", optionally with a leading '?'), split
+// once per open and shared by every consumer on the open path: token lookup, tried= injection
+// into the redirector opaque and the XrdCl verify URL. Names and values are views into the
+// caller's string, which must outlive this object; nothing is decoded until asked for. Up to
+// kInlinePairs pairs are indexed without allocating.
+class OpenVerifyOpaque {
+   public:
+    struct Pair {
+        std::string_view name;   // raw (still URL-encoded)
+        std::string_view value;  // raw; empty (at the end of `name`) when the pair has no '='
+    };
+
+    static constexpr size_t kInlinePairs = 16;
+
+    explicit OpenVerifyOpaque(const char* opaque);
+    explicit OpenVerifyOpaque(std::string_view opaque);
+    OpenVerifyOpaque(const OpenVerifyOpaque&) = delete;
+    OpenVerifyOpaque& operator=(const OpenVerifyOpaque&) = delete;
+
+    // The opaque without its leading '?'.
+    std::string_view Raw() const { return m_raw; }
+    size_t Size() const { return m_size; }
+    const Pair& operator[](size_t i) const { return i < kInlinePairs ? m_inline[i] : m_overflow[i - kInlinePairs]; }
+
+    // Raw value of the first pair named exactly `name`; empty if absent.
+    std::string_view Find(std::string_view name) const;
+    bool Has(std::string_view name) const;
+
+    // Bearer token from the first authorization-style pair (authorization, authz, bearer,
+    // bearer_token, token, access_token; names compared URL-decoded and case-insensitively).
+    // The value is URL-decoded, trimmed and stripped of a "Bearer " prefix. False if none.
+    bool FindToken(std::string& out) const;
+
+    // Appends the opaque (without '?') to `out`, with `tried_hosts` (comma-separated) added to
+    // its tried= list, or as a new tried= pair if it has none.
+    void AppendWithTried(std::string& out, std::string_view tried_hosts) const;
+    // Length AppendWithTried adds, for reserving.
+    size_t SizeWithTried(std::string_view tried_hosts) const;
+
+   private:
+    void Parse();
+    const Pair* FindPair(std::string_view name) const;
+    const Pair* TriedPair() const;
+
+    std::string_view m_raw;
+    size_t m_size{0};
+    std::array<Pair, kInlinePairs> m_inline{};
+    std::vector<Pair> m_overflow;
+};
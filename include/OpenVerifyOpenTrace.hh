@@ -0,0 +1,203 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "OpenVerifyMetrics.hh"
+#include "OpenVerifyMpscRing.hh"
+
+// Sampled per-open traces, appended to a local file as JSON lines.
+//
+// XRD_OPENVERIFY_TRACE_PATH: file to append to; unset or empty turns tracing off, and an open
+// then pays one branch per trace point. XRD_OPENVERIFY_TRACE_SAMPLE (default 100) keeps one open
+// in N per thread; XRD_OPENVERIFY_TRACE_SLOW_MS (default 1000) also keeps every open at least
+// this slow. If the file cannot be opened, tracing stays off and OpenError() says why; the
+// filesystem logs it at startup.
+//
+// While on, each open records into a Span on its own stack: every wrapped open attempt with its
+// redirect target, avoided hosts, verify cache outcome, single-flight role and wait, each XrdCl
+// step, and the final tried= list. Nothing is allocated or locked, except for a verify that runs
+// off the open's thread (Recorder). A kept span is copied into a slot of a lock-free ring
+// (XRD_OPENVERIFY_TRACE_QUEUE slots, default 1024); a background thread formats it and writes the
+// line. When the ring is full the trace is dropped and counted; WriteExposition exports
+// xrootd_openverify_open_trace_written_total and _dropped_total.
+//
+// One line per open:
+//   {"start_us":..., "path":"...", "duration_us":..., "rc":..., "resumed":false, "tried":"h1:1094",
+//    "events":[{"at_us":..., "event":"attempt", "duration_us":..., "rc":-256, "target":"h2:1094"},
+//              {"at_us":..., "event":"cache", "result":"miss"}, ...]}
+// start_us is wall-clock microseconds since the epoch; at_us is relative to the start of the open.
+class OpenVerifyOpenTrace {
+   public:
+    enum class CacheResult : uint8_t { Miss, Positive, Negative };
+    enum class Role : uint8_t { Leader, Follower, Refused };
+
+    static constexpr size_t kMaxEvents = 24;
+    static constexpr size_t kTextMax = 255;
+
+    struct Event {
+        enum class Kind : uint8_t { Attempt, Avoided, RedirectCache, Cache, SingleFlight, Verify, XrdCl };
+        Kind kind;
+        uint8_t detail;        // CacheResult, Role or XrdClStep
+        int32_t rc;            // open rc, or XrdCl status code (0 ok)
+        uint32_t at_us;        // since the start of the open
+        uint32_t duration_us;  // attempt, wait or step duration
+        char target[64];       // host:port, NUL-terminated, possibly cut
+    };
+
+    struct Record {
+        int64_t start_us;
+        uint32_t duration_us;
+        int32_t rc;
+        bool resumed;
+        uint8_t events;
+        bool events_cut;  // more than kMaxEvents happened
+        char path[kTextMax + 1];
+        char tried[kTextMax + 1];
+        Event event[kMaxEvents];
+    };
+
+    class Recorder;
+
+    // Trace of one open. Every method is a no-op while the trace is off.
+    class Span {
+       public:
+        Span(OpenVerifyOpenTrace& trace, std::string_view path);
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+        bool Active() const { return m_trace != nullptr; }
+        // The time while tracing, so that an open times its steps only then.
+        std::chrono::steady_clock::time_point Now() const {
+            return m_trace ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+        }
+
+        void Resumed() {
+            if (m_trace) m_record.resumed = true;
+        }
+        void Attempt(int rc, std::chrono::steady_clock::duration d, std::string_view target) {
+            if (m_trace) Add(Event::Kind::Attempt, 0, rc, d, target);
+        }
+        void Avoided(std::string_view target) {
+            if (m_trace) Add(Event::Kind::Avoided, 0, 0, {}, target);
+        }
+        void RedirectCacheHit(std::string_view target) {
+            if (m_trace) Add(Event::Kind::RedirectCache, 0, 0, {}, target);
+        }
+        void Cache(CacheResult result) {
+            if (m_trace) Add(Event::Kind::Cache, static_cast<uint8_t>(result), 0, {}, {});
+        }
+        // Leaders: wait for admission; followers: wait for the leader's result.
+        void SingleFlight(Role role, std::chrono::steady_clock::duration wait) {
+            if (m_trace) Add(Event::Kind::SingleFlight, static_cast<uint8_t>(role), 0, wait, {});
+        }
+        void Verify(int code, std::chrono::steady_clock::duration d) {
+            if (m_trace) Add(Event::Kind::Verify, 0, code, d, {});
+        }
+        void XrdClStep(OpenVerifyMetrics::XrdClStep step, std::chrono::steady_clock::duration d, int code) {
+            if (m_trace) Add(Event::Kind::XrdCl, static_cast<uint8_t>(step), code, d, {});
+        }
+
+        // Ends the trace; kept if sampled or slow.
+        void Finish(int rc, std::string_view tried_hosts);
+
+       private:
+        friend class Recorder;
+        void Add(Event::Kind kind, uint8_t detail, int rc, std::chrono::steady_clock::duration d,
+                 std::string_view target) {
+            Add(kind, detail, rc, d, target, std::chrono::steady_clock::now());
+        }
+        // `end`: when the event ended, for its at_us.
+        void Add(Event::Kind kind, uint8_t detail, int rc, std::chrono::steady_clock::duration d,
+                 std::string_view target, std::chrono::steady_clock::time_point end);
+
+        OpenVerifyOpenTrace* m_trace;
+        bool m_sampled{false};
+        std::chrono::steady_clock::time_point m_start;
+        Record m_record;
+    };
+
+    // Verify and XrdCl step events of a verify that runs off the open's thread and may outlive
+    // the open (a detached single-flight verify). The verify records here, under a mutex; the
+    // open copies whatever has been recorded into its Span with Replay(), at the original times.
+    class Recorder {
+       public:
+        void Verify(int code, std::chrono::steady_clock::duration d) { Add(Event::Kind::Verify, 0, code, d); }
+        void XrdClStep(OpenVerifyMetrics::XrdClStep step, std::chrono::steady_clock::duration d, int code) {
+            Add(Event::Kind::XrdCl, static_cast<uint8_t>(step), code, d);
+        }
+
+        void Replay(Span& span) const;
+
+       private:
+        struct Entry {
+            Event::Kind kind;
+            uint8_t detail;
+            int rc;
+            std::chrono::steady_clock::duration d;
+            std::chrono::steady_clock::time_point end;
+        };
+
+        void Add(Event::Kind kind, uint8_t detail, int rc, std::chrono::steady_clock::duration d);
+
+        mutable std::mutex m_mtx;
+        std::vector<Entry> m_entries;
+    };
+
+    OpenVerifyOpenTrace();
+    OpenVerifyOpenTrace(const std::string& path, uint32_t sample_every, std::chrono::milliseconds slow_threshold,
+                        size_t capacity);
+    OpenVerifyOpenTrace(const OpenVerifyOpenTrace&) = delete;
+    OpenVerifyOpenTrace& operator=(const OpenVerifyOpenTrace&) = delete;
+    // Writes out everything queued, then stops the writer thread.
+    ~OpenVerifyOpenTrace();
+
+    bool Enabled() const { return m_file != nullptr; }
+    const std::string& Path() const { return m_path; }
+    // errno from opening Path(); 0 if it opened or no path was set.
+    int OpenError() const { return m_open_error; }
+
+    // Blocks until every trace kept so far has been written and flushed.
+    void Flush();
+
+    uint64_t Dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    // Metrics collector body (see OpenVerifyMetrics::AddCollector); nothing while tracing is off.
+    void WriteExposition(std::ostream& out, const std::string& lbl) const;
+
+    // The JSON line for `record`, without the newline.
+    static std::string Format(const Record& record);
+
+   private:
+    // Sample decision for the calling thread's next open.
+    bool Sample();
+    void Keep(const Record& record);
+
+    // Writer thread only.
+    size_t WriteOnce();
+    void WriterLoop();
+
+    const uint32_t m_sample_every;
+    const std::chrono::steady_clock::duration m_slow_threshold;
+    const std::string m_path;
+    std::FILE* m_file{nullptr};
+    int m_open_error{0};
+    OpenVerifyMpscRing<Record> m_ring;
+    std::atomic<uint64_t> m_dropped{0};
+    std::atomic<size_t> m_written{0};  // records in the file, flushed
+
+    std::mutex m_wake_mtx;
+    std::condition_variable m_wake_cv;
+    bool m_stop{false};  // guarded by m_wake_mtx
+    std::thread m_thread;
+};
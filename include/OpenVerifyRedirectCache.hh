@@ -0,0 +1,59 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Last verified redirect target per path, so that repeated opens of a hot file can be redirected
+// without asking the wrapped OFS (a cmsd lookup) again. OpenVerifyFile::open records the target
+// whenever a redirect verifies, or hits a positive verify cache entry, and answers later opens of
+// the path with SFS_REDIRECT to it while the entry is fresh, the host's breaker is closed and the
+// verify cache entry for (host, path) is still positive. The data server still authorizes the
+// redirected open.
+//
+// Off unless XRD_OPENVERIFY_REDIRECT_CACHE_TTL_MS is set (entry lifetime in milliseconds). At most
+// XRD_OPENVERIFY_REDIRECT_CACHE_MAX paths are kept (default 4096), dropping the oldest first.
+class OpenVerifyRedirectCache {
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    // Redirect as returned by the wrapped OFS: error text (host, possibly with "?cgi") and port.
+    struct Target {
+        std::string host;
+        int port{-1};
+    };
+
+    OpenVerifyRedirectCache();
+    // For tests: explicit lifetime and capacity.
+    OpenVerifyRedirectCache(std::chrono::milliseconds ttl, size_t capacity);
+    OpenVerifyRedirectCache(const OpenVerifyRedirectCache&) = delete;
+    OpenVerifyRedirectCache& operator=(const OpenVerifyRedirectCache&) = delete;
+
+    bool Enabled() const { return m_ttl.count() > 0; }
+
+    void Put(const std::string& path, Target target, Clock::time_point now = Clock::now());
+    // Fresh target for `path`, if any.
+    bool Get(const std::string& path, Target& out, Clock::time_point now = Clock::now()) const;
+    // Drops the entry for `path` if it still points at `host`:`port`; true if one was dropped.
+    bool Invalidate(const std::string& path, const std::string& host, int port);
+    size_t Size() const;
+
+   private:
+    struct Slot {
+        Target target;
+        Clock::time_point expires;
+        std::list<std::string>::iterator order;
+    };
+
+    void EraseLocked(std::unordered_map<std::string, Slot>::iterator it);
+
+    const std::chrono::milliseconds m_ttl;
+    const size_t m_capacity;
+
+    mutable std::mutex m_mtx;
+    std::unordered_map<std::string, Slot> m_slots;
+    std::list<std::string> m_order;  // insertion order, oldest first
+};
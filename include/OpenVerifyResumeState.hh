@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Open state carried across a stall that OpenVerifyFile::open hands back to the client instead of
+// sleeping on the server thread: the hosts already tried and the attempts used, keyed by client
+// and path, so the client's retry resumes where the stalled open stopped.
+//
+// An entry lives for the stall plus XRD_OPENVERIFY_RESUME_TTL_S seconds (default 30) and is
+// consumed by the first retry. At most XRD_OPENVERIFY_RESUME_MAX entries are kept (default 4096);
+// the oldest is dropped first, which only costs the client a fresh start.
+class OpenVerifyResumeState {
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        std::string tried_hosts;
+        int attempts{0};
+    };
+
+    OpenVerifyResumeState();
+    OpenVerifyResumeState(const OpenVerifyResumeState&) = delete;
+    OpenVerifyResumeState& operator=(const OpenVerifyResumeState&) = delete;
+
+    // Key for a client's open of `path`; `tident` is the client's trace identifier (may be null).
+    static std::string Key(const char* tident, const std::string& path);
+
+    void Put(const std::string& key, Entry entry, std::chrono::seconds stall, Clock::time_point now = Clock::now());
+    // Removes and returns the live entry for `key`, if any.
+    bool Take(const std::string& key, Entry& out, Clock::time_point now = Clock::now());
+    size_t Size() const;
+
+   private:
+    struct Slot {
+        Entry entry;
+        Clock::time_point expires;
+        std::list<std::string>::iterator order;
+    };
+
+    void EraseLocked(std::unordered_map<std::string, Slot>::iterator it);
+
+    const size_t m_capacity;
+    const std::chrono::seconds m_ttl;
+
+    mutable std::mutex m_mtx;
+    std::unordered_map<std::string, Slot> m_slots;
+    std::list<std::string> m_order;  // insertion order, oldest first
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+#include "OpenVerifyMetrics.hh"
+
+// Token-bucket retry budget shared by all opens (as in Finagle's RetryBudget). Every first
+// attempt deposits XRD_OPENVERIFY_RETRY_BUDGET_PERCENT/100 of a token (default 20), except
+// that of an open resuming after a stall; every re-ask of the redirector (after a failed verify
+// or an avoided host) withdraws one. XRD_OPENVERIFY_RETRY_BUDGET_MIN_PER_SEC (default 10)
+// retries per second are always affordable, so a quiet server can still retry.
+//
+// Deposits and withdrawals expire after XRD_OPENVERIFY_RETRY_BUDGET_TTL_S seconds (default 10,
+// at most 60), kept in a ring of per-second buckets. During an outage, retries stay bounded
+// by the fraction of recent first attempts instead of multiplying every open by max_retries.
+class OpenVerifyRetryBudget {
+   public:
+    explicit OpenVerifyRetryBudget(OpenVerifyMetrics& metrics);
+    OpenVerifyRetryBudget(const OpenVerifyRetryBudget&) = delete;
+    OpenVerifyRetryBudget& operator=(const OpenVerifyRetryBudget&) = delete;
+    ~OpenVerifyRetryBudget();
+
+    // Records a first attempt.
+    void Deposit(std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+    // Takes one retry from the budget; false when it is exhausted.
+    bool TryWithdraw(std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+    // Retries currently affordable.
+    double Balance(std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+   private:
+    static constexpr size_t kMaxWindowBuckets = 60;
+
+    struct WindowBucket {
+        int64_t second{-1};  // steady_clock second this bucket currently holds
+        uint32_t deposits{0};
+        uint32_t withdrawals{0};
+    };
+
+    static int64_t SecondOf(std::chrono::steady_clock::time_point t);
+    // All of these require m_mtx.
+    WindowBucket& BucketLocked(int64_t second);
+    double BalanceLocked(int64_t second) const;
+
+    // Metrics collector: balance gauge.
+    void WriteExposition(std::ostream& out, const std::string& lbl);
+
+    const double m_ratio;
+    const int64_t m_ttl_s;
+    const double m_reserve;
+
+    std::mutex m_mtx;
+    std::array<WindowBucket, kMaxWindowBuckets> m_window{};
+
+    OpenVerifyMetrics& m_metrics;
+    int m_collector_id{-1};
+};
@@ -1,26 +1,96 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <deque>
 #include <functional>
 #include <list>
 #include <memory>
 #include <mutex>
+#include <ostream>
 #include <string>
 #include <unordered_map>
 
+#include "OpenVerifyCoDel.hh"
+#include "OpenVerifyConcurrencyLimit.hh"
 #include "OpenVerifyMetrics.hh"
 #include "XrdCl/XrdClXRootDResponses.hh"
 
 
+// Per-key single-flight with bulkheaded admission of leaders. Live occupancy (active and waiting
+// leaders, in-flight keys, waiting followers) is sampled into the metrics exposition at export time.
+//
+// Leaders queue FIFO per partition (the redirect target host:port). Each partition may run at
+// most XRD_OPENVERIFY_MAX_INFLIGHT_PER_HOST verifies and queue XRD_OPENVERIFY_MAX_WAITERS_PER_HOST
+// more, and free global slots are handed out round-robin across partitions, so a slow or
+// blackholed server only ever ties up its own share of the capacity.
+//
+// Above the host level, leaders are grouped by client class (VO, role or user; see
+// XRD_OPENVERIFY_FAIR_KEY) and classes share the global slots by deficit round robin, weighted
+// by XRD_OPENVERIFY_FAIR_WEIGHTS ("cms=4,atlas=2"; unlisted classes weigh 1). When the waiter
+// backlog is full, a newcomer pushes out the newest waiter of the class with the longest backlog,
+// so one client flooding the queue cannot lock others out of it.
+//
+// XRD_OPENVERIFY_CODEL=1 adds controlled-delay queue management (OpenVerifyCoDel): once a
+// standing queue is detected (XRD_OPENVERIFY_CODEL_TARGET_MS / _INTERVAL_MS), hosts are served
+// newest-first and waiters older than the target are shed instead of sitting out the full
+// XRD_OPENVERIFY_QUEUE_TIMEOUT_MS.
+//
+// Every caller has a wait budget of XRD_OPENVERIFY_FOLLOWER_TIMEOUT_MS (default 10000) from its
+// arrival. A follower whose leader has not finished by then gets openverify_follower_timeout.
+// With RunDetached the leader's verify runs off the leader's thread and the leader waits for its
+// result like a follower, getting openverify_leader_timeout at its own wait deadline while the
+// verify runs on for the followers. VerifyDeadline() is the last of the leader's and the
+// followers' wait deadlines; past it nobody is left to use the verify's result, so the verify
+// is cut off there.
+//
+// The number of leaders admitted at once is XRD_OPENVERIFY_MAX_INFLIGHT. With
+// XRD_OPENVERIFY_ADAPTIVE_LIMIT=1 that value is only the starting point and the limit follows
+// verify latency (OpenVerifyConcurrencyLimit) within XRD_OPENVERIFY_INFLIGHT_MIN..._MAX. Verifies
+// that time out are not fed to it; a blackholed host only fills its own partition.
 class OpenVerifySingleFlight {
    public:
     explicit OpenVerifySingleFlight(OpenVerifyMetrics& metrics);
     OpenVerifySingleFlight(const OpenVerifySingleFlight&) = delete;
     OpenVerifySingleFlight& operator=(const OpenVerifySingleFlight&) = delete;
+    ~OpenVerifySingleFlight();
 
     // Runs `fn` once per key while in-flight; concurrent callers wait and receive the same result.
-    XrdCl::XRootDStatus Run(const std::string& key, const std::function<XrdCl::XRootDStatus()>& fn);
+    // `partition` names the admission bulkhead (normally host:port of the key's target).
+    XrdCl::XRootDStatus Run(const std::string& key, const std::string& partition,
+                            const std::function<XrdCl::XRootDStatus()>& fn);
+    // As above; `client_class` selects the fair-queuing class of a leader (empty: default class).
+    XrdCl::XRootDStatus Run(const std::string& key, const std::string& partition, const std::string& client_class,
+                            const std::function<XrdCl::XRootDStatus()>& fn);
+    // As above, with the caller's overall deadline: queue and follower waits end at `deadline`
+    // at the latest, and so does the leader's share of VerifyDeadline().
+    XrdCl::XRootDStatus Run(const std::string& key, const std::string& partition, const std::string& client_class,
+                            std::chrono::steady_clock::time_point deadline,
+                            const std::function<XrdCl::XRootDStatus()>& fn);
+
+    // Ends a detached verify with its result. Only the first call counts; it must not be
+    // dropped uncalled, or the key and its admission slot are never released.
+    using Done = std::function<void(const XrdCl::XRootDStatus&)>;
+    // As Run, but an admitted leader calls `start`, which starts the verify and returns; the
+    // verify reports through `done`, from any thread and possibly after RunDetached returned.
+    // The leader then waits for the result as a follower does, until its own wait deadline.
+    XrdCl::XRootDStatus RunDetached(const std::string& key, const std::string& partition,
+                                    const std::string& client_class, std::chrono::steady_clock::time_point deadline,
+                                    const std::function<void(Done)>& start);
+    // Blocks until every detached verify has called its `done`.
+    void Drain();
+
+    // For the leader of `key`, from inside `fn`: when the last caller waiting on the verify gives
+    // up. That is the later of the leader's budget and every follower's wait deadline, so a
+    // leader with a short deadline does not cut the verify off for followers with longer ones.
+    std::chrono::steady_clock::time_point VerifyDeadline(const std::string& key) const;
+
+    // Results meaning "gave up waiting" (including a verify cut off by the open deadline) rather
+    // than a verify outcome.
+    static bool IsWaitExpired(const XrdCl::XRootDStatus& st);
+    // Results meaning admission was refused (queue full, timed out or shed); `fn` never ran.
+    static bool IsOverloaded(const XrdCl::XRootDStatus& st);
 
    private:
     struct InFlight {
@@ -28,28 +98,114 @@ class OpenVerifySingleFlight {
         std::condition_variable cv;
         bool done{false};
         XrdCl::XRootDStatus result;
+        // Followers currently blocked on this key; read by the metrics collector.
+        std::atomic<size_t> followers{0};
+        // Latest of the leader's and the followers' wait deadlines; guarded by m_map_mutex.
+        std::chrono::steady_clock::time_point verify_deadline;
     };
 
+    struct HostPartition;
+    struct HostQueue;
+    struct ClassQueue;
+
     // Each waiting leader holds one of these on its stack; the per-waiter CV allows
-    // targeted wakeup (notify_one on the head) instead of notify_all.
+    // targeted wakeup of the leader being admitted instead of notify_all.
     struct FifoWaitTag {
+        enum class Outcome { Waiting, Admitted, Shed, Evicted };
+
         std::condition_variable cv;
+        std::chrono::steady_clock::time_point queued_at;
+        HostPartition* host{nullptr};
+        HostQueue* queue{nullptr};  // while waiting
+        std::list<FifoWaitTag*>::iterator pos;
+        Outcome outcome{Outcome::Waiting};
+    };
+
+    // Per-host bulkhead, shared by all classes; lives while any leader of it is between
+    // AcquirePartitionLocked and ReleasePartitionLocked.
+    struct HostPartition {
+        size_t active{0};
+        size_t waiting{0};
+        size_t refs{0};
+    };
+
+    // Waiters of one class for one host, in arrival order.
+    struct HostQueue {
+        ClassQueue* cls{nullptr};
+        HostPartition* host{nullptr};
+        std::list<FifoWaitTag*> waiters;
+        bool in_ring{false};  // queued in cls->ring
     };
 
-    // Maximum leaders admitted to run concurrently (XRD_OPENVERIFY_MAX_INFLIGHT).
-    const int m_main_limit;
-    // Maximum leaders allowed to wait in the FIFO backlog (XRD_OPENVERIFY_MAX_WAITERS).
+    // Fair-queuing class. Queues with no waiters are dropped by CollectIdleQueuesLocked.
+    struct ClassQueue {
+        size_t weight{1};
+        size_t deficit{0};
+        bool turn_open{false};
+        bool in_ring{false};  // queued in m_class_ring
+        size_t waiting{0};
+        std::unordered_map<std::string, std::unique_ptr<HostQueue>> hosts;
+        std::deque<HostQueue*> ring;  // host queues with waiters, round-robin order
+    };
+
+    // All of these require m_fifo_mutex.
+    HostPartition& AcquirePartitionLocked(const std::string& partition);
+    void ReleasePartitionLocked(const std::string& partition, HostPartition& part);
+    void EnqueueLocked(FifoWaitTag& tag, const std::string& client_class, const std::string& partition);
+    // Takes a waiter out of its queues, leaving empty queues out of the rings.
+    void DetachLocked(FifoWaitTag& tag);
+    void CollectIdleQueuesLocked();
+    // Frees a backlog place for `client_class` by evicting the newest waiter of the class with
+    // the longest backlog; false if that would be the newcomer's own class.
+    bool EvictForLocked(const std::string& client_class);
+    // Next host queue of `cls` below its host cap (rotating the class's host ring), or nullptr.
+    HostQueue* NextHostLocked(ClassQueue& cls);
+    // Sheds stale waiters (CoDel overload only), then admits waiting leaders while global
+    // capacity remains.
+    void DispatchLocked();
+
+    // Settles `key` with `result`: wakes everyone waiting on it and takes it out of the map.
+    void Publish(const std::string& key, const std::shared_ptr<InFlight>& in_flight,
+                 const XrdCl::XRootDStatus& result);
+
+    // Leaders admitted to run concurrently; guarded by m_fifo_mutex.
+    OpenVerifyConcurrencyLimit m_limit;
+    // Maximum leaders allowed to wait in the backlog, all hosts (XRD_OPENVERIFY_MAX_WAITERS).
     const int m_wait_limit;
+    // Per-partition caps (XRD_OPENVERIFY_MAX_INFLIGHT_PER_HOST, XRD_OPENVERIFY_MAX_WAITERS_PER_HOST).
+    const size_t m_host_limit;
+    const size_t m_host_wait_limit;
 
     // XRD_OPENVERIFY_QUEUE_TIMEOUT_MS
     const std::chrono::milliseconds m_queue_timeout;
+    // XRD_OPENVERIFY_FOLLOWER_TIMEOUT_MS
+    const std::chrono::milliseconds m_wait_timeout;
+
+    // Guarded by m_fifo_mutex.
+    OpenVerifyCoDel m_codel;
+
+    // XRD_OPENVERIFY_FAIR_WEIGHTS
+    const std::unordered_map<std::string, size_t> m_class_weights;
 
     std::mutex m_fifo_mutex;
-    std::list<FifoWaitTag*> m_fifo;
+    std::unordered_map<std::string, std::unique_ptr<HostPartition>> m_partitions;
+    std::unordered_map<std::string, std::unique_ptr<ClassQueue>> m_classes;
+    // Classes with waiters, in deficit-round-robin order.
+    std::deque<ClassQueue*> m_class_ring;
+    size_t m_waiting{0};
     size_t m_active{0};
 
+    // Metrics collector: occupancy gauges.
+    void WriteExposition(std::ostream& out, const std::string& lbl);
+
     OpenVerifyMetrics& m_metrics;
+    int m_collector_id{-1};
 
     mutable std::mutex m_map_mutex;
     std::unordered_map<std::string, std::shared_ptr<InFlight>> m_in_flight_map;
+
+    // Admitted verifies whose `done` has not finished yet; for Drain().
+    std::mutex m_drain_mutex;
+    std::condition_variable m_drain_cv;
+    size_t m_running{0};
 };
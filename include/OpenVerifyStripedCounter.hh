@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <thread>
+
+// Monotonic counter split over cache-line-padded slots so concurrent writers on
+// different cores do not bounce one line between them. Each thread is bound to a
+// slot on first use (round-robin); Load() sums all slots and is meant for export
+// paths, not for hot-path decisions.
+class OpenVerifyStripedCounter {
+   public:
+    // Default: one slot per hardware thread, rounded up to a power of two, capped at kMaxStripes.
+    OpenVerifyStripedCounter() : OpenVerifyStripedCounter(DefaultStripes()) {}
+
+    explicit OpenVerifyStripedCounter(size_t stripes)
+        : m_mask(RoundUpPow2(stripes) - 1), m_slots(std::make_unique<Slot[]>(m_mask + 1)) {}
+
+    OpenVerifyStripedCounter(const OpenVerifyStripedCounter&) = delete;
+    OpenVerifyStripedCounter& operator=(const OpenVerifyStripedCounter&) = delete;
+
+    void Add(uint64_t n = 1) { m_slots[ThreadIndex() & m_mask].value.fetch_add(n, std::memory_order_relaxed); }
+
+    uint64_t Load() const {
+        uint64_t sum = 0;
+        for (size_t i = 0; i <= m_mask; ++i) {
+            sum += m_slots[i].value.load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+
+    size_t Stripes() const { return m_mask + 1; }
+
+    static constexpr size_t kMaxStripes = 64;
+
+   private:
+    // 64 bytes covers x86_64 and most aarch64 parts; hardware_destructive_interference_size
+    // is not reliably available and warns under GCC when used in headers.
+    static constexpr size_t kCacheLine = 64;
+
+    struct alignas(kCacheLine) Slot {
+        std::atomic<uint64_t> value{0};
+    };
+
+    static size_t RoundUpPow2(size_t n) {
+        size_t p = 1;
+        while (p < n && p < kMaxStripes) p <<= 1;
+        return p;
+    }
+
+    static size_t DefaultStripes() {
+        const unsigned hw = std::thread::hardware_concurrency();
+        return hw == 0 ? 8 : static_cast<size_t>(hw);
+    }
+
+    static size_t ThreadIndex() {
+        static std::atomic<size_t> next{0};
+        thread_local const size_t index = next.fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }
+
+    const size_t m_mask;
+    std::unique_ptr<Slot[]> m_slots;
+};
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+// Lazily started coroutine returning T, used for the verify flow. A task runs when it is awaited
+// (or handed to StartDetached) and resumes its awaiter when it finishes, on whichever thread
+// completed it, by symmetric transfer rather than a nested resume() call. Exceptions travel to
+// the awaiter.
+template <typename T>
+class OpenVerifyTask {
+   public:
+    struct promise_type {
+        std::optional<T> value;
+        std::exception_ptr error;
+        std::coroutine_handle<> continuation;
+
+        OpenVerifyTask get_return_object() {
+            return OpenVerifyTask{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                const auto next = h.promise().continuation;
+                return next ? next : std::noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        template <typename U>
+        void return_value(U&& v) {
+            value.emplace(std::forward<U>(v));
+        }
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    OpenVerifyTask(OpenVerifyTask&& other) noexcept : m_handle(std::exchange(other.m_handle, {})) {}
+    OpenVerifyTask& operator=(OpenVerifyTask&& other) noexcept {
+        if (this != &other) {
+            if (m_handle) m_handle.destroy();
+            m_handle = std::exchange(other.m_handle, {});
+        }
+        return *this;
+    }
+    OpenVerifyTask(const OpenVerifyTask&) = delete;
+    OpenVerifyTask& operator=(const OpenVerifyTask&) = delete;
+    ~OpenVerifyTask() {
+        if (m_handle) m_handle.destroy();
+    }
+
+    // Awaiting a task starts it; the awaiter gets its value or exception.
+    bool await_ready() const noexcept { return m_handle.done(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        m_handle.promise().continuation = awaiting;
+        return m_handle;
+    }
+    T await_resume() { return Result(); }
+
+    // Only once the task has finished.
+    T Result() {
+        if (m_handle.promise().error) std::rethrow_exception(m_handle.promise().error);
+        return std::move(*m_handle.promise().value);
+    }
+
+    // Awaiter that starts the task and resumes without taking its result (for drivers).
+    struct Completion {
+        OpenVerifyTask& task;
+        bool await_ready() const noexcept { return task.m_handle.done(); }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+            return task.await_suspend(awaiting);
+        }
+        void await_resume() noexcept {}
+    };
+    Completion WhenDone() { return Completion{*this}; }
+
+   private:
+    explicit OpenVerifyTask(std::coroutine_handle<promise_type> h) : m_handle(h) {}
+
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+namespace openverify_detail {
+
+// Starts at once and frees itself when it finishes.
+struct DetachedDriver {
+    struct promise_type {
+        DetachedDriver get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+template <typename T, typename F>
+DetachedDriver DriveDetached(OpenVerifyTask<T> task, F on_done) {
+    co_await task.WhenDone();
+    on_done(task);
+}
+
+}  // namespace openverify_detail
+
+// Starts `task` and returns once it first suspends; nobody waits for it. When it finishes,
+// `on_done` is called with it on the thread that completed it (Result() gives the value or
+// rethrows), and the task is freed. `on_done` must not throw.
+template <typename T, typename F>
+void StartDetached(OpenVerifyTask<T> task, F on_done) {
+    openverify_detail::DriveDetached(std::move(task), std::move(on_done));
+}
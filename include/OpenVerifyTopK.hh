@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Space-Saving heavy-hitter table (Metwally et al.): tracks at most `capacity` keys. An unseen
+// key arriving at a full table takes over the slot with the smallest estimate and inherits that
+// estimate as its error bound, so every key whose true count exceeds N/capacity is guaranteed to
+// be present. Each slot carries a caller-defined payload; the payload of a recycled slot is handed
+// to the eviction callback and then reset.
+//
+// Not thread-safe; the owner serializes access. Eviction scans for the minimum, which is cheap
+// for the small capacities (tens to hundreds) used for metric label sets.
+template <typename Payload>
+class OpenVerifyTopK {
+   public:
+    struct Slot {
+        std::string key;
+        uint64_t estimate{0};  // upper bound on the key's true count
+        uint64_t error{0};     // over-estimation inherited when the slot was taken over
+        Payload payload{};
+    };
+
+    explicit OpenVerifyTopK(size_t capacity) : m_capacity(capacity > 0 ? capacity : 1) {
+        m_slots.reserve(m_capacity);
+    }
+
+    // Counts one occurrence of `key` and returns its slot. `on_evict(const Slot&)` runs before a
+    // slot is recycled for a new key; `fresh` is set when the returned slot was (re)initialized.
+    template <typename OnEvict>
+    Slot& Offer(const std::string& key, OnEvict&& on_evict, bool* fresh = nullptr) {
+        if (fresh) *fresh = false;
+        auto it = m_index.find(key);
+        if (it != m_index.end()) {
+            Slot& s = m_slots[it->second];
+            ++s.estimate;
+            return s;
+        }
+
+        if (fresh) *fresh = true;
+        if (m_slots.size() < m_capacity) {
+            m_index.emplace(key, m_slots.size());
+            m_slots.push_back(Slot{key, 1, 0, Payload{}});
+            return m_slots.back();
+        }
+
+        size_t victim = 0;
+        for (size_t i = 1; i < m_slots.size(); ++i) {
+            if (m_slots[i].estimate < m_slots[victim].estimate) victim = i;
+        }
+        Slot& s = m_slots[victim];
+        on_evict(static_cast<const Slot&>(s));
+        m_index.erase(s.key);
+        m_index.emplace(key, victim);
+        s.key = key;
+        s.error = s.estimate;
+        ++s.estimate;
+        s.payload = Payload{};
+        return s;
+    }
+
+    const std::vector<Slot>& Slots() const { return m_slots; }
+    size_t Capacity() const { return m_capacity; }
+
+   private:
+    const size_t m_capacity;
+    std::vector<Slot> m_slots;
+    std::unordered_map<std::string, size_t> m_index;
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <coroutine>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "XrdCl/XrdClAnyObject.hh"
+#include "XrdCl/XrdClFile.hh"
+#include "XrdCl/XrdClXRootDResponses.hh"
+
+// Outcome of an awaited XrdCl call; `response` is owned and may be null on failure.
+template <typename Response>
+struct XrdClResult {
+    XrdCl::XRootDStatus status;
+    std::unique_ptr<Response> response;
+};
+
+template <>
+struct XrdClResult<void> {
+    XrdCl::XRootDStatus status;
+};
+
+// Awaitable asynchronous XrdCl call. await_suspend issues the call with this object as its
+// ResponseHandler; the awaiting coroutine is resumed inline from the handler, on the XrdCl thread
+// that delivered the response, and runs there until its next call. A call XrdCl refuses to queue
+// completes at once.
+template <typename Response>
+class XrdClAwaitable : public XrdCl::ResponseHandler {
+   public:
+    using Issue = std::function<XrdCl::XRootDStatus(XrdCl::ResponseHandler*)>;
+
+    explicit XrdClAwaitable(Issue issue) : m_issue(std::move(issue)) {}
+
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<> awaiting) {
+        m_awaiting = awaiting;
+        const XrdCl::XRootDStatus st = m_issue(this);
+        if (st.IsOK()) return true;  // HandleResponse resumes us, maybe already on another thread
+        m_result.status = st;
+        return false;
+    }
+    XrdClResult<Response> await_resume() { return std::move(m_result); }
+
+    void HandleResponse(XrdCl::XRootDStatus* status, XrdCl::AnyObject* response) override {
+        if (status) {
+            m_result.status = *status;
+            delete status;
+        }
+        if constexpr (!std::is_void_v<Response>) {
+            if (response && m_result.status.IsOK()) {
+                Response* r = nullptr;
+                response->Get(r);
+                response->Set(static_cast<int*>(nullptr));  // take ownership of `r`
+                m_result.response.reset(r);
+            }
+        }
+        delete response;
+
+        m_awaiting.resume();
+    }
+
+   private:
+    Issue m_issue;
+    std::coroutine_handle<> m_awaiting;
+    XrdClResult<Response> m_result;
+};
+
+// Awaitable forms of the XrdCl::File calls used by the verify.
+inline XrdClAwaitable<void> AsyncOpen(XrdCl::File& f, const std::string& url, XrdCl::OpenFlags::Flags flags,
+                                      XrdCl::Access::Mode mode, time_t timeout) {
+    return XrdClAwaitable<void>(
+        [&f, &url, flags, mode, timeout](XrdCl::ResponseHandler* h) { return f.Open(url, flags, mode, h, timeout); });
+}
+
+inline XrdClAwaitable<XrdCl::StatInfo> AsyncStat(XrdCl::File& f, bool force, time_t timeout) {
+    return XrdClAwaitable<XrdCl::StatInfo>(
+        [&f, force, timeout](XrdCl::ResponseHandler* h) { return f.Stat(force, h, timeout); });
+}
+
+inline XrdClAwaitable<XrdCl::VectorReadInfo> AsyncVectorRead(XrdCl::File& f, const XrdCl::ChunkList& chunks,
+                                                             void* buffer, time_t timeout) {
+    return XrdClAwaitable<XrdCl::VectorReadInfo>(
+        [&f, &chunks, buffer, timeout](XrdCl::ResponseHandler* h) { return f.VectorRead(chunks, buffer, h, timeout); });
+}
+
+inline XrdClAwaitable<void> AsyncClose(XrdCl::File& f, time_t timeout) {
+    return XrdClAwaitable<void>([&f, timeout](XrdCl::ResponseHandler* h) { return f.Close(h, timeout); });
+}
@@ -1,13 +1,26 @@
 #ifndef __XRDOFSOPENVERIFY_H_
 #define __XRDOFSOPENVERIFY_H_
 
+#include <chrono>
 #include <ctime>
+#include <functional>
+#include <memory>
 #include <string>
+#include <type_traits>
 
 #include "OpenVerifyCache.hh"
+#include "OpenVerifyExecutor.hh"
 #include "OpenVerifyHostReliability.hh"
+#include "OpenVerifyIoTrace.hh"
+#include "OpenVerifyLog.hh"
 #include "OpenVerifyMetrics.hh"
+#include "OpenVerifyOpaque.hh"
+#include "OpenVerifyOpenTrace.hh"
+#include "OpenVerifyRedirectCache.hh"
+#include "OpenVerifyResumeState.hh"
+#include "OpenVerifyRetryBudget.hh"
 #include "OpenVerifySingleFlight.hh"
+#include "OpenVerifyTask.hh"
 #include "XrdOuc/XrdOucErrInfo.hh"
 #include "XrdSec/XrdSecEntity.hh"
 #include "XrdSfs/XrdSfsInterface.hh"
@@ -75,19 +88,37 @@ class OpenVerifyFileSystem : public XrdSfsFileSystem {
                  const char* opaque = 0) override;
 
     OpenVerifyFileSystem(XrdSfsFileSystem* nativeFS, XrdSysLogger* Logger, const char* configFn, XrdOucEnv* envP);
+    ~OpenVerifyFileSystem();
 
     XrdSfsFileSystem* m_next_sfs;
-    XrdSysError m_log;
+    XrdSysError m_syslog;
+    // Everything else logs through here; lines reach m_syslog from the log's drain thread.
+    OpenVerifyLog m_log{[this](OpenVerifyLog::Level level, const char* line) {
+        m_syslog.Emsg(OpenVerifyLog::LevelName(level), line);
+    }};
     const char* m_config;
     XrdOucEnv* m_env;
     OpenVerifyMetrics m_metrics;
     OpenVerifyCache m_cache;
     OpenVerifySingleFlight m_single_flight{m_metrics};
-    OpenVerifyHostReliability m_host_reliability;
+    OpenVerifyHostReliability m_host_reliability{m_metrics};
+    OpenVerifyRetryBudget m_retry_budget{m_metrics};
+    OpenVerifyResumeState m_resume_state;
+    OpenVerifyRedirectCache m_redirect_cache;
+    OpenVerifyIoTrace m_io_trace{m_metrics};
+    OpenVerifyOpenTrace m_open_trace;
+    OpenVerifyExecutor m_executor{m_metrics};
     const bool m_observe;
+
+   private:
+    // Metrics collector: cache size gauges.
+    void WriteCacheExposition(std::ostream& out, const std::string& lbl);
+
+    int m_cache_collector_id{-1};
+    int m_trace_collector_id{-1};
 };
 
-class OpenVerifyFile : public XrdSfsFile {
+class OpenVerifyFile final : public XrdSfsFile {
    public:
     int open(const char* fileName, XrdSfsFileOpenMode openMode, mode_t createMode, const XrdSecEntity* client,
              const char* opaque = 0) override;
@@ -98,57 +129,153 @@ class OpenVerifyFile : public XrdSfsFile {
 
     int fctl(const int cmd, const char* args, XrdOucErrInfo& out_error) override;
 
-    const char* FName() override;
-
     int getMmap(void** Addr, off_t& Size) override;
 
-    XrdSfsXferSize pgRead(XrdSfsFileOffset offset, char* buffer, XrdSfsXferSize rdlen, uint32_t* csvec,
-                          uint64_t opts = 0) override;
-
-    XrdSfsXferSize pgRead(XrdSfsAio* aioparm, uint64_t opts = 0) override;
-
-    XrdSfsXferSize pgWrite(XrdSfsFileOffset offset, char* buffer, XrdSfsXferSize rdlen, uint32_t* csvec,
-                           uint64_t opts = 0) override;
-
-    XrdSfsXferSize pgWrite(XrdSfsAio* aioparm, uint64_t opts = 0) override;
-
-    int read(XrdSfsFileOffset fileOffset, XrdSfsXferSize amount) override;
-
-    XrdSfsXferSize read(XrdSfsFileOffset fileOffset, char* buffer, XrdSfsXferSize buffer_size) override;
-
-    int read(XrdSfsAio* aioparm) override;
-
-    XrdSfsXferSize write(XrdSfsFileOffset fileOffset, const char* buffer, XrdSfsXferSize buffer_size) override;
-
-    int write(XrdSfsAio* aioparm) override;
-
-    int sync() override;
-
-    int sync(XrdSfsAio* aiop) override;
-
-    int stat(struct stat* buf) override;
-
     int truncate(XrdSfsFileOffset fileOffset) override;
 
     int getCXinfo(char cxtype[4], int& cxrsz) override;
 
-    int SendData(XrdSfsDio* sfDio, XrdSfsFileOffset offset, XrdSfsXferSize size) override;
+    // Data path. The wrapper only decides the open; everything after it goes straight to the
+    // native file, inline and untraced, so a wrapped read costs one extra indirect call over a
+    // native one (bench/OpenVerifyFileBench.cc). XrdSfs has no way to hand the native object
+    // back to the protocol after open, so the forward itself cannot be removed. The calls
+    // OpenVerifyIoTrace can time check one flag first.
+    const char* FName() override { return m_wrapped->FName(); }
+
+    XrdSfsXferSize pgRead(XrdSfsFileOffset offset, char* buffer, XrdSfsXferSize rdlen, uint32_t* csvec,
+                          uint64_t opts = 0) override {
+        if (!m_io_trace.Enabled()) return m_wrapped->pgRead(offset, buffer, rdlen, csvec, opts);
+        return TraceIo(OpenVerifyIoTrace::Op::PgRead, offset, rdlen,
+                       [&] { return m_wrapped->pgRead(offset, buffer, rdlen, csvec, opts); });
+    }
 
-    OpenVerifyFile(XrdSfsFile* wrapF, XrdSysError& log, OpenVerifyCache& cache, OpenVerifyMetrics& metrics,
-                   OpenVerifySingleFlight& single_flight, OpenVerifyHostReliability& host_reliability, bool observe);
+    XrdSfsXferSize pgRead(XrdSfsAio* aioparm, uint64_t opts = 0) override { return m_wrapped->pgRead(aioparm, opts); }
+
+    XrdSfsXferSize pgWrite(XrdSfsFileOffset offset, char* buffer, XrdSfsXferSize rdlen, uint32_t* csvec,
+                           uint64_t opts = 0) override {
+        return m_wrapped->pgWrite(offset, buffer, rdlen, csvec, opts);
+    }
+
+    XrdSfsXferSize pgWrite(XrdSfsAio* aioparm, uint64_t opts = 0) override {
+        return m_wrapped->pgWrite(aioparm, opts);
+    }
+
+    int read(XrdSfsFileOffset fileOffset, XrdSfsXferSize amount) override {
+        return m_wrapped->read(fileOffset, amount);
+    }
+
+    XrdSfsXferSize read(XrdSfsFileOffset fileOffset, char* buffer, XrdSfsXferSize buffer_size) override {
+        if (!m_io_trace.Enabled()) return m_wrapped->read(fileOffset, buffer, buffer_size);
+        return TraceIo(OpenVerifyIoTrace::Op::Read, fileOffset, buffer_size,
+                       [&] { return m_wrapped->read(fileOffset, buffer, buffer_size); });
+    }
+
+    int read(XrdSfsAio* aioparm) override {
+        if (!m_io_trace.Enabled()) return m_wrapped->read(aioparm);
+        return TraceIo(OpenVerifyIoTrace::Op::ReadAio, aioparm->sfsAio.aio_offset,
+                       static_cast<XrdSfsXferSize>(aioparm->sfsAio.aio_nbytes),
+                       [&] { return m_wrapped->read(aioparm); });
+    }
+
+    XrdSfsXferSize write(XrdSfsFileOffset fileOffset, const char* buffer, XrdSfsXferSize buffer_size) override {
+        if (!m_io_trace.Enabled()) return m_wrapped->write(fileOffset, buffer, buffer_size);
+        return TraceIo(OpenVerifyIoTrace::Op::Write, fileOffset, buffer_size,
+                       [&] { return m_wrapped->write(fileOffset, buffer, buffer_size); });
+    }
+
+    int write(XrdSfsAio* aioparm) override { return m_wrapped->write(aioparm); }
+
+    int sync() override {
+        if (!m_io_trace.Enabled()) return m_wrapped->sync();
+        return TraceIo(OpenVerifyIoTrace::Op::Sync, 0, 0, [&] { return m_wrapped->sync(); });
+    }
+
+    int sync(XrdSfsAio* aiop) override { return m_wrapped->sync(aiop); }
+
+    int stat(struct stat* buf) override { return m_wrapped->stat(buf); }
+
+    int SendData(XrdSfsDio* sfDio, XrdSfsFileOffset offset, XrdSfsXferSize size) override {
+        if (!m_io_trace.Enabled()) return m_wrapped->SendData(sfDio, offset, size);
+        return TraceIo(OpenVerifyIoTrace::Op::SendData, offset, size,
+                       [&] { return m_wrapped->SendData(sfDio, offset, size); });
+    }
+
+    OpenVerifyFile(XrdSfsFile* wrapF, OpenVerifyLog& log, OpenVerifyCache& cache, OpenVerifyMetrics& metrics,
+                   OpenVerifySingleFlight& single_flight, OpenVerifyHostReliability& host_reliability,
+                   OpenVerifyRetryBudget& retry_budget, OpenVerifyResumeState& resume_state,
+                   OpenVerifyRedirectCache& redirect_cache, OpenVerifyIoTrace& io_trace,
+                   OpenVerifyOpenTrace& open_trace, OpenVerifyExecutor& executor, bool observe);
     ~OpenVerifyFile();
 
     XrdSfsFile* m_wrapped;
-    XrdSysError& m_log;
+    OpenVerifyLog& m_log;
     OpenVerifyCache& m_cache;
     OpenVerifyMetrics& m_metrics;
     OpenVerifySingleFlight& m_single_flight;
     OpenVerifyHostReliability& m_host_reliability;
+    OpenVerifyRetryBudget& m_retry_budget;
+    OpenVerifyResumeState& m_resume_state;
+    OpenVerifyRedirectCache& m_redirect_cache;
+    OpenVerifyIoTrace& m_io_trace;
+    OpenVerifyOpenTrace& m_open_trace;
+    OpenVerifyExecutor& m_executor;
     const bool m_observe;
 
    private:
-    XrdCl::XRootDStatus open_verify(const std::string& key, const char* opaque, const XrdSecEntity* client,
-                                    time_t timeout_seconds);
+    // Runs one data call of `op` for OpenVerifyIoTrace: counts it with the bytes it moved and
+    // times it when sampled. read, pgRead and write return the byte count; SendData and sync
+    // return SFS_OK, and then `size` was moved. read(XrdSfsAio*) only submits the read, so its
+    // bytes are not counted; a slow one is logged with the size requested.
+    template <typename Call>
+    std::invoke_result_t<Call&> TraceIo(OpenVerifyIoTrace::Op op, XrdSfsFileOffset offset, XrdSfsXferSize size,
+                                        Call&& call) {
+        const bool timed = m_io_trace.Sample();
+        const auto start = timed ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+        const auto rc = call();
+        using Op = OpenVerifyIoTrace::Op;
+        const bool rc_is_bytes = op == Op::Read || op == Op::PgRead || op == Op::Write;
+        const int64_t bytes = rc_is_bytes ? (rc > 0 ? static_cast<int64_t>(rc) : 0) : (rc == SFS_OK ? size : 0);
+        m_io_trace.Count(op, op == Op::ReadAio ? 0 : bytes);
+        if (timed) {
+            const auto d = std::chrono::steady_clock::now() - start;
+            // Rate-limited by OpenVerifyIoTrace; `slow` counts the calls since the last line.
+            if (const uint64_t slow = m_io_trace.Observe(op, d, m_wrapped->FName(), offset, bytes)) {
+                m_log.Warn("openverify slow", OpenVerifyIoTrace::OpLabel(op), "on", m_wrapped->FName(), "offset",
+                           offset, "bytes", bytes, "us",
+                           std::chrono::duration_cast<std::chrono::microseconds>(d).count(), "slow calls", slow);
+            }
+        }
+        return rc;
+    }
+
+    using DeadlineFn = std::function<std::chrono::steady_clock::time_point()>;
+    // Gets a verify's outcome, once, on whichever thread finished the verify.
+    using VerifyDone = std::function<void(const XrdCl::XRootDStatus&)>;
+
+    // Starts verifying `key` with the client's `opaque`, plus `tried_hosts` merged into its tried=
+    // list, and returns; `on_done` gets the outcome. What the verify needs is copied out of this
+    // open, so it may outlive it: a single-flight verify runs on for its followers after the
+    // leader's open stopped waiting. The verify starts as a job on m_executor.
+    // Each XrdCl step gets `timeout_seconds`, or less so that the verify ends by `deadline()`.
+    // Between steps the verify stops with "openverify_deadline_exceeded" once that has passed.
+    // `deadline` is read again before every step: a single-flight verify runs until the last
+    // caller waiting on it gives up (OpenVerifySingleFlight::VerifyDeadline), which moves as
+    // followers attach. Each XrdCl step is added to `trace`, if given.
+    //
+    // The open itself still blocks its xrootd protocol thread while it waits for the result, as
+    // in OpenVerifySingleFlight's admission and follower waits. open() does not hand the open
+    // back with SFS_STARTED and complete it through XrdOucEICB.
+    void start_verify(const std::string& key, const OpenVerifyOpaque& opaque, const std::string& tried_hosts,
+                      const XrdSecEntity* client, time_t timeout_seconds, DeadlineFn deadline,
+                      std::shared_ptr<OpenVerifyOpenTrace::Recorder> trace, VerifyDone on_done);
+    // The XrdCl step sequence of a verify as a coroutine over asynchronous XrdCl calls
+    // (OpenVerifyXrdClAwait.hh), so that it can run on after the open that started it: each step
+    // continues on the XrdCl thread that delivered the previous response. `url` has no xrd.ztn
+    // yet: a non-empty `token` is written to a temp file for it. Holds nothing of the open.
+    static OpenVerifyTask<XrdCl::XRootDStatus> verify_flow(OpenVerifyLog& log, OpenVerifyMetrics& metrics,
+                                                           std::string key, std::string url, std::string token,
+                                                           time_t timeout_seconds, DeadlineFn deadline,
+                                                           std::shared_ptr<OpenVerifyOpenTrace::Recorder> trace);
 };
 
 #endif
\ No newline at end of file
@@ -67,6 +67,8 @@ OpenVerifyCache::Node* OpenVerifyCache::TraverseCreate(const std::vector<std::st
         auto& child = node->children[seg];
         if (!child) {
             child = std::make_unique<Node>();
+            ++m_nodes;
+            m_key_bytes += seg.size();
         }
         node = child.get();
     }
@@ -102,18 +104,32 @@ OpenVerifyCache::Status OpenVerifyCache::Get(const std::string& key, std::chrono
     return node->entry->status;
 }
 
-void OpenVerifyCache::PutPositive(const std::string& key, std::chrono::seconds ttl,
-                                  std::chrono::steady_clock::time_point now) {
+void OpenVerifyCache::CountEntry(const Entry* entry, int delta) {
+    if (!entry) return;
+    size_t& counter = entry->status == Status::Positive ? m_positive_entries : m_negative_entries;
+    if (delta > 0) {
+        ++counter;
+    } else {
+        --counter;
+    }
+}
+
+void OpenVerifyCache::PutEntry(const std::string& key, Status status, std::chrono::steady_clock::time_point expiry) {
     const std::unique_lock lk(m_mutex);
     Node* node = TraverseCreate(SplitPath(key));
-    node->entry = std::make_unique<Entry>(Entry{Status::Positive, now + ttl});
+    CountEntry(node->entry.get(), -1);
+    node->entry = std::make_unique<Entry>(Entry{status, expiry});
+    CountEntry(node->entry.get(), +1);
+}
+
+void OpenVerifyCache::PutPositive(const std::string& key, std::chrono::seconds ttl,
+                                  std::chrono::steady_clock::time_point now) {
+    PutEntry(key, Status::Positive, now + ttl);
 }
 
 void OpenVerifyCache::PutNegative(const std::string& key, std::chrono::seconds ttl,
                                   std::chrono::steady_clock::time_point now) {
-    const std::unique_lock lk(m_mutex);
-    Node* node = TraverseCreate(SplitPath(key));
-    node->entry = std::make_unique<Entry>(Entry{Status::Negative, now + ttl});
+    PutEntry(key, Status::Negative, now + ttl);
 }
 
 void OpenVerifyCache::Expire(std::chrono::steady_clock::time_point now) {
@@ -121,11 +137,14 @@ void OpenVerifyCache::Expire(std::chrono::steady_clock::time_point now) {
 
     std::function<bool(Node&)> expire_node = [&](Node& node) -> bool {
         if (node.entry && node.entry->expiry <= now) {
+            CountEntry(node.entry.get(), -1);
             node.entry.reset();
         }
 
         for (auto it = node.children.begin(); it != node.children.end();) {
             if (expire_node(*it->second)) {
+                --m_nodes;
+                m_key_bytes -= it->first.size();
                 it = node.children.erase(it);
             } else {
                 ++it;
@@ -143,6 +162,25 @@ void OpenVerifyCache::Reset() {
     const std::unique_lock lk(m_mutex);
     m_root.children.clear();
     m_root.entry.reset();
+    m_positive_entries = 0;
+    m_negative_entries = 0;
+    m_nodes = 0;
+    m_key_bytes = 0;
+}
+
+OpenVerifyCache::Stats OpenVerifyCache::GetStats() const {
+    // Rough per-node cost: the Node itself, its slot in the parent's hash map (key string,
+    // owning pointer, bucket/next pointers) and the heap block behind the unique_ptr.
+    constexpr size_t kPerNode = sizeof(Node) + sizeof(std::string) + sizeof(std::unique_ptr<Node>) + 4 * sizeof(void*);
+
+    const std::shared_lock lk(m_mutex);
+    Stats stats;
+    stats.positive_entries = m_positive_entries;
+    stats.negative_entries = m_negative_entries;
+    stats.nodes = m_nodes;
+    stats.approx_bytes =
+        sizeof(*this) + m_nodes * kPerNode + m_key_bytes + (m_positive_entries + m_negative_entries) * sizeof(Entry);
+    return stats;
 }
 
 void OpenVerifyCache::ExpireThread() {
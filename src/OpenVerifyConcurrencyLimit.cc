@@ -0,0 +1,73 @@
+#include "OpenVerifyConcurrencyLimit.hh"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Vegas thresholds, in estimated queued verifies, scaled by log10(limit) as in TCP Vegas variants
+// that run at large windows.
+constexpr double kAlpha = 3.0;
+constexpr double kBeta = 6.0;
+
+double Log10Step(size_t limit) { return std::max(1.0, std::log10(static_cast<double>(limit))); }
+
+}  // namespace
+
+OpenVerifyConcurrencyLimit::OpenVerifyConcurrencyLimit(const Options& opts)
+    : m_opts(opts), m_limit(std::clamp(opts.initial, std::max<size_t>(opts.min, 1), std::max(opts.max, opts.min))) {}
+
+bool OpenVerifyConcurrencyLimit::SetLimit(double limit) {
+    const double lo = static_cast<double>(std::max<size_t>(m_opts.min, 1));
+    const double hi = static_cast<double>(std::max(m_opts.max, m_opts.min));
+    const size_t next = static_cast<size_t>(std::clamp(limit, lo, hi));
+    if (next == m_limit) return false;
+    m_limit = next;
+    return true;
+}
+
+bool OpenVerifyConcurrencyLimit::OnSample(Clock::duration rtt, size_t inflight, Clock::time_point now) {
+    if (!m_opts.adaptive) return false;
+
+    if (m_window_count == 0) m_window_start = now;
+    ++m_window_count;
+    m_window_rtt_sum += rtt;
+    m_window_max_inflight = std::max(m_window_max_inflight, inflight);
+
+    if (m_window_count < m_opts.window_samples || now - m_window_start < m_opts.min_window) return false;
+
+    const size_t before = m_limit;
+    CloseWindow(now);
+    return m_limit != before;
+}
+
+void OpenVerifyConcurrencyLimit::CloseWindow(Clock::time_point now) {
+    const Clock::duration rtt = m_window_rtt_sum / static_cast<Clock::rep>(m_window_count);
+    const size_t max_inflight = m_window_max_inflight;
+    m_window_start = now;
+    m_window_count = 0;
+    m_window_rtt_sum = Clock::duration::zero();
+    m_window_max_inflight = 0;
+
+    if (++m_windows_since_baseline >= m_opts.rebaseline_windows) {
+        m_windows_since_baseline = 0;
+        m_rtt_noload = rtt;
+        return;
+    }
+    if (m_rtt_noload == Clock::duration::zero() || rtt < m_rtt_noload) {
+        m_rtt_noload = rtt;
+    }
+    if (rtt <= Clock::duration::zero()) return;
+
+    const double limit = static_cast<double>(m_limit);
+    const double ratio = std::chrono::duration<double>(m_rtt_noload) / std::chrono::duration<double>(rtt);
+    const double queue = std::ceil(limit * (1.0 - ratio));
+    const double step = Log10Step(m_limit);
+
+    if (queue < kAlpha * step) {
+        // Latency is flat; grow only if the current limit was the constraint.
+        if (max_inflight * 2 >= m_limit) SetLimit(limit + step);
+    } else if (queue > kBeta * step) {
+        SetLimit(limit - step);
+    }
+}
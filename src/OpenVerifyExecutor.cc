@@ -0,0 +1,139 @@
+#include "OpenVerifyExecutor.hh"
+
+#include <utility>
+
+#include "OpenVerifyEnv.hh"
+
+namespace {
+
+// Set on pool threads: the owning executor and the worker's index.
+thread_local const OpenVerifyExecutor* t_executor = nullptr;
+thread_local size_t t_worker = 0;
+
+}  // namespace
+
+OpenVerifyExecutor::OpenVerifyExecutor(OpenVerifyMetrics& metrics)
+    : OpenVerifyExecutor(metrics,
+                         static_cast<size_t>(ReadNonNegativeIntEnvOrDefault("XRD_OPENVERIFY_EXECUTOR_THREADS", 32))) {}
+
+OpenVerifyExecutor::OpenVerifyExecutor(OpenVerifyMetrics& metrics, size_t threads) : m_metrics(metrics) {
+    m_workers.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) m_workers.push_back(std::make_unique<Worker>());
+    // Start only once every deque exists: a worker may steal from any of them.
+    for (size_t i = 0; i < threads; ++i) {
+        m_workers[i]->thread = std::thread([this, i] { WorkerLoop(i); });
+    }
+    m_collector_id = m_metrics.AddCollector(
+        [this](std::ostream& out, const std::string& lbl) { WriteExposition(out, lbl); });
+}
+
+OpenVerifyExecutor::~OpenVerifyExecutor() {
+    m_metrics.RemoveCollector(m_collector_id);
+    {
+        std::lock_guard<std::mutex> lk(m_idle_mtx);
+        m_stop = true;
+    }
+    m_idle_cv.notify_all();
+    for (auto& w : m_workers) {
+        if (w->thread.joinable()) w->thread.join();
+    }
+}
+
+bool OpenVerifyExecutor::OnWorkerThread() const { return t_executor == this; }
+
+std::shared_ptr<OpenVerifyExecutor::Completion> OpenVerifyExecutor::Submit(std::function<void()> job) {
+    Job j{std::move(job), std::make_shared<Completion>()};
+    std::shared_ptr<Completion> done = j.done;
+    if (m_workers.empty()) {
+        RunJob(j);
+        return done;
+    }
+
+    const size_t target =
+        OnWorkerThread() ? t_worker : m_next.fetch_add(1, std::memory_order_relaxed) % m_workers.size();
+    // Counted before it is visible, so a thief can never take it below zero.
+    m_queued.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lk(m_workers[target]->mtx);
+        m_workers[target]->jobs.push_back(std::move(j));
+    }
+    {
+        // Pairs with the predicate check in WorkerLoop, so the wakeup cannot be lost.
+        std::lock_guard<std::mutex> lk(m_idle_mtx);
+    }
+    m_idle_cv.notify_one();
+    return done;
+}
+
+bool OpenVerifyExecutor::TryPop(size_t self, Job& job) {
+    Worker& w = *m_workers[self];
+    std::lock_guard<std::mutex> lk(w.mtx);
+    if (w.jobs.empty()) return false;
+    job = std::move(w.jobs.back());
+    w.jobs.pop_back();
+    m_queued.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool OpenVerifyExecutor::TrySteal(size_t self, Job& job) {
+    const size_t n = m_workers.size();
+    for (size_t k = 1; k < n; ++k) {
+        Worker& victim = *m_workers[(self + k) % n];
+        std::lock_guard<std::mutex> lk(victim.mtx);
+        if (victim.jobs.empty()) continue;
+        job = std::move(victim.jobs.front());
+        victim.jobs.pop_front();
+        m_queued.fetch_sub(1, std::memory_order_relaxed);
+        m_steals.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+void OpenVerifyExecutor::RunJob(Job& job) {
+    m_busy.fetch_add(1, std::memory_order_relaxed);
+    try {
+        if (job.fn) job.fn();
+    } catch (...) {
+    }
+    m_busy.fetch_sub(1, std::memory_order_relaxed);
+    m_executed.fetch_add(1, std::memory_order_relaxed);
+    job.done->Finish();
+}
+
+void OpenVerifyExecutor::WorkerLoop(size_t self) {
+    t_executor = this;
+    t_worker = self;
+    for (;;) {
+        Job job;
+        if (TryPop(self, job) || TrySteal(self, job)) {
+            RunJob(job);
+            continue;
+        }
+        std::unique_lock<std::mutex> lk(m_idle_mtx);
+        m_idle_cv.wait(lk, [this] { return m_stop || m_queued.load(std::memory_order_relaxed) > 0; });
+        if (m_stop && m_queued.load(std::memory_order_relaxed) == 0) return;
+    }
+}
+
+void OpenVerifyExecutor::WriteExposition(std::ostream& out, const std::string& lbl) {
+    const std::string labels = lbl.empty() ? std::string() : lbl.substr(1);
+    const std::string only_lbl = lbl.empty() ? std::string() : "{" + labels + "}";
+    OpenVerifyMetrics::WriteGauge(out, "xrootd_openverify_executor_threads", "Verify executor pool size.", labels,
+                                  static_cast<double>(m_workers.size()));
+    OpenVerifyMetrics::WriteGauge(out, "xrootd_openverify_executor_busy_threads",
+                                  "Verify executor workers running a job.", labels,
+                                  static_cast<double>(m_busy.load(std::memory_order_relaxed)));
+    OpenVerifyMetrics::WriteGauge(out, "xrootd_openverify_executor_queued_jobs",
+                                  "Jobs queued on the verify executor, all workers.", labels,
+                                  static_cast<double>(m_queued.load(std::memory_order_relaxed)));
+    out << "# HELP xrootd_openverify_executor_jobs_total Jobs run by the verify executor.\n"
+           "# TYPE xrootd_openverify_executor_jobs_total counter\n"
+           "xrootd_openverify_executor_jobs_total"
+        << only_lbl << " " << m_executed.load(std::memory_order_relaxed)
+        << "\n"
+           "# HELP xrootd_openverify_executor_steals_total Jobs a verify executor worker took from another's deque.\n"
+           "# TYPE xrootd_openverify_executor_steals_total counter\n"
+           "xrootd_openverify_executor_steals_total"
+        << only_lbl << " " << m_steals.load(std::memory_order_relaxed) << "\n";
+}
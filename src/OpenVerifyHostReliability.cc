@@ -1,6 +1,9 @@
 #include <algorithm>
+#include <cmath>
 #include <random>
+#include <vector>
 
+#include "OpenVerifyEnv.hh"
 #include "OpenVerifyHostReliability.hh"
 
 namespace {
@@ -34,73 +37,342 @@ std::chrono::seconds JitteredCooldown(std::chrono::seconds base) {
     return std::chrono::seconds(base_s + dist(rng));
 }
 
+const char* BreakerStateLabel(OpenVerifyHostReliability::BreakerState state) {
+    switch (state) {
+        case OpenVerifyHostReliability::BreakerState::Open:
+            return "open";
+        case OpenVerifyHostReliability::BreakerState::HalfOpen:
+            return "half_open";
+        case OpenVerifyHostReliability::BreakerState::Closed:
+            break;
+    }
+    return "closed";
+}
+
 }  // namespace
 
-OpenVerifyHostReliability::OpenVerifyHostReliability()
+OpenVerifyHostReliability::OpenVerifyHostReliability(OpenVerifyMetrics& metrics)
     : m_ewma_alpha_fail(0.05),
       m_ewma_alpha_success(0.10),
       m_min_attempts(20),
       m_quarantine_threshold(0.6),
       m_recover_threshold(0.4),
-      m_probe_cooldown(std::chrono::seconds(60)) {}
+      m_probe_cooldown(std::chrono::seconds(60)),
+      m_half_open_trials(3),
+      m_half_open_success_ratio(2.0 / 3.0),
+      m_export_limit(static_cast<size_t>(ReadIntEnvOrDefault("XRD_OPENVERIFY_HOST_METRICS_MAX", 50))),
+      m_metrics(metrics) {
+    m_collector_id = m_metrics.AddCollector(
+        [this](std::ostream& out, const std::string& lbl) { WriteExposition(out, lbl); });
+}
+
+OpenVerifyHostReliability::~OpenVerifyHostReliability() { m_metrics.RemoveCollector(m_collector_id); }
 
 std::string OpenVerifyHostReliability::HostPortKey(const std::string& host, int port) {
     return host + ":" + std::to_string(port);
 }
 
-void OpenVerifyHostReliability::UpdateHealthState(HostStats& stats) {
-    const uint64_t attempts = stats.successes + stats.failures;
-    if (attempts < m_min_attempts) return;
+OpenVerifyHostReliability::HostStats& OpenVerifyHostReliability::StatsFor(const std::string& host, int port) {
+    auto [it, inserted] = m_hoststat_map.try_emplace(HostPortKey(host, port));
+    if (inserted) {
+        it->second.host = host;
+        it->second.port = port;
+    }
+    return it->second;
+}
+
+void OpenVerifyHostReliability::EmitBreakerEvents(const BreakerEvents& events) {
+    // Called without m_mtx held: metric updates may render the exposition body,
+    // which calls back into WriteExposition.
+    for (uint32_t i = 0; i < events.half_opened; ++i) m_metrics.RecordHostBreakerHalfOpened();
+    for (uint32_t i = 0; i < events.opened; ++i) m_metrics.RecordHostBreakerOpened();
+    if (events.closed) m_metrics.RecordHostBreakerClosed(events.recovery);
+}
+
+int64_t OpenVerifyHostReliability::SecondOf(std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::seconds>(t.time_since_epoch()).count();
+}
+
+void OpenVerifyHostReliability::RecordOutcome(HostStats& stats, bool success,
+                                              std::chrono::steady_clock::time_point now) {
+    const int64_t sec = SecondOf(now);
+    WindowBucket& bucket = stats.window[static_cast<size_t>(sec) % kWindowBuckets];
+    if (bucket.second != sec) {
+        // Bucket still holds a second that fell out of the window; recycle it.
+        bucket = WindowBucket{sec, 0, 0};
+    }
+    if (success) {
+        bucket.successes += 1;
+    } else {
+        bucket.failures += 1;
+    }
+}
+
+uint64_t OpenVerifyHostReliability::WindowAttempts(const HostStats& stats,
+                                                   std::chrono::steady_clock::time_point now) const {
+    const int64_t sec = SecondOf(now);
+    const int64_t oldest = sec - static_cast<int64_t>(kWindowBuckets);
+    uint64_t attempts = 0;
+    for (const WindowBucket& bucket : stats.window) {
+        if (bucket.second > oldest && bucket.second <= sec) {
+            attempts += bucket.successes + bucket.failures;
+        }
+    }
+    return attempts;
+}
+
+double OpenVerifyHostReliability::HealthAt(const HostStats& stats, std::chrono::steady_clock::time_point now) {
+    if (stats.ewma_updated_at == std::chrono::steady_clock::time_point{} || now <= stats.ewma_updated_at) {
+        return stats.ewma_health;
+    }
+    const double idle_s = std::chrono::duration<double>(now - stats.ewma_updated_at).count();
+    return stats.ewma_health * std::exp2(-idle_s / static_cast<double>(kWindowBuckets));
+}
+
+void OpenVerifyHostReliability::DecayEwma(HostStats& stats, std::chrono::steady_clock::time_point now) const {
+    // Halve the score once per window of inactivity so a burst of failures weeks ago
+    // does not keep weighing on the host once it has gone quiet.
+    stats.ewma_health = HealthAt(stats, now);
+    stats.ewma_updated_at = now;
+}
+
+void OpenVerifyHostReliability::OpenBreaker(HostStats& stats, std::chrono::steady_clock::time_point now,
+                                            BreakerEvents& events) {
+    if (stats.state == BreakerState::Closed) {
+        stats.opened_at = now;
+    }
+    stats.state = BreakerState::Open;
+    // Set the first probe deadline immediately on quarantine so there is a
+    // full cooldown window before any probe is allowed.
+    stats.next_probe_at = now + JitteredCooldown(m_probe_cooldown);
+    stats.trials_admitted = 0;
+    stats.trial_successes = 0;
+    stats.trial_failures = 0;
+    events.opened += 1;
+}
+
+void OpenVerifyHostReliability::UpdateHealthState(HostStats& stats, std::chrono::steady_clock::time_point now,
+                                                  BreakerEvents& events) {
+    if (WindowAttempts(stats, now) < m_min_attempts) return;
 
     const double q = std::clamp(m_quarantine_threshold, 0.0, 1.0);
-    const double r = std::clamp(m_recover_threshold, 0.0, q);
-    if (stats.healthy && stats.ewma_health >= q) {
-        stats.healthy = false;
-        // Set the first probe deadline immediately on quarantine so there is a
-        // full cooldown window before any probe is allowed.
-        stats.next_probe_at = std::chrono::steady_clock::now() + JitteredCooldown(m_probe_cooldown);
-    } else if (!stats.healthy && stats.ewma_health <= r) {
-        stats.healthy = true;
+    if (stats.ewma_health >= q) {
+        OpenBreaker(stats, now, events);
+    }
+}
+
+void OpenVerifyHostReliability::UpdateHalfOpenState(HostStats& stats, std::chrono::steady_clock::time_point now,
+                                                    BreakerEvents& events) {
+    const uint32_t needed = static_cast<uint32_t>(
+        std::ceil(std::clamp(m_half_open_success_ratio, 0.0, 1.0) * static_cast<double>(m_half_open_trials)));
+    if (stats.trial_successes >= needed) {
+        stats.state = BreakerState::Closed;
         stats.next_probe_at = {};
+        // Start the closed period inside the dead band so the old score cannot
+        // immediately re-open the breaker.
+        const double q = std::clamp(m_quarantine_threshold, 0.0, 1.0);
+        stats.ewma_health = std::min(stats.ewma_health, std::clamp(m_recover_threshold, 0.0, q));
+        events.closed = true;
+        events.recovery = now - stats.opened_at;
+    } else if (stats.trial_failures > m_half_open_trials - needed) {
+        // Success ratio is no longer reachable in this round.
+        OpenBreaker(stats, now, events);
     }
 }
 
-bool OpenVerifyHostReliability::AvoidSite(const std::string& host, int port) {
-    const auto now = std::chrono::steady_clock::now();
+bool OpenVerifyHostReliability::AvoidSite(const std::string& host, int port,
+                                          std::chrono::steady_clock::time_point now) {
+    BreakerEvents events;
+    const bool avoid = AvoidSiteLocked(host, port, now, events);
+    EmitBreakerEvents(events);
+    return avoid;
+}
+
+bool OpenVerifyHostReliability::AvoidSiteLocked(const std::string& host, int port,
+                                                std::chrono::steady_clock::time_point now, BreakerEvents& events) {
     std::lock_guard<std::mutex> lock(m_mtx);
     auto it = m_hoststat_map.find(HostPortKey(host, port));
     if (it == m_hoststat_map.end()) return false;
     HostStats& stats = it->second;
-    if (stats.healthy) return false;
 
-    if (now >= stats.next_probe_at) {
-        // Claim the probe slot by advancing the deadline before returning.
-        // Concurrent threads arriving after this point will see a future deadline
-        // and continue avoiding the site, so only one probe fires per window.
+    switch (stats.state) {
+        case BreakerState::Closed:
+            return false;
+        case BreakerState::Open:
+            if (now < stats.next_probe_at) return true;
+            stats.state = BreakerState::HalfOpen;
+            stats.next_probe_at = now + JitteredCooldown(m_probe_cooldown);
+            stats.trials_admitted = 0;
+            stats.trial_successes = 0;
+            stats.trial_failures = 0;
+            events.half_opened += 1;
+            break;
+        case BreakerState::HalfOpen:
+            break;
+    }
+
+    // Every outcome while half-open counts toward the round, including verifies that started
+    // before the transition or were never admitted here, so there can be more than admitted.
+    const uint32_t resolved = stats.trial_successes + stats.trial_failures;
+    const uint32_t outstanding = stats.trials_admitted > resolved ? stats.trials_admitted - resolved : 0;
+    if (outstanding >= m_half_open_trials) {
+        if (now < stats.next_probe_at) return true;
+        // Trials that never reported back (e.g. answered from the positive cache)
+        // give their slots up once the trial deadline passes.
+        stats.trials_admitted = resolved;
         stats.next_probe_at = now + JitteredCooldown(m_probe_cooldown);
-        return false;
     }
-    return true;
+    stats.trials_admitted += 1;
+    return false;
 }
 
-void OpenVerifyHostReliability::RecordVerifySuccess(const std::string& host, int port) {
-    std::lock_guard<std::mutex> lock(m_mtx);
-    HostStats& stats = m_hoststat_map[HostPortKey(host, port)];
-    stats.successes += 1;
-    stats.ewma_health = (1.0 - m_ewma_alpha_success) * stats.ewma_health;
-    UpdateHealthState(stats);
+void OpenVerifyHostReliability::RecordVerifySuccess(const std::string& host, int port,
+                                                    std::chrono::steady_clock::time_point now) {
+    BreakerEvents events;
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        HostStats& stats = StatsFor(host, port);
+        RecordOutcome(stats, true, now);
+        DecayEwma(stats, now);
+        stats.ewma_health = (1.0 - m_ewma_alpha_success) * stats.ewma_health;
+        switch (stats.state) {
+            case BreakerState::Closed:
+                UpdateHealthState(stats, now, events);
+                break;
+            case BreakerState::HalfOpen:
+                stats.trial_successes += 1;
+                stats.probe_successes += 1;
+                UpdateHalfOpenState(stats, now, events);
+                break;
+            case BreakerState::Open:
+                break;
+        }
+    }
+    EmitBreakerEvents(events);
 }
 
-void OpenVerifyHostReliability::RecordVerifyFailure(const std::string& host, int port, uint16_t xrdcl_code) {
+void OpenVerifyHostReliability::RecordVerifyFailure(const std::string& host, int port, uint16_t xrdcl_code,
+                                                    std::chrono::steady_clock::time_point now) {
+    BreakerEvents events;
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        HostStats& stats = StatsFor(host, port);
+        RecordOutcome(stats, false, now);
+        DecayEwma(stats, now);
+        const double penalty = std::clamp(FailureWeightForCode(xrdcl_code), 0.0, 1.0);
+        stats.ewma_health = m_ewma_alpha_fail * penalty + (1.0 - m_ewma_alpha_fail) * stats.ewma_health;
+        switch (stats.state) {
+            case BreakerState::Closed:
+                UpdateHealthState(stats, now, events);
+                break;
+            case BreakerState::HalfOpen:
+                stats.trial_failures += 1;
+                stats.probe_failures += 1;
+                UpdateHalfOpenState(stats, now, events);
+                break;
+            case BreakerState::Open:
+                // Late failure while open: push the deadline out again from now so the cooldown
+                // restarts from the most recent failure.
+                stats.next_probe_at = now + JitteredCooldown(m_probe_cooldown);
+                break;
+        }
+    }
+    EmitBreakerEvents(events);
+}
+
+OpenVerifyHostReliability::BreakerState OpenVerifyHostReliability::State(const std::string& host, int port) {
     std::lock_guard<std::mutex> lock(m_mtx);
-    HostStats& stats = m_hoststat_map[HostPortKey(host, port)];
-    stats.failures += 1;
-    const double penalty = std::clamp(FailureWeightForCode(xrdcl_code), 0.0, 1.0);
-    stats.ewma_health = m_ewma_alpha_fail * penalty + (1.0 - m_ewma_alpha_fail) * stats.ewma_health;
-    if (!stats.healthy) {
-        // Failed probe: push the deadline out again from now so the cooldown
-        // restarts from the most recent failure, not from when the slot was claimed.
-        stats.next_probe_at = std::chrono::steady_clock::now() + JitteredCooldown(m_probe_cooldown);
-    }
-    UpdateHealthState(stats);
+    auto it = m_hoststat_map.find(HostPortKey(host, port));
+    return it == m_hoststat_map.end() ? BreakerState::Closed : it->second.state;
+}
+
+void OpenVerifyHostReliability::WriteExposition(std::ostream& out, const std::string& lbl) {
+    struct Sample {
+        std::string host;
+        int port;
+        BreakerState state;
+        double health;
+        double quarantined_s;
+        double next_probe_s;
+        uint64_t probe_successes;
+        uint64_t probe_failures;
+    };
+
+    const auto now = std::chrono::steady_clock::now();
+    std::vector<Sample> samples;
+    uint64_t by_state[3] = {0, 0, 0};
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        samples.reserve(m_hoststat_map.size());
+        for (const auto& kv : m_hoststat_map) {
+            const HostStats& stats = kv.second;
+            by_state[static_cast<int>(stats.state)] += 1;
+            const bool closed = stats.state == BreakerState::Closed;
+            samples.push_back(Sample{
+                stats.host, stats.port, stats.state, HealthAt(stats, now),
+                closed ? 0.0 : std::chrono::duration<double>(now - stats.opened_at).count(),
+                closed || now >= stats.next_probe_at ? 0.0
+                                                     : std::chrono::duration<double>(stats.next_probe_at - now).count(),
+                stats.probe_successes, stats.probe_failures});
+        }
+    }
+
+    // Keep cardinality bounded: quarantined hosts first, then the least healthy ones.
+    const auto worse = [](const Sample& a, const Sample& b) {
+        const bool a_closed = a.state == BreakerState::Closed;
+        const bool b_closed = b.state == BreakerState::Closed;
+        if (a_closed != b_closed) return !a_closed;
+        return a.health > b.health;
+    };
+    if (samples.size() > m_export_limit) {
+        std::partial_sort(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(m_export_limit),
+                          samples.end(), worse);
+        samples.resize(m_export_limit);
+    }
+
+    out << "# HELP xrootd_openverify_hosts Hosts tracked by OpenVerify host reliability, by breaker state.\n"
+           "# TYPE xrootd_openverify_hosts gauge\n";
+    for (BreakerState state : {BreakerState::Closed, BreakerState::Open, BreakerState::HalfOpen}) {
+        out << "xrootd_openverify_hosts{state=\"" << BreakerStateLabel(state) << "\"" << lbl << "} "
+            << by_state[static_cast<int>(state)] << "\n";
+    }
+
+    std::vector<std::string> target_lbls;
+    target_lbls.reserve(samples.size());
+    for (const Sample& s : samples) {
+        target_lbls.push_back("host=\"" + OpenVerifyMetrics::EscapeLabelValue(s.host) + "\",port=\"" +
+                              OpenVerifyMetrics::PortLabel(s.port) + "\"" + lbl);
+    }
+
+    out << "# HELP xrootd_openverify_host_health_score Decayed EWMA failure score per host (0 healthy, 1 failing).\n"
+           "# TYPE xrootd_openverify_host_health_score gauge\n";
+    for (size_t i = 0; i < samples.size(); ++i) {
+        out << "xrootd_openverify_host_health_score{" << target_lbls[i] << "} " << samples[i].health << "\n";
+    }
+    out << "# HELP xrootd_openverify_host_breaker_state Host breaker state (0 closed, 1 open, 2 half_open).\n"
+           "# TYPE xrootd_openverify_host_breaker_state gauge\n";
+    for (size_t i = 0; i < samples.size(); ++i) {
+        out << "xrootd_openverify_host_breaker_state{" << target_lbls[i] << "} "
+            << static_cast<int>(samples[i].state) << "\n";
+    }
+    out << "# HELP xrootd_openverify_host_quarantined_seconds Time since the host breaker opened; 0 when closed.\n"
+           "# TYPE xrootd_openverify_host_quarantined_seconds gauge\n";
+    for (size_t i = 0; i < samples.size(); ++i) {
+        out << "xrootd_openverify_host_quarantined_seconds{" << target_lbls[i] << "} " << samples[i].quarantined_s
+            << "\n";
+    }
+    out << "# HELP xrootd_openverify_host_next_probe_seconds Time until the next probe or trial slot is due.\n"
+           "# TYPE xrootd_openverify_host_next_probe_seconds gauge\n";
+    for (size_t i = 0; i < samples.size(); ++i) {
+        out << "xrootd_openverify_host_next_probe_seconds{" << target_lbls[i] << "} " << samples[i].next_probe_s
+            << "\n";
+    }
+    out << "# HELP xrootd_openverify_host_probes_total Half-open trial outcomes per host.\n"
+           "# TYPE xrootd_openverify_host_probes_total counter\n";
+    for (size_t i = 0; i < samples.size(); ++i) {
+        out << "xrootd_openverify_host_probes_total{" << target_lbls[i] << ",result=\"success\"} "
+            << samples[i].probe_successes << "\n"
+            << "xrootd_openverify_host_probes_total{" << target_lbls[i] << ",result=\"failure\"} "
+            << samples[i].probe_failures << "\n";
+    }
 }
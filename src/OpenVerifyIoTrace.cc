@@ -0,0 +1,105 @@
+#include "OpenVerifyIoTrace.hh"
+
+#include <utility>
+
+#include "OpenVerifyEnv.hh"
+
+namespace {
+
+constexpr OpenVerifyIoTrace::Op kAllOps[] = {OpenVerifyIoTrace::Op::Read,  OpenVerifyIoTrace::Op::PgRead,
+                                             OpenVerifyIoTrace::Op::Write, OpenVerifyIoTrace::Op::Sync,
+                                             OpenVerifyIoTrace::Op::SendData, OpenVerifyIoTrace::Op::ReadAio};
+
+}  // namespace
+
+OpenVerifyIoTrace::OpenVerifyIoTrace(OpenVerifyMetrics& metrics)
+    : OpenVerifyIoTrace(metrics, static_cast<uint32_t>(ReadIntEnvOrDefault("XRD_OPENVERIFY_IO_SAMPLE", 0)),
+                        std::chrono::milliseconds(ReadIntEnvOrDefault("XRD_OPENVERIFY_IO_SLOW_MS", 100)),
+                        static_cast<size_t>(ReadIntEnvOrDefault("XRD_OPENVERIFY_IO_SLOW_RING", 64))) {}
+
+OpenVerifyIoTrace::OpenVerifyIoTrace(OpenVerifyMetrics& metrics, uint32_t sample_every,
+                                     std::chrono::milliseconds slow_threshold, size_t slow_capacity)
+    : m_sample_every(sample_every),
+      m_slow_threshold(slow_threshold),
+      m_slow_capacity(slow_capacity),
+      m_metrics(metrics) {
+    m_collector_id = m_metrics.AddCollector(
+        [this](std::ostream& out, const std::string& lbl) { WriteExposition(out, lbl); });
+}
+
+OpenVerifyIoTrace::~OpenVerifyIoTrace() { m_metrics.RemoveCollector(m_collector_id); }
+
+const char* OpenVerifyIoTrace::OpLabel(Op op) {
+    switch (op) {
+        case Op::Read:
+            return "read";
+        case Op::PgRead:
+            return "pgread";
+        case Op::Write:
+            return "write";
+        case Op::Sync:
+            return "sync";
+        case Op::SendData:
+            return "senddata";
+        case Op::ReadAio:
+            return "read_aio";
+    }
+    return "unknown";
+}
+
+uint64_t OpenVerifyIoTrace::RecordSlow(Op op, std::chrono::steady_clock::duration d, const char* path,
+                                       int64_t offset, int64_t bytes) {
+    const auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(m_slow_mtx);
+    if (m_slow_capacity > 0) {
+        if (m_slow.size() == m_slow_capacity) m_slow.pop_front();
+        m_slow.push_back(SlowOp{op, path ? path : "", offset, bytes, d, m_slow_total});
+    }
+    ++m_slow_total;
+    ++m_slow_unlogged;
+    if (now < m_next_slow_log) return 0;
+    m_next_slow_log = now + kSlowLogInterval;
+    return std::exchange(m_slow_unlogged, 0);
+}
+
+std::vector<OpenVerifyIoTrace::SlowOp> OpenVerifyIoTrace::SlowOps() const {
+    std::lock_guard<std::mutex> lock(m_slow_mtx);
+    return std::vector<SlowOp>(m_slow.rbegin(), m_slow.rend());
+}
+
+void OpenVerifyIoTrace::WriteExposition(std::ostream& out, const std::string& lbl) {
+    if (!Enabled()) return;
+    const std::string only_lbl = lbl.empty() ? std::string() : ("{" + lbl.substr(1) + "}");
+
+    out << "# HELP xrootd_openverify_io_calls_total File data calls through the wrapper, by operation.\n"
+           "# TYPE xrootd_openverify_io_calls_total counter\n";
+    for (Op op : kAllOps) {
+        out << "xrootd_openverify_io_calls_total{op=\"" << OpLabel(op) << "\"" << lbl << "} "
+            << m_calls[static_cast<size_t>(op)].Load() << "\n";
+    }
+    out << "# HELP xrootd_openverify_io_bytes_total Bytes moved by file data calls, by operation.\n"
+           "# TYPE xrootd_openverify_io_bytes_total counter\n";
+    for (Op op : kAllOps) {
+        out << "xrootd_openverify_io_bytes_total{op=\"" << OpLabel(op) << "\"" << lbl << "} "
+            << m_bytes[static_cast<size_t>(op)].Load() << "\n";
+    }
+    OpenVerifyLatencyHistogram::WriteHeader(out, "xrootd_openverify_io_duration_seconds",
+                                            "Duration of sampled file data calls (XRD_OPENVERIFY_IO_SAMPLE).");
+    for (Op op : kAllOps) {
+        m_duration[static_cast<size_t>(op)].WriteTo(out, "xrootd_openverify_io_duration_seconds",
+                                                    std::string("op=\"") + OpLabel(op) + "\"" + lbl);
+    }
+
+    std::lock_guard<std::mutex> lock(m_slow_mtx);
+    out << "# HELP xrootd_openverify_io_slow_total Sampled file data calls over XRD_OPENVERIFY_IO_SLOW_MS.\n"
+           "# TYPE xrootd_openverify_io_slow_total counter\n"
+           "xrootd_openverify_io_slow_total"
+        << only_lbl << " " << m_slow_total << "\n"
+        << "# HELP xrootd_openverify_io_slow_op_seconds Duration of the most recent slow file data calls.\n"
+           "# TYPE xrootd_openverify_io_slow_op_seconds gauge\n";
+    size_t slot = 0;
+    for (auto it = m_slow.rbegin(); it != m_slow.rend(); ++it, ++slot) {
+        out << "xrootd_openverify_io_slow_op_seconds{op=\"" << OpLabel(it->op) << "\",slot=\"" << slot << "\"" << lbl
+            << "} " << std::chrono::duration<double>(it->duration).count() << "\n";
+    }
+}
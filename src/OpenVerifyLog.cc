@@ -0,0 +1,103 @@
+#include "OpenVerifyLog.hh"
+
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <utility>
+
+#include "OpenVerifyEnv.hh"
+
+namespace {
+
+OpenVerifyLog::Level LevelFromEnv() {
+    const char* p = std::getenv("XRD_OPENVERIFY_LOG_LEVEL");
+    const std::string v = p ? p : "";
+    if (v == "debug") return OpenVerifyLog::Level::Debug;
+    if (v == "warn") return OpenVerifyLog::Level::Warn;
+    if (v == "error") return OpenVerifyLog::Level::Error;
+    return OpenVerifyLog::Level::Info;
+}
+
+}  // namespace
+
+OpenVerifyLog::OpenVerifyLog(Sink sink)
+    : OpenVerifyLog(std::move(sink), LevelFromEnv(),
+                    static_cast<size_t>(ReadIntEnvOrDefault("XRD_OPENVERIFY_LOG_QUEUE", 8192))) {}
+
+OpenVerifyLog::OpenVerifyLog(Sink sink, Level level, size_t capacity)
+    : m_sink(std::move(sink)),
+      m_level(static_cast<int>(level)),
+      m_ring(capacity) {
+    m_thread = std::thread([this] { DrainLoop(); });
+}
+
+OpenVerifyLog::~OpenVerifyLog() {
+    {
+        std::lock_guard<std::mutex> lk(m_wake_mtx);
+        m_stop = true;
+    }
+    m_wake_cv.notify_one();
+    m_thread.join();
+}
+
+const char* OpenVerifyLog::LevelName(Level level) {
+    switch (level) {
+        case Level::Debug:
+            return " DEBUG";
+        case Level::Info:
+            return " INFO";
+        case Level::Warn:
+            return " WARN";
+        case Level::Error:
+            return " ERROR";
+    }
+    return " INFO";
+}
+
+void OpenVerifyLog::AppendText(Slot& slot, const char* p, size_t n) {
+    if (slot.len > 0 && slot.len < kLineMax) slot.text[slot.len++] = ' ';
+    const size_t room = kLineMax - slot.len;
+    if (n <= room) {
+        std::memcpy(slot.text + slot.len, p, n);
+        slot.len += n;
+        return;
+    }
+    std::memcpy(slot.text + slot.len, p, room);
+    slot.len = kLineMax;
+    std::memcpy(slot.text + kLineMax - 3, "...", 3);
+}
+
+size_t OpenVerifyLog::DrainOnce() {
+    size_t drained = 0;
+    while (const Slot* slot = m_ring.Front()) {
+        m_sink(slot->level, slot->text);
+        m_ring.Pop();
+        ++drained;
+    }
+    const uint64_t dropped = m_dropped.load(std::memory_order_relaxed);
+    if (dropped != m_dropped_reported) {
+        const std::string line =
+            "openverify log queue full, dropped " + std::to_string(dropped - m_dropped_reported) + " messages";
+        m_sink(Level::Warn, line.c_str());
+        m_dropped_reported = dropped;
+    }
+    return drained;
+}
+
+void OpenVerifyLog::DrainLoop() {
+    for (;;) {
+        if (DrainOnce() > 0) continue;
+        std::unique_lock<std::mutex> lk(m_wake_mtx);
+        if (m_stop) break;
+        m_wake_cv.wait_for(lk, std::chrono::milliseconds(10));
+    }
+    DrainOnce();
+}
+
+void OpenVerifyLog::Flush() {
+    const size_t target = m_ring.Claimed();
+    m_wake_cv.notify_one();
+    while (m_ring.Consumed() < target) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
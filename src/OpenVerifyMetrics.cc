@@ -1,24 +1,65 @@
 #include "OpenVerifyMetrics.hh"
 
 #include <cstdlib>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <sstream>
 #include <string>
 #include <utility>
 
+#include "OpenVerifyEnv.hh"
+
 namespace {
 
 const char* kEnvPath = "XRD_OPENVERIFY_METRICS_PATH";
 const char* kEnvInstance = "XRD_OPENVERIFY_METRICS_INSTANCE";
+const char* kEnvFlushMs = "XRD_OPENVERIFY_METRICS_FLUSH_MS";
+const char* kEnvHttpPort = "XRD_OPENVERIFY_METRICS_HTTP_PORT";
+const char* kEnvHttpAddr = "XRD_OPENVERIFY_METRICS_HTTP_ADDR";
+
+const char* kEnvHostMetricsMax = "XRD_OPENVERIFY_HOST_METRICS_MAX";
+const char* kEnvFailureHostsMax = "XRD_OPENVERIFY_FAILURE_HOSTS_MAX";
+const char* kEnvClassMetricsMax = "XRD_OPENVERIFY_CLASS_METRICS_MAX";
+
+// Rewrite the file at least this often even when no counter moved (gauges, file mtime).
+constexpr std::chrono::seconds kMaxFileStaleness{60};
+
+const char* XrdClStepLabel(OpenVerifyMetrics::XrdClStep step) {
+    switch (step) {
+        case OpenVerifyMetrics::XrdClStep::Open:
+            return "open";
+        case OpenVerifyMetrics::XrdClStep::Stat:
+            return "stat";
+        case OpenVerifyMetrics::XrdClStep::VectorRead:
+            return "vector_read";
+        case OpenVerifyMetrics::XrdClStep::Close:
+            return "close";
+    }
+    return "unknown";
+}
 
-std::string PortLabelForMetrics(int port) { return port >= 0 ? std::to_string(port) : "none"; }
+const char* DegradeActionLabel(OpenVerifyMetrics::DegradeAction action) {
+    switch (action) {
+        case OpenVerifyMetrics::DegradeAction::Open:
+            return "fail_open";
+        case OpenVerifyMetrics::DegradeAction::Stall:
+            return "stall";
+        case OpenVerifyMetrics::DegradeAction::Fail:
+            return "fail_fast";
+    }
+    return "unknown";
+}
 
-std::string FailureMapKey(const std::string& host, int port, const std::string& reason) {
-    return host + '\x1e' + PortLabelForMetrics(port) + '\x1e' + reason;
+std::string FailureTargetKey(const std::string& host, int port) {
+    return host + '\x1e' + OpenVerifyMetrics::PortLabel(port);
 }
 
-std::string EscapeLabelValue(const std::string& in) {
+}  // namespace
+
+std::string OpenVerifyMetrics::PortLabel(int port) { return port >= 0 ? std::to_string(port) : "none"; }
+
+std::string OpenVerifyMetrics::EscapeLabelValue(const std::string& in) {
     std::string out;
     out.reserve(in.size() + 8);
     for (char c : in) {
@@ -35,9 +76,12 @@ std::string EscapeLabelValue(const std::string& in) {
     return out;
 }
 
-}  // namespace
-
-OpenVerifyMetrics::OpenVerifyMetrics() {
+OpenVerifyMetrics::OpenVerifyMetrics()
+    : m_flush_interval(std::chrono::milliseconds(ReadIntEnvOrDefault(kEnvFlushMs, 5000))),
+      m_host_latency_limit(static_cast<size_t>(ReadIntEnvOrDefault(kEnvHostMetricsMax, 50))),
+      m_class_latency_limit(static_cast<size_t>(ReadIntEnvOrDefault(kEnvClassMetricsMax, 20))),
+      m_failure_targets(static_cast<size_t>(
+          ReadIntEnvOrDefault(kEnvFailureHostsMax, static_cast<int>(m_host_latency_limit)))) {
     if (const char* p = std::getenv(kEnvPath)) {
         m_path.assign(p);  // empty string -> no file export (explicit disable)
     } else {
@@ -64,72 +108,293 @@ OpenVerifyMetrics::OpenVerifyMetrics() {
         }
     }
 
-    // Sync disk to in-memory zeros after restart; otherwise a stale file persists until the first Record*.
+    const int http_port = ReadIntEnvOrDefault(kEnvHttpPort, 0);
+    if (http_port > 0 && http_port <= 65535) {
+        const char* env_addr = std::getenv(kEnvHttpAddr);
+        const std::string addr = env_addr && *env_addr ? env_addr : "127.0.0.1";
+        m_http = std::make_unique<OpenVerifyMetricsHttpServer>([this] { return BuildExpositionBody(); });
+        if (m_http->Start(addr, static_cast<uint16_t>(http_port))) {
+            // The endpoint replaces the default textfile unless a path was asked for explicitly.
+            if (!std::getenv(kEnvPath)) m_path.clear();
+        } else {
+            // Keep the default textfile so the counters are still exported somewhere.
+            m_http_error = addr + ":" + std::to_string(http_port) + ": " + std::strerror(m_http->StartError());
+            m_http.reset();
+        }
+    }
+
+    // Sync disk to in-memory zeros after restart; otherwise a stale file persists until the first periodic flush.
     if (!m_path.empty()) {
         Flush();
+        StartFlushThread();
     }
 }
 
-OpenVerifyMetrics::PerFailureMetrics& OpenVerifyMetrics::EnsureFailure(const std::string& host, int port,
-                                                                     const std::string& reason) {
-    const std::string key = FailureMapKey(host, port, reason);
-    const std::string pl = PortLabelForMetrics(port);
+OpenVerifyMetrics::~OpenVerifyMetrics() {
+    if (m_http) m_http->Stop();
+    StopFlushThread();
+    if (!m_path.empty()) Flush();
+}
 
-    std::lock_guard<std::mutex> lock(m_failure_mtx);
-    std::unique_ptr<PerFailureMetrics>& slot = m_failures_by_target_reason[key];
-    if (!slot) {
-        slot = std::make_unique<PerFailureMetrics>();
-        slot->host_esc = EscapeLabelValue(host);
-        slot->port_lbl = pl;
-        slot->reason_esc = EscapeLabelValue(reason);
+void OpenVerifyMetrics::StartFlushThread() {
+    std::lock_guard<std::mutex> lk(m_flush_lock);
+    if (m_flush_thread.joinable()) return;
+    m_flush_stop = false;
+    m_flush_thread = std::thread(&OpenVerifyMetrics::FlushThread, this);
+}
+
+void OpenVerifyMetrics::StopFlushThread() {
+    {
+        std::lock_guard<std::mutex> lk(m_flush_lock);
+        m_flush_stop = true;
+    }
+    m_flush_cv.notify_one();
+    if (m_flush_thread.joinable()) {
+        m_flush_thread.join();
+    }
+}
+
+uint64_t OpenVerifyMetrics::CounterGeneration() const {
+    // Per-failure counts move together with m_verify_failure, so they need no separate check.
+    return m_cache_miss.Load() + m_cache_hit_positive.Load() + m_cache_hit_negative.Load() + m_verify_success.Load() +
+           m_verify_failure.Load() + m_queue_admitted.Load() + m_queue_full.Load() + m_queue_timeout.Load() +
+           m_queue_shed.Load() + m_singleflight_leader.Load() + m_singleflight_follower.Load() +
+           m_follower_timeout.Load() + m_leader_timeout.Load() + m_overload_degrade[0].Load() +
+           m_overload_degrade[1].Load() + m_overload_degrade[2].Load() + m_stall_returned.Load() +
+           m_stall_resumed.Load() + m_open_deadline_exceeded.Load() + m_retry_deposited.Load() +
+           m_retry_granted.Load() + m_retry_exhausted.Load() + m_redirect_cache_hit.Load() +
+           m_redirect_cache_invalidated.Load() + m_breaker_opened.Load() + m_breaker_half_opened.Load() +
+           m_breaker_closed.Load() + m_queue_wait.Count() + m_follower_wait.Count() + m_open_duration.Count();
+}
+
+void OpenVerifyMetrics::FlushThread() {
+    uint64_t flushed_generation = CounterGeneration();
+    auto flushed_at = std::chrono::steady_clock::now();
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lk(m_flush_lock);
+            m_flush_cv.wait_for(lk, m_flush_interval, [&] { return m_flush_stop; });
+            if (m_flush_stop) break;
+        }
+
+        const uint64_t generation = CounterGeneration();
+        const auto now = std::chrono::steady_clock::now();
+        if (generation == flushed_generation && now - flushed_at < kMaxFileStaleness) continue;
+
+        Flush();
+        flushed_generation = generation;
+        flushed_at = now;
     }
+}
+
+void OpenVerifyMetrics::WriteGauge(std::ostream& out, const std::string& name, const std::string& help,
+                                   const std::string& labels, double value) {
+    out << "# HELP " << name << " " << help << "\n# TYPE " << name << " gauge\n" << name;
+    if (!labels.empty()) out << "{" << labels << "}";
+    out << " " << value << "\n";
+}
+
+int OpenVerifyMetrics::AddCollector(Collector collector) {
+    std::lock_guard<std::mutex> lock(m_collector_mtx);
+    const int id = m_next_collector_id++;
+    m_collectors.emplace(id, std::move(collector));
+    return id;
+}
+
+void OpenVerifyMetrics::RemoveCollector(int id) {
+    std::lock_guard<std::mutex> lock(m_collector_mtx);
+    m_collectors.erase(id);
+}
+
+OpenVerifyMetrics::PerHostLatency& OpenVerifyMetrics::EnsureHostLatency(const std::string& host, int port) {
+    std::string key = host + ':' + PortLabel(port);
+
+    std::lock_guard<std::mutex> lock(m_host_latency_mtx);
+    auto it = m_verify_by_host.find(key);
+    if (it != m_verify_by_host.end()) return *it->second;
+    if (m_verify_by_host.size() >= m_host_latency_limit) {
+        // Over the cap: every further host shares one overflow series.
+        key = "\x1eother";
+        it = m_verify_by_host.find(key);
+        if (it != m_verify_by_host.end()) return *it->second;
+    }
+    std::unique_ptr<PerHostLatency>& slot = m_verify_by_host[key];
+    slot = std::make_unique<PerHostLatency>();
+    const bool overflow = key == "\x1eother";
+    slot->host_esc = overflow ? std::string("other") : EscapeLabelValue(host);
+    slot->port_lbl = overflow ? std::string("none") : PortLabel(port);
+    return *slot;
+}
+
+OpenVerifyMetrics::PerClassLatency& OpenVerifyMetrics::EnsureClassLatency(const std::string& client_class) {
+    std::string key = client_class;
+
+    std::lock_guard<std::mutex> lock(m_host_latency_mtx);
+    auto it = m_wait_by_class.find(key);
+    if (it != m_wait_by_class.end()) return *it->second;
+    if (m_wait_by_class.size() >= m_class_latency_limit) {
+        key = "\x1eother";
+        it = m_wait_by_class.find(key);
+        if (it != m_wait_by_class.end()) return *it->second;
+    }
+    std::unique_ptr<PerClassLatency>& slot = m_wait_by_class[key];
+    slot = std::make_unique<PerClassLatency>();
+    slot->class_esc = key == "\x1eother" ? std::string("other") : EscapeLabelValue(client_class);
     return *slot;
 }
 
 std::string OpenVerifyMetrics::BuildExpositionBody() const {
     const std::string lbl =
         m_instance_label.empty() ? std::string() : (",xrootd_instance=\"" + m_instance_label + "\"");
+    // Label set for series that carry no other labels.
+    const std::string only_lbl =
+        m_instance_label.empty() ? std::string() : ("{xrootd_instance=\"" + m_instance_label + "\"}");
 
     std::ostringstream body;
     body << "# HELP xrootd_openverify_cache_lookups_total OpenVerify cache lookups by outcome.\n"
             "# TYPE xrootd_openverify_cache_lookups_total counter\n"
             "xrootd_openverify_cache_lookups_total{result=\"miss\""
-         << lbl << "} " << m_cache_miss.load(std::memory_order_relaxed) << "\n"
+         << lbl << "} " << m_cache_miss.Load() << "\n"
             "xrootd_openverify_cache_lookups_total{result=\"hit_positive\""
-         << lbl << "} " << m_cache_hit_positive.load(std::memory_order_relaxed) << "\n"
+         << lbl << "} " << m_cache_hit_positive.Load() << "\n"
             "xrootd_openverify_cache_lookups_total{result=\"hit_negative\""
-         << lbl << "} " << m_cache_hit_negative.load(std::memory_order_relaxed) << "\n"
+         << lbl << "} " << m_cache_hit_negative.Load() << "\n"
             "# HELP xrootd_openverify_runs_total OpenVerify executions after a cache miss.\n"
             "# TYPE xrootd_openverify_runs_total counter\n"
             "xrootd_openverify_runs_total{result=\"success\""
-         << lbl << "} " << m_verify_success.load(std::memory_order_relaxed) << "\n"
+         << lbl << "} " << m_verify_success.Load() << "\n"
             "xrootd_openverify_runs_total{result=\"failure\""
-         << lbl << "} " << m_verify_failure.load(std::memory_order_relaxed) << "\n"
+         << lbl << "} " << m_verify_failure.Load() << "\n"
             "# HELP xrootd_openverify_queue_admissions_total Queue admissions around OpenVerify FIFO capacity wait.\n"
             "# TYPE xrootd_openverify_queue_admissions_total counter\n"
             "xrootd_openverify_queue_admissions_total{result=\"admitted\""
-         << lbl << "} " << m_queue_admitted.load(std::memory_order_relaxed) << "\n"
+         << lbl << "} " << m_queue_admitted.Load() << "\n"
             "xrootd_openverify_queue_admissions_total{result=\"queue_full\""
-         << lbl << "} " << m_queue_full.load(std::memory_order_relaxed) << "\n"
+         << lbl << "} " << m_queue_full.Load() << "\n"
             "xrootd_openverify_queue_admissions_total{result=\"queue_timeout\""
-         << lbl << "} " << m_queue_timeout.load(std::memory_order_relaxed) << "\n"
+         << lbl << "} " << m_queue_timeout.Load() << "\n"
+            "xrootd_openverify_queue_admissions_total{result=\"shed\""
+         << lbl << "} " << m_queue_shed.Load() << "\n"
             "# HELP xrootd_openverify_singleflight_requests_total Single-flight requests split by role.\n"
             "# TYPE xrootd_openverify_singleflight_requests_total counter\n"
             "xrootd_openverify_singleflight_requests_total{role=\"leader\""
-         << lbl << "} " << m_singleflight_leader.load(std::memory_order_relaxed) << "\n"
+         << lbl << "} " << m_singleflight_leader.Load() << "\n"
             "xrootd_openverify_singleflight_requests_total{role=\"follower\""
-         << lbl << "} " << m_singleflight_follower.load(std::memory_order_relaxed) << "\n"
+         << lbl << "} " << m_singleflight_follower.Load() << "\n"
+            "# HELP xrootd_openverify_singleflight_timeouts_total Single-flight callers that gave up: followers past "
+            "their wait budget, leaders that stopped waiting for the verify they started.\n"
+            "# TYPE xrootd_openverify_singleflight_timeouts_total counter\n"
+            "xrootd_openverify_singleflight_timeouts_total{role=\"follower\""
+         << lbl << "} " << m_follower_timeout.Load() << "\n"
+            "xrootd_openverify_singleflight_timeouts_total{role=\"leader\""
+         << lbl << "} " << m_leader_timeout.Load() << "\n"
+            "# HELP xrootd_openverify_overload_degraded_total Opens that skipped verification because admission "
+            "was refused, by degrade action.\n"
+            "# TYPE xrootd_openverify_overload_degraded_total counter\n";
+    for (DegradeAction action : {DegradeAction::Open, DegradeAction::Stall, DegradeAction::Fail}) {
+        body << "xrootd_openverify_overload_degraded_total{action=\"" << DegradeActionLabel(action) << "\"" << lbl
+             << "} " << m_overload_degrade[static_cast<size_t>(action)].Load() << "\n";
+    }
+    body << "# HELP xrootd_openverify_stalls_total Stalls from the wrapped OFS returned to the client, and "
+            "client retries that resumed the stalled open.\n"
+            "# TYPE xrootd_openverify_stalls_total counter\n"
+            "xrootd_openverify_stalls_total{result=\"returned\""
+         << lbl << "} " << m_stall_returned.Load() << "\n"
+            "xrootd_openverify_stalls_total{result=\"resumed\""
+         << lbl << "} " << m_stall_resumed.Load() << "\n"
+            "# HELP xrootd_openverify_open_deadline_exceeded_total Opens cut short by the per-open deadline.\n"
+            "# TYPE xrootd_openverify_open_deadline_exceeded_total counter\n"
+            "xrootd_openverify_open_deadline_exceeded_total"
+         << only_lbl << " " << m_open_deadline_exceeded.Load() << "\n"
+            "# HELP xrootd_openverify_retry_budget_total Shared retry budget: first attempts deposited, retries "
+            "withdrawn, retries refused.\n"
+            "# TYPE xrootd_openverify_retry_budget_total counter\n"
+            "xrootd_openverify_retry_budget_total{result=\"deposited\""
+         << lbl << "} " << m_retry_deposited.Load() << "\n"
+            "xrootd_openverify_retry_budget_total{result=\"withdrawn\""
+         << lbl << "} " << m_retry_granted.Load() << "\n"
+            "xrootd_openverify_retry_budget_total{result=\"exhausted\""
+         << lbl << "} " << m_retry_exhausted.Load() << "\n"
+            "# HELP xrootd_openverify_redirect_cache_total Opens redirected from the redirect cache, and cached "
+            "targets invalidated.\n"
+            "# TYPE xrootd_openverify_redirect_cache_total counter\n"
+            "xrootd_openverify_redirect_cache_total{result=\"hit\""
+         << lbl << "} " << m_redirect_cache_hit.Load() << "\n"
+            "xrootd_openverify_redirect_cache_total{result=\"invalidated\""
+         << lbl << "} " << m_redirect_cache_invalidated.Load() << "\n"
+            "# HELP xrootd_openverify_host_breaker_transitions_total Host circuit breaker state transitions.\n"
+            "# TYPE xrootd_openverify_host_breaker_transitions_total counter\n"
+            "xrootd_openverify_host_breaker_transitions_total{to=\"open\""
+         << lbl << "} " << m_breaker_opened.Load() << "\n"
+            "xrootd_openverify_host_breaker_transitions_total{to=\"half_open\""
+         << lbl << "} " << m_breaker_half_opened.Load() << "\n"
+            "xrootd_openverify_host_breaker_transitions_total{to=\"closed\""
+         << lbl << "} " << m_breaker_closed.Load() << "\n"
+            "# HELP xrootd_openverify_host_recovery_seconds Time from a host breaker opening until it closed again.\n"
+            "# TYPE xrootd_openverify_host_recovery_seconds summary\n"
+            "xrootd_openverify_host_recovery_seconds_sum"
+         << only_lbl << " " << static_cast<double>(m_recovery_ms_sum.Load()) / 1000.0
+         << "\n"
+            "xrootd_openverify_host_recovery_seconds_count"
+         << only_lbl << " " << m_breaker_closed.Load() << "\n"
             "# HELP xrootd_openverify_verify_failures_total OpenVerify verify failures by redirect target and reason.\n"
             "# TYPE xrootd_openverify_verify_failures_total counter\n";
 
     {
         std::lock_guard<std::mutex> lock(m_failure_mtx);
-        for (const auto& kv : m_failures_by_target_reason) {
-            const PerFailureMetrics* e = kv.second.get();
-            if (!e) continue;
-            body << "xrootd_openverify_verify_failures_total{host=\"" << e->host_esc << "\",port=\""
-                 << e->port_lbl << "\",reason=\"" << e->reason_esc << "\"" << lbl << "} "
-                 << e->count.load(std::memory_order_relaxed) << "\n";
+        for (const auto& slot : m_failure_targets.Slots()) {
+            const FailureTarget& t = slot.payload;
+            for (const auto& kv : t.by_reason) {
+                body << "xrootd_openverify_verify_failures_total{host=\"" << t.host_esc << "\",port=\"" << t.port_lbl
+                     << "\",reason=\"" << kv.first << "\"" << lbl << "} " << kv.second << "\n";
+            }
+        }
+        for (const auto& kv : m_failures_other) {
+            body << "xrootd_openverify_verify_failures_total{host=\"other\",port=\"none\",reason=\"" << kv.first << "\""
+                 << lbl << "} " << kv.second << "\n";
+        }
+    }
+
+    const std::string plain_lbl = lbl.empty() ? std::string() : lbl.substr(1);
+    OpenVerifyLatencyHistogram::WriteHeader(body, "xrootd_openverify_queue_wait_seconds",
+                                            "Time single-flight leaders waited for FIFO admission.");
+    m_queue_wait.WriteTo(body, "xrootd_openverify_queue_wait_seconds", plain_lbl);
+    OpenVerifyLatencyHistogram::WriteHeader(body, "xrootd_openverify_class_queue_wait_seconds",
+                                            "Leader admission wait by fair-queuing client class.");
+    {
+        std::lock_guard<std::mutex> lock(m_host_latency_mtx);
+        for (const auto& kv : m_wait_by_class) {
+            kv.second->wait.WriteTo(body, "xrootd_openverify_class_queue_wait_seconds",
+                                    "class=\"" + kv.second->class_esc + "\"" + lbl);
+        }
+    }
+    OpenVerifyLatencyHistogram::WriteHeader(body, "xrootd_openverify_follower_wait_seconds",
+                                            "Time single-flight followers waited for the leader result.");
+    m_follower_wait.WriteTo(body, "xrootd_openverify_follower_wait_seconds", plain_lbl);
+    OpenVerifyLatencyHistogram::WriteHeader(body, "xrootd_openverify_xrdcl_step_seconds",
+                                            "Duration of each XrdCl operation issued by open_verify.");
+    for (XrdClStep step : {XrdClStep::Open, XrdClStep::Stat, XrdClStep::VectorRead, XrdClStep::Close}) {
+        m_xrdcl_steps[static_cast<size_t>(step)].WriteTo(
+            body, "xrootd_openverify_xrdcl_step_seconds", std::string("step=\"") + XrdClStepLabel(step) + "\"" + lbl);
+    }
+    OpenVerifyLatencyHistogram::WriteHeader(body, "xrootd_openverify_verify_duration_seconds",
+                                            "Duration of a full open_verify run by redirect target.");
+    {
+        std::lock_guard<std::mutex> lock(m_host_latency_mtx);
+        for (const auto& kv : m_verify_by_host) {
+            const PerHostLatency& e = *kv.second;
+            e.verify.WriteTo(body, "xrootd_openverify_verify_duration_seconds",
+                             "host=\"" + e.host_esc + "\",port=\"" + e.port_lbl + "\"" + lbl);
+        }
+    }
+    OpenVerifyLatencyHistogram::WriteHeader(body, "xrootd_openverify_open_duration_seconds",
+                                            "End-to-end OpenVerifyFile::open duration for every open-verify open.");
+    m_open_duration.WriteTo(body, "xrootd_openverify_open_duration_seconds", plain_lbl);
+
+    {
+        std::lock_guard<std::mutex> lock(m_collector_mtx);
+        for (const auto& kv : m_collectors) {
+            kv.second(body, lbl);
         }
     }
 
@@ -137,57 +402,142 @@ std::string OpenVerifyMetrics::BuildExpositionBody() const {
 }
 
 void OpenVerifyMetrics::RecordCacheMiss() {
-    m_cache_miss.fetch_add(1, std::memory_order_relaxed);
-    if (!m_path.empty()) Flush();
+    m_cache_miss.Add();
 }
 
 void OpenVerifyMetrics::RecordCacheHitPositive() {
-    m_cache_hit_positive.fetch_add(1, std::memory_order_relaxed);
-    if (!m_path.empty()) Flush();
+    m_cache_hit_positive.Add();
 }
 
 void OpenVerifyMetrics::RecordCacheHitNegative() {
-    m_cache_hit_negative.fetch_add(1, std::memory_order_relaxed);
-    if (!m_path.empty()) Flush();
+    m_cache_hit_negative.Add();
 }
 
 void OpenVerifyMetrics::RecordVerifySuccess() {
-    m_verify_success.fetch_add(1, std::memory_order_relaxed);
-    if (!m_path.empty()) Flush();
+    m_verify_success.Add();
 }
 
 void OpenVerifyMetrics::RecordVerifyFailure(const std::string& host, int port, const std::string& reason) {
     const std::string r = reason.empty() ? std::string("unknown") : reason;
-    m_verify_failure.fetch_add(1, std::memory_order_relaxed);
-    EnsureFailure(host, port, r).count.fetch_add(1, std::memory_order_relaxed);
-    if (!m_path.empty()) Flush();
+    const std::string key = FailureTargetKey(host, port);
+    m_verify_failure.Add();
+
+    // Keep totals monotonic: a displaced target's counts live on in host="other".
+    auto fold_into_other = [this](const OpenVerifyTopK<FailureTarget>::Slot& evicted) {
+        for (const auto& kv : evicted.payload.by_reason) m_failures_other[kv.first] += kv.second;
+    };
+
+    std::lock_guard<std::mutex> lock(m_failure_mtx);
+    bool fresh = false;
+    FailureTarget& t = m_failure_targets.Offer(key, fold_into_other, &fresh).payload;
+    if (fresh) {
+        t.host_esc = EscapeLabelValue(host);
+        t.port_lbl = PortLabel(port);
+    }
+    ++t.by_reason[EscapeLabelValue(r)];
 }
 
 void OpenVerifyMetrics::RecordQueueAdmissionAdmitted() {
-    m_queue_admitted.fetch_add(1, std::memory_order_relaxed);
-    if (!m_path.empty()) Flush();
+    m_queue_admitted.Add();
 }
 
 void OpenVerifyMetrics::RecordQueueAdmissionFull() {
-    m_queue_full.fetch_add(1, std::memory_order_relaxed);
-    if (!m_path.empty()) Flush();
+    m_queue_full.Add();
 }
 
 void OpenVerifyMetrics::RecordQueueAdmissionTimeout() {
-    m_queue_timeout.fetch_add(1, std::memory_order_relaxed);
-    if (!m_path.empty()) Flush();
+    m_queue_timeout.Add();
+}
+
+void OpenVerifyMetrics::RecordQueueAdmissionShed() {
+    m_queue_shed.Add();
+}
+
+void OpenVerifyMetrics::RecordSingleFlightTimeout(bool leader) {
+    if (leader) {
+        m_leader_timeout.Add();
+    } else {
+        m_follower_timeout.Add();
+    }
+}
+
+void OpenVerifyMetrics::RecordOverloadDegrade(DegradeAction action) {
+    m_overload_degrade[static_cast<size_t>(action)].Add();
+}
+
+void OpenVerifyMetrics::RecordStallReturned() {
+    m_stall_returned.Add();
+}
+
+void OpenVerifyMetrics::RecordStallResumed() {
+    m_stall_resumed.Add();
+}
+
+void OpenVerifyMetrics::RecordOpenDeadlineExceeded() {
+    m_open_deadline_exceeded.Add();
+}
+
+void OpenVerifyMetrics::RecordRetryBudgetDeposit() {
+    m_retry_deposited.Add();
+}
+
+void OpenVerifyMetrics::RecordRetryBudgetWithdraw(bool granted) {
+    if (granted) {
+        m_retry_granted.Add();
+    } else {
+        m_retry_exhausted.Add();
+    }
+}
+
+void OpenVerifyMetrics::RecordRedirectCacheHit() {
+    m_redirect_cache_hit.Add();
+}
+
+void OpenVerifyMetrics::RecordRedirectCacheInvalidated() {
+    m_redirect_cache_invalidated.Add();
 }
 
 void OpenVerifyMetrics::RecordSingleFlightLeader() {
-    m_singleflight_leader.fetch_add(1, std::memory_order_relaxed);
-    if (!m_path.empty()) Flush();
+    m_singleflight_leader.Add();
 }
 
 void OpenVerifyMetrics::RecordSingleFlightFollower() {
-    m_singleflight_follower.fetch_add(1, std::memory_order_relaxed);
-    if (!m_path.empty()) Flush();
+    m_singleflight_follower.Add();
 }
 
+void OpenVerifyMetrics::RecordHostBreakerOpened() {
+    m_breaker_opened.Add();
+}
+
+void OpenVerifyMetrics::RecordHostBreakerHalfOpened() {
+    m_breaker_half_opened.Add();
+}
+
+void OpenVerifyMetrics::RecordHostBreakerClosed(std::chrono::steady_clock::duration recovery) {
+    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(recovery).count();
+    m_recovery_ms_sum.Add(ms > 0 ? static_cast<uint64_t>(ms) : 0);
+    m_breaker_closed.Add();
+}
+
+void OpenVerifyMetrics::ObserveQueueWait(std::chrono::steady_clock::duration d) { m_queue_wait.Observe(d); }
+
+void OpenVerifyMetrics::ObserveFollowerWait(std::chrono::steady_clock::duration d) { m_follower_wait.Observe(d); }
+
+void OpenVerifyMetrics::ObserveXrdClStep(XrdClStep step, std::chrono::steady_clock::duration d) {
+    m_xrdcl_steps[static_cast<size_t>(step)].Observe(d);
+}
+
+void OpenVerifyMetrics::ObserveVerify(const std::string& host, int port, std::chrono::steady_clock::duration d) {
+    EnsureHostLatency(host, port).verify.Observe(d);
+}
+
+void OpenVerifyMetrics::ObserveClassQueueWait(const std::string& client_class,
+                                              std::chrono::steady_clock::duration d) {
+    EnsureClassLatency(client_class).wait.Observe(d);
+}
+
+void OpenVerifyMetrics::ObserveOpen(std::chrono::steady_clock::duration d) { m_open_duration.Observe(d); }
+
 void OpenVerifyMetrics::Flush() {
     const std::string content = BuildExpositionBody();
     const std::string tmp_path = m_path + ".tmp";
@@ -0,0 +1,212 @@
+#include "OpenVerifyMetricsHttp.hh"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <utility>
+
+namespace {
+
+// A scrape that has not finished within this window is dropped.
+constexpr std::chrono::seconds kConnectionTimeout{5};
+
+void CloseFd(int& fd) {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+std::string HttpResponse(const char* status, const char* content_type, const std::string& body) {
+    std::string out;
+    out.reserve(body.size() + 160);
+    out += "HTTP/1.1 ";
+    out += status;
+    out += "\r\nContent-Type: ";
+    out += content_type;
+    out += "\r\nContent-Length: ";
+    out += std::to_string(body.size());
+    out += "\r\nConnection: close\r\n\r\n";
+    out += body;
+    return out;
+}
+
+}  // namespace
+
+OpenVerifyMetricsHttpServer::OpenVerifyMetricsHttpServer(Renderer render) : m_render(std::move(render)) {}
+
+OpenVerifyMetricsHttpServer::~OpenVerifyMetricsHttpServer() { Stop(); }
+
+bool OpenVerifyMetricsHttpServer::Start(const std::string& address, uint16_t port) {
+    if (m_thread.joinable()) return true;
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (::inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) {
+        m_start_error = EINVAL;
+        return false;
+    }
+
+    m_listen_fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (m_listen_fd < 0) {
+        m_start_error = errno;
+        return false;
+    }
+
+    const int one = 1;
+    (void)::setsockopt(m_listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (::bind(m_listen_fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(m_listen_fd, 16) != 0) {
+        m_start_error = errno;
+        CloseFd(m_listen_fd);
+        return false;
+    }
+
+    sockaddr_in bound{};
+    socklen_t bound_len = sizeof(bound);
+    if (::getsockname(m_listen_fd, reinterpret_cast<sockaddr*>(&bound), &bound_len) != 0 ||
+        ::pipe2(m_wake_pipe, O_NONBLOCK | O_CLOEXEC) != 0) {
+        m_start_error = errno;
+        CloseFd(m_listen_fd);
+        return false;
+    }
+    m_port = ntohs(bound.sin_port);
+    m_start_error = 0;
+
+    m_thread = std::thread(&OpenVerifyMetricsHttpServer::Serve, this);
+    return true;
+}
+
+void OpenVerifyMetricsHttpServer::Stop() {
+    if (m_thread.joinable()) {
+        const char b = 1;
+        (void)!::write(m_wake_pipe[1], &b, 1);
+        m_thread.join();
+    }
+    for (Connection& c : m_conns) CloseFd(c.fd);
+    m_conns.clear();
+    CloseFd(m_listen_fd);
+    CloseFd(m_wake_pipe[0]);
+    CloseFd(m_wake_pipe[1]);
+    m_port = 0;
+}
+
+void OpenVerifyMetricsHttpServer::Serve() {
+    std::vector<pollfd> fds;
+    while (true) {
+        fds.clear();
+        fds.push_back(pollfd{m_wake_pipe[0], POLLIN, 0});
+        // Stop accepting while at the connection cap; pending clients wait in the backlog.
+        fds.push_back(pollfd{m_listen_fd, static_cast<short>(m_conns.size() < kMaxConnections ? POLLIN : 0), 0});
+        for (const Connection& c : m_conns) {
+            fds.push_back(pollfd{c.fd, static_cast<short>(c.out.empty() ? POLLIN : POLLOUT), 0});
+        }
+
+        const int n = ::poll(fds.data(), fds.size(), 1000);
+        if (n < 0 && errno != EINTR) break;
+        if (fds[0].revents & POLLIN) break;
+
+        const auto now = std::chrono::steady_clock::now();
+        // Connections are matched to pollfd entries by position; accept only after this pass.
+        std::vector<Connection> keep;
+        keep.reserve(m_conns.size());
+        for (size_t i = 0; i < m_conns.size(); ++i) {
+            Connection& c = m_conns[i];
+            const short rev = n > 0 ? fds[i + 2].revents : 0;
+            bool alive = now < c.deadline;
+            if (alive && (rev & (POLLERR | POLLHUP | POLLNVAL)) && !(rev & POLLIN)) alive = false;
+            if (alive && (rev & POLLIN)) alive = OnReadable(c);
+            if (alive && (rev & POLLOUT)) alive = OnWritable(c);
+            if (alive) {
+                keep.push_back(std::move(c));
+            } else {
+                CloseFd(c.fd);
+            }
+        }
+        m_conns.swap(keep);
+
+        if (n > 0 && (fds[1].revents & POLLIN)) AcceptAll();
+    }
+}
+
+void OpenVerifyMetricsHttpServer::AcceptAll() {
+    while (m_conns.size() < kMaxConnections) {
+        const int fd = ::accept4(m_listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;  // EAGAIN or a transient error: wait for the next poll round
+        Connection c;
+        c.fd = fd;
+        c.deadline = std::chrono::steady_clock::now() + kConnectionTimeout;
+        m_conns.push_back(std::move(c));
+    }
+}
+
+bool OpenVerifyMetricsHttpServer::OnReadable(Connection& c) {
+    char buf[2048];
+    while (true) {
+        const ssize_t r = ::recv(c.fd, buf, sizeof(buf), 0);
+        if (r > 0) {
+            c.in.append(buf, static_cast<size_t>(r));
+            if (c.in.size() > kMaxRequestBytes) return false;
+            continue;
+        }
+        if (r == 0) return false;  // peer closed before sending a full request
+        if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+        if (errno == EINTR) continue;
+        return false;
+    }
+
+    const size_t head_end = c.in.find("\r\n\r\n");
+    if (head_end == std::string::npos) return true;
+    c.out = BuildResponse(c.in.substr(0, head_end));
+    c.in.clear();
+    return OnWritable(c);
+}
+
+bool OpenVerifyMetricsHttpServer::OnWritable(Connection& c) {
+    while (c.out_off < c.out.size()) {
+        const ssize_t w = ::send(c.fd, c.out.data() + c.out_off, c.out.size() - c.out_off, MSG_NOSIGNAL);
+        if (w > 0) {
+            c.out_off += static_cast<size_t>(w);
+            continue;
+        }
+        if (w < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+        if (w < 0 && errno == EINTR) continue;
+        return false;
+    }
+    return false;  // response fully sent; Connection: close
+}
+
+std::string OpenVerifyMetricsHttpServer::BuildResponse(const std::string& request_head) {
+    const size_t line_end = request_head.find("\r\n");
+    const std::string line = request_head.substr(0, line_end);
+    const size_t sp1 = line.find(' ');
+    const size_t sp2 = sp1 == std::string::npos ? std::string::npos : line.find(' ', sp1 + 1);
+    if (sp2 == std::string::npos) {
+        return HttpResponse("400 Bad Request", "text/plain; charset=utf-8", "bad request\n");
+    }
+
+    const std::string method = line.substr(0, sp1);
+    std::string target = line.substr(sp1 + 1, sp2 - sp1 - 1);
+    const size_t query = target.find('?');
+    if (query != std::string::npos) target.resize(query);
+
+    if (target != "/metrics") {
+        return HttpResponse("404 Not Found", "text/plain; charset=utf-8", "not found\n");
+    }
+    if (method != "GET" && method != "HEAD") {
+        return HttpResponse("405 Method Not Allowed", "text/plain; charset=utf-8", "method not allowed\n");
+    }
+
+    std::string response =
+        HttpResponse("200 OK", "text/plain; version=0.0.4; charset=utf-8", m_render ? m_render() : std::string());
+    if (method == "HEAD") {
+        response.resize(response.find("\r\n\r\n") + 4);
+    }
+    return response;
+}
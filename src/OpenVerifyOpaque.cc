@@ -0,0 +1,178 @@
+#include "OpenVerifyOpaque.hh"
+
+#include <cctype>
+#include <cstring>
+
+namespace {
+
+int HexValue(char c) {
+    const unsigned char uc = static_cast<unsigned char>(c);
+    if (uc >= '0' && uc <= '9') return uc - '0';
+    if (uc >= 'a' && uc <= 'f') return 10 + (uc - 'a');
+    if (uc >= 'A' && uc <= 'F') return 10 + (uc - 'A');
+    return -1;
+}
+
+// URL-decodes one character of `in` at `i` ('%XX' or '+'), advancing `i` past it.
+char DecodeAt(std::string_view in, size_t& i) {
+    const char c = in[i++];
+    if (c == '+') return ' ';
+    if (c == '%' && i + 1 < in.size()) {
+        const int hi = HexValue(in[i]);
+        const int lo = HexValue(in[i + 1]);
+        if (hi >= 0 && lo >= 0) {
+            i += 2;
+            return static_cast<char>((hi << 4) | lo);
+        }
+    }
+    return c;
+}
+
+// True if `raw` URL-decodes to `lower` ignoring ASCII case; no decoded copy is made.
+bool DecodedEqualsIgnoreCase(std::string_view raw, std::string_view lower) {
+    size_t i = 0;
+    size_t j = 0;
+    while (i < raw.size()) {
+        if (j == lower.size()) return false;
+        const char c = DecodeAt(raw, i);
+        if (std::tolower(static_cast<unsigned char>(c)) != lower[j++]) return false;
+    }
+    return j == lower.size();
+}
+
+std::string UrlDecode(std::string_view in) {
+    std::string out;
+    out.reserve(in.size());
+    for (size_t i = 0; i < in.size();) out.push_back(DecodeAt(in, i));
+    return out;
+}
+
+std::string_view TrimAsciiWhitespace(std::string_view in) {
+    while (!in.empty() && std::isspace(static_cast<unsigned char>(in.front())) != 0) in.remove_prefix(1);
+    while (!in.empty() && std::isspace(static_cast<unsigned char>(in.back())) != 0) in.remove_suffix(1);
+    return in;
+}
+
+bool StartsWithIgnoreCase(std::string_view s, std::string_view lower_prefix) {
+    if (s.size() < lower_prefix.size()) return false;
+    for (size_t i = 0; i < lower_prefix.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(s[i])) != lower_prefix[i]) return false;
+    }
+    return true;
+}
+
+constexpr std::string_view kTokenNames[] = {"authorization", "authz",  "bearer",
+                                            "bearer_token",  "token", "access_token"};
+
+}  // namespace
+
+OpenVerifyOpaque::OpenVerifyOpaque(const char* opaque)
+    : OpenVerifyOpaque(opaque ? std::string_view(opaque) : std::string_view()) {}
+
+OpenVerifyOpaque::OpenVerifyOpaque(std::string_view opaque) : m_raw(opaque) {
+    if (!m_raw.empty() && m_raw.front() == '?') m_raw.remove_prefix(1);
+    Parse();
+}
+
+// One pass over the string; the separator scans are memchr (vectorized in the C library).
+void OpenVerifyOpaque::Parse() {
+    const char* p = m_raw.data();
+    const char* const end = p + m_raw.size();
+    while (p < end) {
+        const char* amp = static_cast<const char*>(std::memchr(p, '&', static_cast<size_t>(end - p)));
+        if (!amp) amp = end;
+        if (amp != p) {
+            const char* eq = static_cast<const char*>(std::memchr(p, '=', static_cast<size_t>(amp - p)));
+            Pair pair;
+            if (eq) {
+                pair.name = std::string_view(p, static_cast<size_t>(eq - p));
+                pair.value = std::string_view(eq + 1, static_cast<size_t>(amp - eq - 1));
+            } else {
+                pair.name = std::string_view(p, static_cast<size_t>(amp - p));
+                pair.value = std::string_view(amp, 0);
+            }
+            if (m_size < kInlinePairs) {
+                m_inline[m_size] = pair;
+            } else {
+                m_overflow.push_back(pair);
+            }
+            ++m_size;
+        }
+        p = amp + 1;
+    }
+}
+
+const OpenVerifyOpaque::Pair* OpenVerifyOpaque::FindPair(std::string_view name) const {
+    for (size_t i = 0; i < m_size; ++i) {
+        const Pair& pair = (*this)[i];
+        if (pair.name == name) return &pair;
+    }
+    return nullptr;
+}
+
+std::string_view OpenVerifyOpaque::Find(std::string_view name) const {
+    const Pair* pair = FindPair(name);
+    return pair ? pair->value : std::string_view();
+}
+
+bool OpenVerifyOpaque::Has(std::string_view name) const {
+    return FindPair(name) != nullptr;
+}
+
+bool OpenVerifyOpaque::FindToken(std::string& out) const {
+    out.clear();
+    for (size_t i = 0; i < m_size; ++i) {
+        const Pair& pair = (*this)[i];
+        bool match = false;
+        for (std::string_view name : kTokenNames) {
+            if (DecodedEqualsIgnoreCase(pair.name, name)) {
+                match = true;
+                break;
+            }
+        }
+        if (!match) continue;
+
+        const std::string decoded = UrlDecode(pair.value);
+        std::string_view value = TrimAsciiWhitespace(decoded);
+        if (StartsWithIgnoreCase(value, "bearer ")) {
+            value = TrimAsciiWhitespace(value.substr(7));
+        }
+        if (!value.empty()) {
+            out.assign(value);
+            return true;
+        }
+    }
+    return false;
+}
+
+// The tried= pair hosts are added to; a bare "tried" without '=' does not count.
+const OpenVerifyOpaque::Pair* OpenVerifyOpaque::TriedPair() const {
+    const Pair* tried = FindPair("tried");
+    if (tried && tried->value.data() != tried->name.data() + tried->name.size() + 1) return nullptr;
+    return tried;
+}
+
+size_t OpenVerifyOpaque::SizeWithTried(std::string_view tried_hosts) const {
+    if (tried_hosts.empty()) return m_raw.size();
+    if (TriedPair()) return m_raw.size() + 1 + tried_hosts.size();
+    return m_raw.size() + (m_raw.empty() ? 0 : 1) + 6 + tried_hosts.size();
+}
+
+void OpenVerifyOpaque::AppendWithTried(std::string& out, std::string_view tried_hosts) const {
+    if (tried_hosts.empty()) {
+        out.append(m_raw);
+        return;
+    }
+    if (const Pair* tried = TriedPair()) {
+        const size_t split = static_cast<size_t>(tried->value.data() + tried->value.size() - m_raw.data());
+        out.append(m_raw.substr(0, split));
+        out.push_back(',');
+        out.append(tried_hosts);
+        out.append(m_raw.substr(split));
+        return;
+    }
+    out.append(m_raw);
+    if (!m_raw.empty()) out.push_back('&');
+    out.append("tried=");
+    out.append(tried_hosts);
+}
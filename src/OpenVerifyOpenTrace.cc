@@ -0,0 +1,309 @@
+#include "OpenVerifyOpenTrace.hh"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+
+#include "OpenVerifyEnv.hh"
+
+namespace {
+
+std::string PathFromEnv() {
+    const char* p = std::getenv("XRD_OPENVERIFY_TRACE_PATH");
+    return p ? p : "";
+}
+
+uint32_t Micros(std::chrono::steady_clock::duration d) {
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+    return static_cast<uint32_t>(std::clamp<int64_t>(us, 0, UINT32_MAX));
+}
+
+// Copies `s` into `dst[size]`, cut to fit and NUL-terminated.
+void CopyText(char* dst, size_t size, std::string_view s) {
+    const size_t n = std::min(s.size(), size - 1);
+    std::memcpy(dst, s.data(), n);
+    dst[n] = '\0';
+}
+
+void AppendJsonString(std::string& out, const char* s) {
+    static const char kHex[] = "0123456789abcdef";
+    out += '"';
+    for (; *s; ++s) {
+        const auto c = static_cast<unsigned char>(*s);
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += static_cast<char>(c);
+        } else if (c < 0x20) {
+            out += "\\u00";
+            out += kHex[c >> 4];
+            out += kHex[c & 0xf];
+        } else {
+            out += static_cast<char>(c);
+        }
+    }
+    out += '"';
+}
+
+const char* CacheResultName(uint8_t v) {
+    switch (static_cast<OpenVerifyOpenTrace::CacheResult>(v)) {
+        case OpenVerifyOpenTrace::CacheResult::Miss:
+            return "miss";
+        case OpenVerifyOpenTrace::CacheResult::Positive:
+            return "hit_positive";
+        case OpenVerifyOpenTrace::CacheResult::Negative:
+            return "hit_negative";
+    }
+    return "unknown";
+}
+
+const char* RoleName(uint8_t v) {
+    switch (static_cast<OpenVerifyOpenTrace::Role>(v)) {
+        case OpenVerifyOpenTrace::Role::Leader:
+            return "leader";
+        case OpenVerifyOpenTrace::Role::Follower:
+            return "follower";
+        case OpenVerifyOpenTrace::Role::Refused:
+            return "refused";
+    }
+    return "unknown";
+}
+
+const char* StepName(uint8_t v) {
+    switch (static_cast<OpenVerifyMetrics::XrdClStep>(v)) {
+        case OpenVerifyMetrics::XrdClStep::Open:
+            return "open";
+        case OpenVerifyMetrics::XrdClStep::Stat:
+            return "stat";
+        case OpenVerifyMetrics::XrdClStep::VectorRead:
+            return "vector_read";
+        case OpenVerifyMetrics::XrdClStep::Close:
+            return "close";
+    }
+    return "unknown";
+}
+
+}  // namespace
+
+OpenVerifyOpenTrace::Span::Span(OpenVerifyOpenTrace& trace, std::string_view path)
+    : m_trace(trace.Enabled() ? &trace : nullptr) {
+    if (!m_trace) return;
+    m_sampled = m_trace->Sample();
+    m_start = std::chrono::steady_clock::now();
+    m_record.start_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                            std::chrono::system_clock::now().time_since_epoch())
+                            .count();
+    m_record.duration_us = 0;
+    m_record.rc = 0;
+    m_record.resumed = false;
+    m_record.events = 0;
+    m_record.events_cut = false;
+    CopyText(m_record.path, sizeof(m_record.path), path);
+    m_record.tried[0] = '\0';
+}
+
+void OpenVerifyOpenTrace::Span::Add(Event::Kind kind, uint8_t detail, int rc, std::chrono::steady_clock::duration d,
+                                    std::string_view target, std::chrono::steady_clock::time_point end) {
+    if (m_record.events == kMaxEvents) {
+        m_record.events_cut = true;
+        return;
+    }
+    Event& e = m_record.event[m_record.events++];
+    e.kind = kind;
+    e.detail = detail;
+    e.rc = rc;
+    e.at_us = Micros(end - m_start);
+    e.duration_us = Micros(d);
+    CopyText(e.target, sizeof(e.target), target);
+}
+
+void OpenVerifyOpenTrace::Span::Finish(int rc, std::string_view tried_hosts) {
+    if (!m_trace) return;
+    OpenVerifyOpenTrace* trace = m_trace;
+    m_trace = nullptr;
+    const auto d = std::chrono::steady_clock::now() - m_start;
+    if (!m_sampled && d < trace->m_slow_threshold) return;
+    m_record.duration_us = Micros(d);
+    m_record.rc = rc;
+    CopyText(m_record.tried, sizeof(m_record.tried), tried_hosts);
+    trace->Keep(m_record);
+}
+
+void OpenVerifyOpenTrace::Recorder::Add(Event::Kind kind, uint8_t detail, int rc,
+                                        std::chrono::steady_clock::duration d) {
+    const auto end = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lk(m_mtx);
+    m_entries.push_back({kind, detail, rc, d, end});
+}
+
+void OpenVerifyOpenTrace::Recorder::Replay(Span& span) const {
+    if (!span.Active()) return;
+    std::lock_guard<std::mutex> lk(m_mtx);
+    for (const Entry& e : m_entries) span.Add(e.kind, e.detail, e.rc, e.d, {}, e.end);
+}
+
+OpenVerifyOpenTrace::OpenVerifyOpenTrace()
+    : OpenVerifyOpenTrace(PathFromEnv(), static_cast<uint32_t>(ReadIntEnvOrDefault("XRD_OPENVERIFY_TRACE_SAMPLE", 100)),
+                          std::chrono::milliseconds(ReadIntEnvOrDefault("XRD_OPENVERIFY_TRACE_SLOW_MS", 1000)),
+                          static_cast<size_t>(ReadIntEnvOrDefault("XRD_OPENVERIFY_TRACE_QUEUE", 1024))) {}
+
+OpenVerifyOpenTrace::OpenVerifyOpenTrace(const std::string& path, uint32_t sample_every,
+                                         std::chrono::milliseconds slow_threshold, size_t capacity)
+    : m_sample_every(std::max<uint32_t>(sample_every, 1)),
+      m_slow_threshold(slow_threshold),
+      m_path(path),
+      // Records are a few kilobytes; no ring at all while off.
+      m_ring(path.empty() ? 1 : capacity) {
+    if (path.empty()) return;
+    m_file = std::fopen(path.c_str(), "a");
+    if (!m_file) {
+        m_open_error = errno;
+        return;
+    }
+    m_thread = std::thread([this] { WriterLoop(); });
+}
+
+OpenVerifyOpenTrace::~OpenVerifyOpenTrace() {
+    if (!m_file) return;
+    {
+        std::lock_guard<std::mutex> lk(m_wake_mtx);
+        m_stop = true;
+    }
+    m_wake_cv.notify_one();
+    m_thread.join();
+    std::fclose(m_file);
+}
+
+bool OpenVerifyOpenTrace::Sample() {
+    static thread_local uint32_t countdown = 0;
+    if (countdown > 0) {
+        --countdown;
+        return false;
+    }
+    countdown = m_sample_every - 1;
+    return true;
+}
+
+void OpenVerifyOpenTrace::Keep(const Record& record) {
+    size_t pos;
+    Record* slot = m_ring.Claim(pos);
+    if (!slot) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    // Only the filled-in events; the rest of the array is stale and never read.
+    std::memcpy(slot, &record, offsetof(Record, event));
+    std::memcpy(slot->event, record.event, record.events * sizeof(Event));
+    m_ring.Publish(pos);
+}
+
+void OpenVerifyOpenTrace::WriteExposition(std::ostream& out, const std::string& lbl) const {
+    if (!Enabled()) return;
+    const std::string only_lbl = lbl.empty() ? std::string() : ("{" + lbl.substr(1) + "}");
+    out << "# HELP xrootd_openverify_open_trace_written_total Open traces written to XRD_OPENVERIFY_TRACE_PATH.\n"
+           "# TYPE xrootd_openverify_open_trace_written_total counter\n"
+           "xrootd_openverify_open_trace_written_total"
+        << only_lbl << " " << m_written.load(std::memory_order_acquire) << "\n"
+        << "# HELP xrootd_openverify_open_trace_dropped_total Open traces dropped because the trace queue was full.\n"
+           "# TYPE xrootd_openverify_open_trace_dropped_total counter\n"
+           "xrootd_openverify_open_trace_dropped_total"
+        << only_lbl << " " << Dropped() << "\n";
+}
+
+std::string OpenVerifyOpenTrace::Format(const Record& r) {
+    std::string out;
+    out.reserve(512 + r.events * 96);
+    out += "{\"start_us\":" + std::to_string(r.start_us);
+    out += ",\"path\":";
+    AppendJsonString(out, r.path);
+    out += ",\"duration_us\":" + std::to_string(r.duration_us);
+    out += ",\"rc\":" + std::to_string(r.rc);
+    out += r.resumed ? ",\"resumed\":true" : ",\"resumed\":false";
+    out += ",\"tried\":";
+    AppendJsonString(out, r.tried);
+    out += ",\"events\":[";
+    for (size_t i = 0; i < r.events; ++i) {
+        const Event& e = r.event[i];
+        if (i > 0) out += ',';
+        out += "{\"at_us\":" + std::to_string(e.at_us);
+        switch (e.kind) {
+            case Event::Kind::Attempt:
+                out += ",\"event\":\"attempt\",\"duration_us\":" + std::to_string(e.duration_us);
+                out += ",\"rc\":" + std::to_string(e.rc);
+                if (e.target[0]) {
+                    out += ",\"target\":";
+                    AppendJsonString(out, e.target);
+                }
+                break;
+            case Event::Kind::Avoided:
+                out += ",\"event\":\"avoided\",\"target\":";
+                AppendJsonString(out, e.target);
+                break;
+            case Event::Kind::RedirectCache:
+                out += ",\"event\":\"redirect_cache\",\"target\":";
+                AppendJsonString(out, e.target);
+                break;
+            case Event::Kind::Cache:
+                out += ",\"event\":\"cache\",\"result\":\"";
+                out += CacheResultName(e.detail);
+                out += '"';
+                break;
+            case Event::Kind::SingleFlight:
+                out += ",\"event\":\"single_flight\",\"role\":\"";
+                out += RoleName(e.detail);
+                out += "\",\"wait_us\":" + std::to_string(e.duration_us);
+                break;
+            case Event::Kind::Verify:
+                out += ",\"event\":\"verify\",\"duration_us\":" + std::to_string(e.duration_us);
+                out += ",\"code\":" + std::to_string(e.rc);
+                break;
+            case Event::Kind::XrdCl:
+                out += ",\"event\":\"xrdcl\",\"step\":\"";
+                out += StepName(e.detail);
+                out += "\",\"duration_us\":" + std::to_string(e.duration_us);
+                out += ",\"code\":" + std::to_string(e.rc);
+                break;
+        }
+        out += '}';
+    }
+    out += ']';
+    if (r.events_cut) out += ",\"events_cut\":true";
+    out += '}';
+    return out;
+}
+
+size_t OpenVerifyOpenTrace::WriteOnce() {
+    size_t written = 0;
+    while (const Record* record = m_ring.Front()) {
+        const std::string line = Format(*record);
+        m_ring.Pop();
+        std::fwrite(line.data(), 1, line.size(), m_file);
+        std::fputc('\n', m_file);
+        ++written;
+    }
+    if (written > 0) {
+        std::fflush(m_file);
+        m_written.fetch_add(written, std::memory_order_release);
+    }
+    return written;
+}
+
+void OpenVerifyOpenTrace::WriterLoop() {
+    for (;;) {
+        if (WriteOnce() > 0) continue;
+        std::unique_lock<std::mutex> lk(m_wake_mtx);
+        if (m_stop) break;
+        m_wake_cv.wait_for(lk, std::chrono::milliseconds(100));
+    }
+    WriteOnce();
+}
+
+void OpenVerifyOpenTrace::Flush() {
+    if (!m_file) return;
+    const size_t target = m_ring.Claimed();
+    m_wake_cv.notify_one();
+    while (m_written.load(std::memory_order_acquire) < target) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
@@ -0,0 +1,57 @@
+#include "OpenVerifyRedirectCache.hh"
+
+#include <iterator>
+#include <utility>
+
+#include "OpenVerifyEnv.hh"
+
+OpenVerifyRedirectCache::OpenVerifyRedirectCache()
+    : OpenVerifyRedirectCache(std::chrono::milliseconds(ReadIntEnvOrDefault("XRD_OPENVERIFY_REDIRECT_CACHE_TTL_MS", 0)),
+                              static_cast<size_t>(ReadIntEnvOrDefault("XRD_OPENVERIFY_REDIRECT_CACHE_MAX", 4096))) {}
+
+OpenVerifyRedirectCache::OpenVerifyRedirectCache(std::chrono::milliseconds ttl, size_t capacity)
+    : m_ttl(ttl), m_capacity(capacity > 0 ? capacity : 1) {}
+
+void OpenVerifyRedirectCache::EraseLocked(std::unordered_map<std::string, Slot>::iterator it) {
+    m_order.erase(it->second.order);
+    m_slots.erase(it);
+}
+
+void OpenVerifyRedirectCache::Put(const std::string& path, Target target, Clock::time_point now) {
+    if (!Enabled()) return;
+    std::lock_guard<std::mutex> lock(m_mtx);
+    auto it = m_slots.find(path);
+    if (it != m_slots.end()) EraseLocked(it);
+
+    // Drop expired entries from the old end, then make room.
+    while (!m_order.empty()) {
+        auto oldest = m_slots.find(m_order.front());
+        if (oldest->second.expires > now && m_slots.size() < m_capacity) break;
+        EraseLocked(oldest);
+    }
+
+    m_order.push_back(path);
+    m_slots.emplace(path, Slot{std::move(target), now + m_ttl, std::prev(m_order.end())});
+}
+
+bool OpenVerifyRedirectCache::Get(const std::string& path, Target& out, Clock::time_point now) const {
+    if (!Enabled()) return false;
+    std::lock_guard<std::mutex> lock(m_mtx);
+    auto it = m_slots.find(path);
+    if (it == m_slots.end() || it->second.expires <= now) return false;
+    out = it->second.target;
+    return true;
+}
+
+bool OpenVerifyRedirectCache::Invalidate(const std::string& path, const std::string& host, int port) {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    auto it = m_slots.find(path);
+    if (it == m_slots.end() || it->second.target.host != host || it->second.target.port != port) return false;
+    EraseLocked(it);
+    return true;
+}
+
+size_t OpenVerifyRedirectCache::Size() const {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    return m_slots.size();
+}
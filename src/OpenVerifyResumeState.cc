@@ -0,0 +1,54 @@
+#include "OpenVerifyResumeState.hh"
+
+#include <iterator>
+#include <utility>
+
+#include "OpenVerifyEnv.hh"
+
+OpenVerifyResumeState::OpenVerifyResumeState()
+    : m_capacity(static_cast<size_t>(ReadIntEnvOrDefault("XRD_OPENVERIFY_RESUME_MAX", 4096))),
+      m_ttl(std::chrono::seconds(ReadIntEnvOrDefault("XRD_OPENVERIFY_RESUME_TTL_S", 30))) {}
+
+std::string OpenVerifyResumeState::Key(const char* tident, const std::string& path) {
+    std::string key = tident ? tident : "";
+    key += '\n';
+    key += path;
+    return key;
+}
+
+void OpenVerifyResumeState::EraseLocked(std::unordered_map<std::string, Slot>::iterator it) {
+    m_order.erase(it->second.order);
+    m_slots.erase(it);
+}
+
+void OpenVerifyResumeState::Put(const std::string& key, Entry entry, std::chrono::seconds stall,
+                                Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    auto it = m_slots.find(key);
+    if (it != m_slots.end()) EraseLocked(it);
+
+    // Drop expired entries from the old end, then make room.
+    while (!m_order.empty()) {
+        auto oldest = m_slots.find(m_order.front());
+        if (oldest->second.expires > now && m_slots.size() < m_capacity) break;
+        EraseLocked(oldest);
+    }
+
+    m_order.push_back(key);
+    m_slots.emplace(key, Slot{std::move(entry), now + stall + m_ttl, std::prev(m_order.end())});
+}
+
+bool OpenVerifyResumeState::Take(const std::string& key, Entry& out, Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    auto it = m_slots.find(key);
+    if (it == m_slots.end()) return false;
+    const bool live = it->second.expires > now;
+    if (live) out = std::move(it->second.entry);
+    EraseLocked(it);
+    return live;
+}
+
+size_t OpenVerifyResumeState::Size() const {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    return m_slots.size();
+}
@@ -0,0 +1,72 @@
+#include "OpenVerifyRetryBudget.hh"
+
+#include <algorithm>
+
+#include "OpenVerifyEnv.hh"
+
+OpenVerifyRetryBudget::OpenVerifyRetryBudget(OpenVerifyMetrics& metrics)
+    : m_ratio(ReadIntEnvOrDefault("XRD_OPENVERIFY_RETRY_BUDGET_PERCENT", 20) / 100.0),
+      m_ttl_s(std::min<int64_t>(ReadIntEnvOrDefault("XRD_OPENVERIFY_RETRY_BUDGET_TTL_S", 10), kMaxWindowBuckets)),
+      m_reserve(static_cast<double>(ReadIntEnvOrDefault("XRD_OPENVERIFY_RETRY_BUDGET_MIN_PER_SEC", 10)) *
+                static_cast<double>(m_ttl_s)),
+      m_metrics(metrics) {
+    m_collector_id = m_metrics.AddCollector(
+        [this](std::ostream& out, const std::string& lbl) { WriteExposition(out, lbl); });
+}
+
+OpenVerifyRetryBudget::~OpenVerifyRetryBudget() { m_metrics.RemoveCollector(m_collector_id); }
+
+int64_t OpenVerifyRetryBudget::SecondOf(std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::seconds>(t.time_since_epoch()).count();
+}
+
+OpenVerifyRetryBudget::WindowBucket& OpenVerifyRetryBudget::BucketLocked(int64_t second) {
+    WindowBucket& b = m_window[static_cast<size_t>(second) % kMaxWindowBuckets];
+    if (b.second != second) b = WindowBucket{second, 0, 0};
+    return b;
+}
+
+double OpenVerifyRetryBudget::BalanceLocked(int64_t second) const {
+    uint64_t deposits = 0;
+    uint64_t withdrawals = 0;
+    for (const WindowBucket& b : m_window) {
+        if (b.second < 0 || b.second > second || second - b.second >= m_ttl_s) continue;
+        deposits += b.deposits;
+        withdrawals += b.withdrawals;
+    }
+    return m_reserve + m_ratio * static_cast<double>(deposits) - static_cast<double>(withdrawals);
+}
+
+void OpenVerifyRetryBudget::Deposit(std::chrono::steady_clock::time_point now) {
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        ++BucketLocked(SecondOf(now)).deposits;
+    }
+    m_metrics.RecordRetryBudgetDeposit();
+}
+
+bool OpenVerifyRetryBudget::TryWithdraw(std::chrono::steady_clock::time_point now) {
+    bool granted = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        const int64_t sec = SecondOf(now);
+        if (BalanceLocked(sec) >= 1.0) {
+            ++BucketLocked(sec).withdrawals;
+            granted = true;
+        }
+    }
+    m_metrics.RecordRetryBudgetWithdraw(granted);
+    return granted;
+}
+
+double OpenVerifyRetryBudget::Balance(std::chrono::steady_clock::time_point now) {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    return BalanceLocked(SecondOf(now));
+}
+
+void OpenVerifyRetryBudget::WriteExposition(std::ostream& out, const std::string& lbl) {
+    const std::string labels = lbl.empty() ? std::string() : lbl.substr(1);
+    OpenVerifyMetrics::WriteGauge(out, "xrootd_openverify_retry_budget_balance",
+                                  "Retries the shared retry budget can currently afford.", labels,
+                                  std::max(0.0, Balance()));
+}
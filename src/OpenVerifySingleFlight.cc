@@ -1,37 +1,410 @@
 #include "OpenVerifySingleFlight.hh"
 
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <memory>
+#include <vector>
+
+#include "OpenVerifyEnv.hh"
 
 namespace {
 
-int ReadIntEnvOrDefault(const char* name, int dflt) {
+bool EnvFlag(const char* name) {
     const char* p = std::getenv(name);
-    if (!p || !*p) return dflt;
-    const int v = std::atoi(p);
-    return v > 0 ? v : dflt;
+    return p && std::strcmp(p, "1") == 0;
+}
+
+OpenVerifyConcurrencyLimit::Options LimitOptionsFromEnv() {
+    OpenVerifyConcurrencyLimit::Options opts;
+    opts.adaptive = EnvFlag("XRD_OPENVERIFY_ADAPTIVE_LIMIT");
+    opts.initial = static_cast<size_t>(ReadIntEnvOrDefault("XRD_OPENVERIFY_MAX_INFLIGHT", 32));
+    if (opts.adaptive) {
+        opts.min = static_cast<size_t>(ReadIntEnvOrDefault("XRD_OPENVERIFY_INFLIGHT_MIN", 4));
+        opts.max = static_cast<size_t>(ReadIntEnvOrDefault("XRD_OPENVERIFY_INFLIGHT_MAX", 256));
+    } else {
+        opts.min = opts.max = opts.initial;
+    }
+    return opts;
+}
+
+// XRD_OPENVERIFY_FAIR_WEIGHTS: comma-separated class=weight pairs; malformed entries are skipped.
+std::unordered_map<std::string, size_t> ClassWeightsFromEnv() {
+    std::unordered_map<std::string, size_t> weights;
+    const char* p = std::getenv("XRD_OPENVERIFY_FAIR_WEIGHTS");
+    if (!p) return weights;
+    const std::string spec(p);
+    size_t start = 0;
+    while (start < spec.size()) {
+        size_t end = spec.find(',', start);
+        if (end == std::string::npos) end = spec.size();
+        const std::string item = spec.substr(start, end - start);
+        const size_t eq = item.find('=');
+        if (eq != std::string::npos && eq > 0) {
+            const int w = std::atoi(item.c_str() + eq + 1);
+            if (w > 0) weights[item.substr(0, eq)] = static_cast<size_t>(w);
+        }
+        start = end + 1;
+    }
+    return weights;
+}
+
+bool IsTimeout(const XrdCl::XRootDStatus& st) {
+    return !st.IsOK() && (st.code == XrdCl::errOperationExpired || st.code == XrdCl::errSocketTimeout);
 }
 
 }  // namespace
 
 OpenVerifySingleFlight::OpenVerifySingleFlight(OpenVerifyMetrics& metrics)
-    : m_main_limit(ReadIntEnvOrDefault("XRD_OPENVERIFY_MAX_INFLIGHT", 32)),
+    : m_limit(LimitOptionsFromEnv()),
       m_wait_limit(ReadIntEnvOrDefault("XRD_OPENVERIFY_MAX_WAITERS", 128)),
+      m_host_limit(static_cast<size_t>(ReadIntEnvOrDefault("XRD_OPENVERIFY_MAX_INFLIGHT_PER_HOST", 8))),
+      m_host_wait_limit(static_cast<size_t>(ReadIntEnvOrDefault("XRD_OPENVERIFY_MAX_WAITERS_PER_HOST", 32))),
       m_queue_timeout(std::chrono::milliseconds(ReadIntEnvOrDefault("XRD_OPENVERIFY_QUEUE_TIMEOUT_MS", 5000))),
-      m_metrics(metrics) {}
+      m_wait_timeout(std::chrono::milliseconds(ReadIntEnvOrDefault("XRD_OPENVERIFY_FOLLOWER_TIMEOUT_MS", 10000))),
+      m_codel(EnvFlag("XRD_OPENVERIFY_CODEL"),
+              std::chrono::milliseconds(ReadIntEnvOrDefault("XRD_OPENVERIFY_CODEL_TARGET_MS", 100)),
+              std::chrono::milliseconds(ReadIntEnvOrDefault("XRD_OPENVERIFY_CODEL_INTERVAL_MS", 1000))),
+      m_class_weights(ClassWeightsFromEnv()),
+      m_metrics(metrics) {
+    m_collector_id = m_metrics.AddCollector(
+        [this](std::ostream& out, const std::string& lbl) { WriteExposition(out, lbl); });
+}
+
+OpenVerifySingleFlight::~OpenVerifySingleFlight() {
+    Drain();
+    m_metrics.RemoveCollector(m_collector_id);
+}
+
+void OpenVerifySingleFlight::WriteExposition(std::ostream& out, const std::string& lbl) {
+    size_t active = 0;
+    size_t waiting = 0;
+    size_t limit = 0;
+    double noload_seconds = 0;
+    size_t hosts = 0;
+    size_t hosts_saturated = 0;
+    bool overloaded = false;
+    {
+        std::lock_guard<std::mutex> lk(m_fifo_mutex);
+        active = m_active;
+        waiting = m_waiting;
+        hosts = m_partitions.size();
+        overloaded = m_codel.Overloaded();
+        for (const auto& kv : m_partitions) {
+            if (kv.second->active >= m_host_limit) ++hosts_saturated;
+        }
+        limit = m_limit.Limit();
+        noload_seconds = std::chrono::duration<double>(m_limit.NoLoadLatency()).count();
+    }
+    size_t keys = 0;
+    size_t followers = 0;
+    size_t max_followers = 0;
+    {
+        std::lock_guard<std::mutex> lk(m_map_mutex);
+        keys = m_in_flight_map.size();
+        for (const auto& kv : m_in_flight_map) {
+            const size_t n = kv.second->followers.load(std::memory_order_relaxed);
+            followers += n;
+            max_followers = std::max(max_followers, n);
+        }
+    }
+
+    const std::string labels = lbl.empty() ? std::string() : lbl.substr(1);
+    OpenVerifyMetrics::WriteGauge(out, "xrootd_openverify_singleflight_active_leaders",
+                                  "Leaders admitted and currently running a verify.", labels,
+                                  static_cast<double>(active));
+    OpenVerifyMetrics::WriteGauge(out, "xrootd_openverify_singleflight_waiting_leaders",
+                                  "Leaders waiting in the per-host admission queues.", labels,
+                                  static_cast<double>(waiting));
+    OpenVerifyMetrics::WriteGauge(out, "xrootd_openverify_singleflight_hosts",
+                                  "Redirect targets with verify leaders queued or running.", labels,
+                                  static_cast<double>(hosts));
+    OpenVerifyMetrics::WriteGauge(out, "xrootd_openverify_singleflight_hosts_saturated",
+                                  "Redirect targets at their per-host in-flight cap.", labels,
+                                  static_cast<double>(hosts_saturated));
+    OpenVerifyMetrics::WriteGauge(out, "xrootd_openverify_singleflight_inflight_keys",
+                                  "Keys with a leader queued or running.", labels, static_cast<double>(keys));
+    OpenVerifyMetrics::WriteGauge(out, "xrootd_openverify_singleflight_waiting_followers",
+                                  "Followers blocked on an in-flight leader, all keys.", labels,
+                                  static_cast<double>(followers));
+    OpenVerifyMetrics::WriteGauge(out, "xrootd_openverify_singleflight_max_followers_per_key",
+                                  "Largest number of followers blocked on a single key.", labels,
+                                  static_cast<double>(max_followers));
+    OpenVerifyMetrics::WriteGauge(out, "xrootd_openverify_concurrency_limit",
+                                  "Current limit on concurrently running verify leaders.", labels,
+                                  static_cast<double>(limit));
+    if (m_codel.Enabled()) {
+        OpenVerifyMetrics::WriteGauge(out, "xrootd_openverify_queue_overloaded",
+                                      "1 while CoDel sees a standing admission queue (LIFO and shedding active).",
+                                      labels, overloaded ? 1.0 : 0.0);
+    }
+    if (m_limit.Adaptive()) {
+        OpenVerifyMetrics::WriteGauge(out, "xrootd_openverify_concurrency_noload_latency_seconds",
+                                      "No-load verify latency baseline used by the adaptive limit.", labels,
+                                      noload_seconds);
+    }
+}
+
+OpenVerifySingleFlight::HostPartition& OpenVerifySingleFlight::AcquirePartitionLocked(const std::string& partition) {
+    std::unique_ptr<HostPartition>& slot = m_partitions[partition];
+    if (!slot) slot = std::make_unique<HostPartition>();
+    ++slot->refs;
+    return *slot;
+}
+
+void OpenVerifySingleFlight::ReleasePartitionLocked(const std::string& partition, HostPartition& part) {
+    if (--part.refs == 0) m_partitions.erase(partition);
+}
+
+void OpenVerifySingleFlight::EnqueueLocked(FifoWaitTag& tag, const std::string& client_class,
+                                           const std::string& partition) {
+    std::unique_ptr<ClassQueue>& cls = m_classes[client_class];
+    if (!cls) {
+        cls = std::make_unique<ClassQueue>();
+        const auto w = m_class_weights.find(client_class);
+        cls->weight = w != m_class_weights.end() ? w->second : 1;
+    }
+    std::unique_ptr<HostQueue>& hq = cls->hosts[partition];
+    if (!hq) {
+        hq = std::make_unique<HostQueue>();
+        hq->cls = cls.get();
+        hq->host = tag.host;
+    }
+
+    tag.queue = hq.get();
+    tag.pos = hq->waiters.insert(hq->waiters.end(), &tag);
+    ++m_waiting;
+    ++cls->waiting;
+    ++tag.host->waiting;
+    if (!hq->in_ring) {
+        hq->in_ring = true;
+        cls->ring.push_back(hq.get());
+    }
+    if (!cls->in_ring) {
+        cls->in_ring = true;
+        m_class_ring.push_back(cls.get());
+    }
+}
+
+void OpenVerifySingleFlight::DetachLocked(FifoWaitTag& tag) {
+    HostQueue* hq = tag.queue;
+    ClassQueue* cls = hq->cls;
+    hq->waiters.erase(tag.pos);
+    tag.queue = nullptr;
+    --m_waiting;
+    --cls->waiting;
+    --tag.host->waiting;
+    if (hq->waiters.empty() && hq->in_ring) {
+        cls->ring.erase(std::find(cls->ring.begin(), cls->ring.end(), hq));
+        hq->in_ring = false;
+    }
+    if (cls->waiting == 0 && cls->in_ring) {
+        // DRR: an emptied class gives up its remaining deficit.
+        m_class_ring.erase(std::find(m_class_ring.begin(), m_class_ring.end(), cls));
+        cls->in_ring = false;
+        cls->deficit = 0;
+        cls->turn_open = false;
+    }
+}
+
+void OpenVerifySingleFlight::CollectIdleQueuesLocked() {
+    for (auto c = m_classes.begin(); c != m_classes.end();) {
+        ClassQueue& cls = *c->second;
+        if (cls.waiting == 0) {
+            c = m_classes.erase(c);
+            continue;
+        }
+        for (auto h = cls.hosts.begin(); h != cls.hosts.end();) {
+            h = h->second->waiters.empty() ? cls.hosts.erase(h) : std::next(h);
+        }
+        ++c;
+    }
+}
+
+bool OpenVerifySingleFlight::EvictForLocked(const std::string& client_class) {
+    ClassQueue* longest = nullptr;
+    for (const auto& kv : m_classes) {
+        if (!longest || kv.second->waiting > longest->waiting) longest = kv.second.get();
+    }
+    const auto own = m_classes.find(client_class);
+    const size_t own_waiting = own != m_classes.end() ? own->second->waiting : 0;
+    if (!longest || (own != m_classes.end() && longest == own->second.get()) || longest->waiting <= own_waiting + 1) {
+        return false;
+    }
+
+    FifoWaitTag* newest = nullptr;
+    for (HostQueue* hq : longest->ring) {
+        FifoWaitTag* t = hq->waiters.back();
+        if (!newest || t->queued_at > newest->queued_at) newest = t;
+    }
+    DetachLocked(*newest);
+    newest->outcome = FifoWaitTag::Outcome::Evicted;
+    newest->cv.notify_one();
+    return true;
+}
+
+OpenVerifySingleFlight::HostQueue* OpenVerifySingleFlight::NextHostLocked(ClassQueue& cls) {
+    for (size_t n = 0; n < cls.ring.size(); ++n) {
+        HostQueue* hq = cls.ring.front();
+        cls.ring.pop_front();
+        cls.ring.push_back(hq);
+        if (hq->host->active < m_host_limit) return hq;
+    }
+    return nullptr;
+}
+
+void OpenVerifySingleFlight::DispatchLocked() {
+    const auto now = std::chrono::steady_clock::now();
+    m_codel.Tick(now);
+    const bool overloaded = m_codel.Overloaded();
+    if (overloaded) {
+        // Each host queue is ordered by arrival, so stale waiters sit at the front.
+        std::vector<FifoWaitTag*> stale;
+        for (ClassQueue* cls : m_class_ring) {
+            for (HostQueue* hq : cls->ring) {
+                for (FifoWaitTag* t : hq->waiters) {
+                    if (!m_codel.ShouldShed(now - t->queued_at)) break;
+                    stale.push_back(t);
+                }
+            }
+        }
+        for (FifoWaitTag* t : stale) {
+            DetachLocked(*t);
+            t->outcome = FifoWaitTag::Outcome::Shed;
+            t->cv.notify_one();
+        }
+    }
+
+    // Deficit round robin over classes: a class's turn earns `weight` admissions, spent
+    // round-robin over its hosts. Within a host queue the oldest waiter goes first, the newest
+    // under overload (adaptive LIFO). CoDel is fed the sojourn of the oldest waiter in the queue
+    // either way, so that serving the newest does not hide the standing queue behind it and flip
+    // the overload verdict back off. A class whose hosts are all at their cap forfeits the rest
+    // of its turn; stop once a full pass over the classes admitted nothing. When global capacity
+    // runs out mid-turn the class stays at the front and resumes its turn next time.
+    size_t blocked = 0;
+    while (m_active < m_limit.Limit() && !m_class_ring.empty() && blocked < m_class_ring.size()) {
+        ClassQueue* cls = m_class_ring.front();
+        if (!cls->turn_open) {
+            cls->deficit += cls->weight;
+            cls->turn_open = true;
+        }
+        bool admitted = false;
+        while (cls->in_ring && cls->deficit > 0 && m_active < m_limit.Limit()) {
+            HostQueue* hq = NextHostLocked(*cls);
+            if (!hq) break;
+            FifoWaitTag* next = overloaded ? hq->waiters.back() : hq->waiters.front();
+            const auto sojourn = now - hq->waiters.front()->queued_at;
+            --cls->deficit;
+            DetachLocked(*next);
+            ++next->host->active;
+            ++m_active;
+            m_codel.OnAdmit(sojourn, now);
+            next->outcome = FifoWaitTag::Outcome::Admitted;
+            next->cv.notify_one();
+            admitted = true;
+        }
+        if (!cls->in_ring) {
+            blocked = 0;  // drained; DetachLocked already took it out of the ring
+            continue;
+        }
+        if (cls->deficit > 0 && m_active >= m_limit.Limit()) break;
+
+        cls->turn_open = false;
+        cls->deficit = 0;
+        m_class_ring.pop_front();
+        m_class_ring.push_back(cls);
+        blocked = admitted ? 0 : blocked + 1;
+    }
+    CollectIdleQueuesLocked();
+}
 
-XrdCl::XRootDStatus OpenVerifySingleFlight::Run(const std::string& key, const std::function<XrdCl::XRootDStatus()>& fn) {
+XrdCl::XRootDStatus OpenVerifySingleFlight::Run(const std::string& key, const std::string& partition,
+                                                const std::function<XrdCl::XRootDStatus()>& fn) {
+    return Run(key, partition, std::string(), fn);
+}
+
+XrdCl::XRootDStatus OpenVerifySingleFlight::Run(const std::string& key, const std::string& partition,
+                                                const std::string& client_class,
+                                                const std::function<XrdCl::XRootDStatus()>& fn) {
+    return Run(key, partition, client_class, std::chrono::steady_clock::time_point::max(), fn);
+}
+
+std::chrono::steady_clock::time_point OpenVerifySingleFlight::VerifyDeadline(const std::string& key) const {
+    std::lock_guard<std::mutex> lk(m_map_mutex);
+    const auto it = m_in_flight_map.find(key);
+    return it == m_in_flight_map.end() ? std::chrono::steady_clock::time_point::max() : it->second->verify_deadline;
+}
+
+bool OpenVerifySingleFlight::IsWaitExpired(const XrdCl::XRootDStatus& st) {
+    if (st.IsOK()) return false;
+    const std::string msg = st.GetErrorMessage();
+    return msg == "openverify_follower_timeout" || msg == "openverify_leader_timeout" ||
+           msg == "openverify_deadline_exceeded";
+}
+
+bool OpenVerifySingleFlight::IsOverloaded(const XrdCl::XRootDStatus& st) {
+    if (st.IsOK()) return false;
+    const std::string msg = st.GetErrorMessage();
+    return msg == "openverify_queue_full" || msg == "openverify_queue_timeout" || msg == "openverify_queue_shed";
+}
+
+XrdCl::XRootDStatus OpenVerifySingleFlight::Run(const std::string& key, const std::string& partition,
+                                                const std::string& client_class,
+                                                std::chrono::steady_clock::time_point deadline,
+                                                const std::function<XrdCl::XRootDStatus()>& fn) {
+    // `fn` reports before the leader starts waiting, so the leader always gets its own result.
+    return RunDetached(key, partition, client_class, deadline, [&fn](const Done& done) {
+        XrdCl::XRootDStatus result;
+        try {
+            result = fn ? fn() : XrdCl::XRootDStatus{XrdCl::stError, XrdCl::errInvalidOp, 0, "openverify_noop"};
+        } catch (...) {
+            result = XrdCl::XRootDStatus{XrdCl::stError, XrdCl::errInternal, 0, "openverify_exception"};
+        }
+        done(result);
+    });
+}
+
+void OpenVerifySingleFlight::Publish(const std::string& key, const std::shared_ptr<InFlight>& in_flight,
+                                     const XrdCl::XRootDStatus& result) {
+    {
+        std::lock_guard<std::mutex> lk(in_flight->mtx);
+        in_flight->result = result;
+        in_flight->done = true;
+    }
+    in_flight->cv.notify_all();
+    std::lock_guard<std::mutex> erase_lock(m_map_mutex);
+    auto it = m_in_flight_map.find(key);
+    if (it != m_in_flight_map.end() && it->second == in_flight) {
+        m_in_flight_map.erase(it);
+    }
+}
+
+void OpenVerifySingleFlight::Drain() {
+    std::unique_lock<std::mutex> lk(m_drain_mutex);
+    m_drain_cv.wait(lk, [this] { return m_running == 0; });
+}
+
+XrdCl::XRootDStatus OpenVerifySingleFlight::RunDetached(const std::string& key, const std::string& partition,
+                                                        const std::string& client_class,
+                                                        std::chrono::steady_clock::time_point deadline,
+                                                        const std::function<void(Done)>& start) {
     std::shared_ptr<InFlight> in_flight;
     bool leader = false;
+    const auto arrival = std::chrono::steady_clock::now();
+    const auto wait_deadline = std::min(arrival + m_wait_timeout, deadline);
     {
         std::lock_guard<std::mutex> map_lock(m_map_mutex);
         auto existing = m_in_flight_map.find(key);
         if (existing == m_in_flight_map.end()) {
             in_flight = std::make_shared<InFlight>();
+            in_flight->verify_deadline = wait_deadline;
             m_in_flight_map.emplace(key, in_flight);
             leader = true;
         } else {
             in_flight = existing->second;
+            in_flight->followers.fetch_add(1, std::memory_order_relaxed);
+            in_flight->verify_deadline = std::max(in_flight->verify_deadline, wait_deadline);
         }
     }
 
@@ -40,85 +413,136 @@ XrdCl::XRootDStatus OpenVerifySingleFlight::Run(const std::string& key, const st
         // helper to signal followers with requests for the same key to stop waiting
         // and erase the key from map
         auto finish_leader = [&](XrdCl::XRootDStatus result) -> XrdCl::XRootDStatus {
-            {
-                std::lock_guard<std::mutex> lk(in_flight->mtx);
-                in_flight->result = result;
-                in_flight->done = true;
-            }
-            in_flight->cv.notify_all();
-            std::lock_guard<std::mutex> erase_lock(m_map_mutex);
-            auto it = m_in_flight_map.find(key);
-            if (it != m_in_flight_map.end() && it->second == in_flight) {
-                m_in_flight_map.erase(it);
-            }
+            Publish(key, in_flight, result);
             return result;
         };
 
-        // total number of requests allowed to run concurrently
-        const size_t cap = static_cast<size_t>(m_main_limit);
-        // total number of requets in the wait queue
+        // total number of requets in the wait queues
         const size_t wait_cap = static_cast<size_t>(m_wait_limit);
 
-        std::unique_lock<std::mutex> fifo_lock(m_fifo_mutex);
-        if (m_fifo.size() >= wait_cap) {
-            fifo_lock.unlock();
+        const auto queued_at = std::chrono::steady_clock::now();
+        auto observe_wait = [&]() {
+            const auto waited = std::chrono::steady_clock::now() - queued_at;
+            m_metrics.ObserveQueueWait(waited);
+            if (!client_class.empty()) m_metrics.ObserveClassQueueWait(client_class, waited);
+        };
+        auto queue_full = [&]() {
             m_metrics.RecordQueueAdmissionFull();
             return finish_leader(
                 XrdCl::XRootDStatus{XrdCl::stError, XrdCl::errThresholdExceeded, 0, "openverify_queue_full"});
+        };
+
+        std::unique_lock<std::mutex> fifo_lock(m_fifo_mutex);
+        HostPartition& part = AcquirePartitionLocked(partition);
+        // Under overload, shed stale waiters first so they do not hold queue places against us.
+        m_codel.Tick(queued_at);
+        if (m_codel.Overloaded()) DispatchLocked();
+        if (part.waiting >= m_host_wait_limit || (m_waiting >= wait_cap && !EvictForLocked(client_class))) {
+            ReleasePartitionLocked(partition, part);
+            fifo_lock.unlock();
+            return queue_full();
         }
 
-        // get a ticket to wait and push to the fifo queue
+        // get a ticket in the class's queue for this host; the dispatcher admits it when the
+        // global limit, the host cap and the class's fair share allow (immediately, if idle)
         FifoWaitTag tag;
-        m_fifo.push_back(&tag);
-        const auto my_it = std::prev(m_fifo.end());
-        const auto deadline = std::chrono::steady_clock::now() + m_queue_timeout;
-
-        // wait_until checks the predicate before blocking
-        // so the first requets always go through without waiting
-        const bool admitted = tag.cv.wait_until(fifo_lock, deadline, [&] {
-            return m_fifo.front() == &tag && m_active < cap;
-        });
-
-        if (!admitted) {
-            // Timed out: erase self from the queue. If we were at the front, wake the
-            // new head so it can check whether a slot is now available.
-            const bool was_front = (my_it == m_fifo.begin());
-            m_fifo.erase(my_it);
-            if (was_front && !m_fifo.empty())
-                m_fifo.front()->cv.notify_one();
-            fifo_lock.unlock();
-            m_metrics.RecordQueueAdmissionTimeout();
-            return finish_leader(
-                XrdCl::XRootDStatus{XrdCl::stError, XrdCl::errOperationExpired, 0, "openverify_queue_timeout"});
+        tag.queued_at = queued_at;
+        tag.host = &part;
+        EnqueueLocked(tag, client_class, partition);
+        DispatchLocked();
+
+        const auto queue_deadline = std::min(queued_at + m_queue_timeout, deadline);
+        tag.cv.wait_until(fifo_lock, queue_deadline, [&] { return tag.outcome != FifoWaitTag::Outcome::Waiting; });
+
+        switch (tag.outcome) {
+            case FifoWaitTag::Outcome::Admitted:
+                break;
+            case FifoWaitTag::Outcome::Evicted:
+                // Pushed out of a full backlog by a less-served class.
+                ReleasePartitionLocked(partition, part);
+                fifo_lock.unlock();
+                observe_wait();
+                return queue_full();
+            case FifoWaitTag::Outcome::Shed:
+                // Dropped by CoDel; the dispatcher already took us out of the queues.
+                ReleasePartitionLocked(partition, part);
+                fifo_lock.unlock();
+                observe_wait();
+                m_metrics.RecordQueueAdmissionShed();
+                return finish_leader(
+                    XrdCl::XRootDStatus{XrdCl::stError, XrdCl::errOperationExpired, 0, "openverify_queue_shed"});
+            case FifoWaitTag::Outcome::Waiting:
+                // Timed out: leave the queues.
+                DetachLocked(tag);
+                CollectIdleQueuesLocked();
+                ReleasePartitionLocked(partition, part);
+                fifo_lock.unlock();
+                observe_wait();
+                m_metrics.RecordQueueAdmissionTimeout();
+                return finish_leader(
+                    XrdCl::XRootDStatus{XrdCl::stError, XrdCl::errOperationExpired, 0, "openverify_queue_timeout"});
         }
 
-        m_fifo.pop_front();
-        ++m_active;
-        // If capacity remains, wake the new head immediately
-        if (!m_fifo.empty() && m_active < cap)
-            m_fifo.front()->cv.notify_one();
+        const size_t started_inflight = m_active;
         fifo_lock.unlock();
+        observe_wait();
         m_metrics.RecordQueueAdmissionAdmitted();
 
-        XrdCl::XRootDStatus result;
+        {
+            std::lock_guard<std::mutex> lk(m_drain_mutex);
+            ++m_running;
+        }
+        // Everything `done` needs is copied: it may run after this call has returned.
+        const auto run_start = std::chrono::steady_clock::now();
+        auto called = std::make_shared<std::atomic<bool>>(false);
+        const Done done = [this, key, partition, host = &part, in_flight, started_inflight, run_start,
+                           called](const XrdCl::XRootDStatus& result) {
+            if (called->exchange(true)) return;
+            const auto run_end = std::chrono::steady_clock::now();
+            {
+                std::lock_guard<std::mutex> lk(m_fifo_mutex);
+                --m_active;
+                --host->active;
+                // A verify cut short says nothing about how long it would have taken, and a timeout
+                // is its host's trouble: the partition cap and the host breaker deal with that, while
+                // the global limit would shrink for every host.
+                if (!IsWaitExpired(result) && !IsTimeout(result)) {
+                    m_limit.OnSample(run_end - run_start, started_inflight, run_end);
+                }
+                DispatchLocked();
+                ReleasePartitionLocked(partition, *host);
+            }
+            Publish(key, in_flight, result);
+            // Notified under the lock: Drain() cannot return while this still touches *this.
+            std::lock_guard<std::mutex> lk(m_drain_mutex);
+            if (--m_running == 0) m_drain_cv.notify_all();
+        };
         try {
-            result = fn ? fn() : XrdCl::XRootDStatus{XrdCl::stError, XrdCl::errInvalidOp, 0, "openverify_noop"};
+            start(done);
         } catch (...) {
-            result = XrdCl::XRootDStatus{XrdCl::stError, XrdCl::errInternal, 0, "openverify_exception"};
+            done(XrdCl::XRootDStatus{XrdCl::stError, XrdCl::errInternal, 0, "openverify_exception"});
         }
 
-        {
-            std::lock_guard<std::mutex> lk(m_fifo_mutex);
-            --m_active;
-            if (!m_fifo.empty())
-                m_fifo.front()->cv.notify_one();
+        // Wait for the verify as a follower would; the verify itself runs on to VerifyDeadline().
+        std::unique_lock<std::mutex> lk(in_flight->mtx);
+        if (in_flight->cv.wait_until(lk, wait_deadline, [&in_flight] { return in_flight->done; })) {
+            return in_flight->result;
         }
-
-        return finish_leader(result);
+        lk.unlock();
+        m_metrics.RecordSingleFlightTimeout(/*leader=*/true);
+        return XrdCl::XRootDStatus{XrdCl::stError, XrdCl::errOperationExpired, 0, "openverify_leader_timeout"};
     }
     m_metrics.RecordSingleFlightFollower();
 
+    const auto wait_start = std::chrono::steady_clock::now();
     std::unique_lock<std::mutex> lk(in_flight->mtx);
-    in_flight->cv.wait(lk, [&in_flight] { return in_flight->done; });
-    return in_flight->result;
+    const bool done = in_flight->cv.wait_until(lk, wait_deadline, [&in_flight] { return in_flight->done; });
+    XrdCl::XRootDStatus result =
+        done ? in_flight->result
+             : XrdCl::XRootDStatus{XrdCl::stError, XrdCl::errOperationExpired, 0, "openverify_follower_timeout"};
+    lk.unlock();
+    in_flight->followers.fetch_sub(1, std::memory_order_relaxed);
+    m_metrics.ObserveFollowerWait(std::chrono::steady_clock::now() - wait_start);
+    if (!done) m_metrics.RecordSingleFlightTimeout(/*leader=*/false);
+    return result;
 }
@@ -1,9 +1,17 @@
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
 #include <chrono>
 #include <cstdlib>
+#include <cstring>
+#include <memory>
 #include <random>
 #include <string>
+#include <string_view>
+#include <utility>
 
 #include "OpenVerifyCacheKey.hh"
+#include "OpenVerifyEnv.hh"
 #include "XrdOfsOpenVerify.hh"
 #include "XrdSfs/XrdSfsInterface.hh"
 
@@ -26,11 +34,117 @@ bool ShouldBypassOpenVerify(const XrdSfsFileOpenMode openMode) {
     return writeAccess || createOrTruncate;
 }
 
-time_t OpenVerifyTimeoutSeconds() {
-    const char* p = std::getenv("XRD_OPENVERIFY_VERIFY_TIMEOUT");
-    if (!p || !*p) return 5;
-    const long long v = std::strtoll(p, nullptr, 10);
-    return v > 0 ? static_cast<time_t>(v) : static_cast<time_t>(5);
+time_t OpenVerifyTimeoutSeconds() { return ReadIntEnvOrDefault("XRD_OPENVERIFY_VERIFY_TIMEOUT", 5); }
+
+// Time OpenVerifyFile::open may spend on verifies, queueing, stalls and retries before it returns
+// its best answer: XRD_OPENVERIFY_OPEN_DEADLINE_MS (default 20000). A client may announce its own
+// request timeout as opaque openverify.timeout=<seconds>; the budget is then at most three
+// quarters of it, leaving the client time to act on the answer.
+std::chrono::milliseconds OpenDeadlineBudget(const OpenVerifyOpaque& opaque) {
+    static const long configured = ReadIntEnvOrDefault("XRD_OPENVERIFY_OPEN_DEADLINE_MS", 20000);
+    long budget = configured;
+    const std::string_view client = opaque.Find("openverify.timeout");
+    long secs = 0;
+    std::from_chars(client.data(), client.data() + client.size(), secs);
+    // Clamped before scaling: the client's value is untrusted and secs * 750 could overflow.
+    if (secs > 0) budget = std::min(budget, std::min(secs, budget / 750 + 1) * 750);
+    return std::chrono::milliseconds(budget);
+}
+
+using DegradeAction = OpenVerifyMetrics::DegradeAction;
+
+// Degrade action named by environment variable `name`: "open" (also "unverified") returns the
+// redirect unverified, "stall" asks the client to come back after XRD_OPENVERIFY_STALL_SECONDS,
+// "fail" fails the open with EBUSY. Anything else falls back to "open".
+DegradeAction DegradeActionFromEnv(const char* name) {
+    const char* p = std::getenv(name);
+    if (p && std::strcmp(p, "stall") == 0) return DegradeAction::Stall;
+    if (p && std::strcmp(p, "fail") == 0) return DegradeAction::Fail;
+    return DegradeAction::Open;
+}
+
+// XRD_OPENVERIFY_OVERLOAD_ACTION: admission refused (queue full, timed out or shed).
+DegradeAction OverloadAction() {
+    static const DegradeAction action = DegradeActionFromEnv("XRD_OPENVERIFY_OVERLOAD_ACTION");
+    return action;
+}
+
+// XRD_OPENVERIFY_FOLLOWER_TIMEOUT_ACTION: gave up waiting on a verify already in flight.
+DegradeAction WaitExpiredAction() {
+    static const DegradeAction action = DegradeActionFromEnv("XRD_OPENVERIFY_FOLLOWER_TIMEOUT_ACTION");
+    return action;
+}
+
+int StallSeconds() {
+    static const int secs = ReadIntEnvOrDefault("XRD_OPENVERIFY_STALL_SECONDS", 5);
+    return secs;
+}
+
+// Return code for an open that could not be verified; `redirect_rc` is the wrapped redirect.
+int Degrade(DegradeAction action, XrdOucErrInfo& err, int redirect_rc) {
+    switch (action) {
+        case DegradeAction::Stall:
+            err.setErrInfo(0, "");
+            return StallSeconds();
+        case DegradeAction::Fail:
+            err.setErrInfo(EBUSY, "open verification unavailable; try again later");
+            return SFS_ERROR;
+        case DegradeAction::Open:
+            break;
+    }
+    return redirect_rc;
+}
+
+enum class FairKey { None, Vo, Role, User };
+
+// XRD_OPENVERIFY_FAIR_KEY: vo | role | user; anything else disables fair queuing by client.
+FairKey FairKeyFromEnv() {
+    static const FairKey key = [] {
+        const char* p = std::getenv("XRD_OPENVERIFY_FAIR_KEY");
+        if (!p) return FairKey::None;
+        if (std::strcmp(p, "vo") == 0) return FairKey::Vo;
+        if (std::strcmp(p, "role") == 0) return FairKey::Role;
+        if (std::strcmp(p, "user") == 0) return FairKey::User;
+        return FairKey::None;
+    }();
+    return key;
+}
+
+// First entry of a space-separated XrdSecEntity list (vorg and role may carry several).
+std::string FirstToken(const char* list) {
+    if (!list) return std::string();
+    const char* begin = list;
+    while (*begin == ' ') ++begin;
+    const char* end = begin;
+    while (*end && *end != ' ') ++end;
+    return std::string(begin, end);
+}
+
+// Fair-queuing class of the client: its (primary) VO, VO/role or user name. Clients without
+// the attribute share the "unknown" class; empty when fair queuing is off.
+std::string ClientClass(const XrdSecEntity* client) {
+    const FairKey key = FairKeyFromEnv();
+    if (key == FairKey::None) return std::string();
+    std::string cls;
+    if (client) {
+        switch (key) {
+            case FairKey::Vo:
+                cls = FirstToken(client->vorg);
+                break;
+            case FairKey::Role: {
+                const std::string vo = FirstToken(client->vorg);
+                const std::string role = FirstToken(client->role);
+                cls = role.empty() ? vo : vo + "/" + role;
+                break;
+            }
+            case FairKey::User:
+                cls = client->name ? client->name : "";
+                break;
+            case FairKey::None:
+                break;
+        }
+    }
+    return cls.empty() ? std::string("unknown") : cls;
 }
 
 // Returns base_s ± (fraction * base_s)
@@ -43,9 +157,12 @@ std::chrono::seconds JitteredNegativeTTL(int base_s, float fraction = 0.2f) {
 
 }  // namespace
 
-OpenVerifyFile::OpenVerifyFile(XrdSfsFile* wrapF, XrdSysError& log, OpenVerifyCache& cache, OpenVerifyMetrics& metrics,
-                               OpenVerifySingleFlight& single_flight, OpenVerifyHostReliability& host_reliability,
-                               bool observe)
+OpenVerifyFile::OpenVerifyFile(XrdSfsFile* wrapF, OpenVerifyLog& log, OpenVerifyCache& cache,
+                               OpenVerifyMetrics& metrics, OpenVerifySingleFlight& single_flight,
+                               OpenVerifyHostReliability& host_reliability, OpenVerifyRetryBudget& retry_budget,
+                               OpenVerifyResumeState& resume_state, OpenVerifyRedirectCache& redirect_cache,
+                               OpenVerifyIoTrace& io_trace, OpenVerifyOpenTrace& open_trace,
+                               OpenVerifyExecutor& executor, bool observe)
     : XrdSfsFile(wrapF->error),
       m_wrapped(wrapF),
       m_log(log),
@@ -53,131 +170,283 @@ OpenVerifyFile::OpenVerifyFile(XrdSfsFile* wrapF, XrdSysError& log, OpenVerifyCa
       m_metrics(metrics),
       m_single_flight(single_flight),
       m_host_reliability(host_reliability),
+      m_retry_budget(retry_budget),
+      m_resume_state(resume_state),
+      m_redirect_cache(redirect_cache),
+      m_io_trace(io_trace),
+      m_open_trace(open_trace),
+      m_executor(executor),
       m_observe(observe) {}
 
-OpenVerifyFile::~OpenVerifyFile() { m_log.Emsg(" INFO", "FileWrapper::~FileWrapper"); }
+OpenVerifyFile::~OpenVerifyFile() { m_log.Debug("FileWrapper::~FileWrapper"); }
 
 int OpenVerifyFile::open(const char* fileName, XrdSfsFileOpenMode openMode, mode_t createMode,
                          const XrdSecEntity* client, const char* opaque) {
-    m_log.Emsg(" INFO", "FileWrapper::open");
+    m_log.Debug("FileWrapper::open");
 
     // PUT/CREATE-style requests should not go through open-verify.
     if (ShouldBypassOpenVerify(openMode)) {
-        m_log.Emsg(" INFO", "Skipping open-verify for write/create open mode");
+        m_log.Info("Skipping open-verify for write/create open mode");
         return m_wrapped->open(fileName, openMode, createMode, client, opaque);
     }
 
+    // Split once; the deadline, redirect cache, tried= injection and verify URL all read this.
+    const OpenVerifyOpaque client_opaque(opaque);
+
+    const auto open_start = std::chrono::steady_clock::now();
+    const auto deadline = open_start + OpenDeadlineBudget(client_opaque);
+    const auto out_of_time = [&]() { return std::chrono::steady_clock::now() >= deadline; };
     int rc = 0;
     std::string tried_hosts;
     int retry_count{0};
     const int max_retries = m_observe ? 1 : 3;
     bool retry = true;
+    // Re-asking the redirector is paid for from the shared retry budget; once it is spent,
+    // the client gets the answer we already have (redirect or stall).
+    const auto retry_allowed = [&]() {
+        if (m_retry_budget.TryWithdraw()) return true;
+        m_log.Warn("openverify retry budget exhausted for", fileName ? fileName : "");
+        return false;
+    };
+    const std::string pathStr = fileName ? fileName : "";
+    // Per-open trace (XRD_OPENVERIFY_TRACE_PATH); every call on it is a branch while tracing is off.
+    OpenVerifyOpenTrace::Span span(m_open_trace, pathStr);
+
+    // A retry after a stall we handed back picks up the stalled open's tried hosts and attempts.
+    const std::string resume_key = OpenVerifyResumeState::Key(client ? client->tident : nullptr, pathStr);
+    OpenVerifyResumeState::Entry resumed;
+    const bool was_resumed = m_resume_state.Take(resume_key, resumed);
+    if (was_resumed) {
+        tried_hosts = std::move(resumed.tried_hosts);
+        retry_count = std::min(resumed.attempts, max_retries - 1);
+        m_metrics.RecordStallResumed();
+        m_log.Info("openverify resuming stalled open for", pathStr);
+        span.Resumed();
+    }
+
+    // Hot files: redirect to the path's last verified target without asking the wrapped OFS,
+    // while that host is healthy and its verify is still cached positive. Resumed opens and
+    // clients excluding hosts with tried= need the redirector's choice.
+    OpenVerifyRedirectCache::Target cached_target;
+    if (!m_observe && !was_resumed && client_opaque.Find("tried").empty() &&
+        m_redirect_cache.Get(pathStr, cached_target)) {
+        const std::string host = NormalizeHostForXrdCl(cached_target.host);
+        const int port = (cached_target.port >= 0) ? cached_target.port : -1;
+        if (m_host_reliability.State(host, port) == OpenVerifyHostReliability::BreakerState::Closed &&
+            m_cache.Get(MakeOpenVerifyCacheKey(pathStr, host, port)) == OpenVerifyCache::Status::Positive) {
+            m_metrics.RecordRedirectCacheHit();
+            m_log.Info("openverify redirect cache hit for", pathStr);
+            error.setErrInfo(cached_target.port, cached_target.host.c_str());
+            if (span.Active()) {
+                span.RedirectCacheHit(port < 0 ? host : host + ":" + std::to_string(port));
+            }
+            m_metrics.ObserveOpen(std::chrono::steady_clock::now() - open_start);
+            span.Finish(SFS_REDIRECT, tried_hosts);
+            return SFS_REDIRECT;
+        }
+        if (m_redirect_cache.Invalidate(pathStr, cached_target.host, cached_target.port)) {
+            m_metrics.RecordRedirectCacheInvalidated();
+        }
+    }
+
+    // A resumed open is the client coming back after our stall, not new demand: it must not
+    // fund more retries, or every stall would refill the budget it is meant to bound.
+    if (!was_resumed) m_retry_budget.Deposit();
+    bool paid = true;
+    // Redirector opaque with tried_hosts merged in, and the tried_hosts length it was built for.
+    std::string opaque_str;
+    size_t opaque_tried_len = 0;
+    const std::string no_tried_hosts;
 
     while (retry && retry_count < max_retries) {
+        if (!paid && out_of_time()) {
+            m_metrics.RecordOpenDeadlineExceeded();
+            break;
+        }
+        if (!paid && !retry_allowed()) break;
+        paid = false;
+
         // if max_retries exhausts and open_verify fail on all of them
         // currently we return the last redirect, thus only performing a best effort verify
         // another approach is we change this and return SFS_ERROR instead
 
-        std::string opaque_str = opaque ? opaque : "";
         // Observe mode: never append plugin tried_hosts; client opaque (including any client tried=) is unchanged.
+        // The opaque is only rebuilt when tried_hosts has grown since the previous attempt.
+        const char* open_opaque = opaque;
         if (!m_observe && !tried_hosts.empty()) {
-            if (opaque_str.empty()) {
-                opaque_str = "tried=" + tried_hosts;
-            } else {
-                size_t tried_pos = opaque_str.find("tried=");
-                if (tried_pos != std::string::npos) {
-                    size_t end_pos = opaque_str.find('&', tried_pos);
-                    if (end_pos == std::string::npos) {
-                        opaque_str += "," + tried_hosts;
-                    } else {
-                        opaque_str.insert(end_pos, "," + tried_hosts);
-                    }
-                } else {
-                    opaque_str += "&tried=" + tried_hosts;
-                }
+            if (opaque_tried_len != tried_hosts.size()) {
+                opaque_str.clear();
+                opaque_str.reserve(client_opaque.SizeWithTried(tried_hosts));
+                client_opaque.AppendWithTried(opaque_str, tried_hosts);
+                opaque_tried_len = tried_hosts.size();
             }
+            open_opaque = opaque_str.c_str();
         }
 
-        m_log.Emsg("INFO", "Retrying with opaque = ", opaque_str.c_str());
-
-        rc = m_wrapped->open(fileName, openMode, createMode, client, opaque_str.c_str());
-        m_log.Emsg("INFO", "returned from open with rc =", std::to_string(rc).c_str(), "\n");
-
-        if (rc > 0){
-            // sleep for rc seconds and try again
-            sleep(rc);
-            m_log.Emsg("INFO", "slept for rc seconds; retrying \n");
-            continue;
+        m_log.Info("Retrying with opaque =", open_opaque ? open_opaque : "");
+
+        const auto attempt_start = span.Now();
+        rc = m_wrapped->open(fileName, openMode, createMode, client, open_opaque);
+        m_log.Info("returned from open with rc =", rc);
+        const auto attempt_time = span.Now() - attempt_start;
+        if (rc != SFS_REDIRECT) span.Attempt(rc, attempt_time, {});
+
+        if (rc > 0) {
+            // Stall: never sleep on the server thread. The client waits rc seconds and reopens;
+            // its retry resumes from the state saved here.
+            m_resume_state.Put(resume_key, {tried_hosts, retry_count}, std::chrono::seconds(rc));
+            m_metrics.RecordStallReturned();
+            m_log.Info("returning stall to client for", pathStr);
+            break;
         }
         retry_count++;
 
         if (rc != SFS_REDIRECT) break;
+        if (out_of_time()) {
+            // No time left to verify: return the redirect as is.
+            m_metrics.RecordOpenDeadlineExceeded();
+            break;
+        }
 
         int port;
         const char* host = m_wrapped->error.getErrText(port);
-        std::string hostStr = host ? host : "";
-        hostStr = NormalizeHostForXrdCl(hostStr);
+        const std::string redirectHost = host ? host : "";
+        const std::string hostStr = NormalizeHostForXrdCl(redirectHost);
         const int portVal = (port >= 0) ? port : -1;
 
         const std::string hostPort = (port < 0) ? hostStr : (hostStr + ":" + std::to_string(port));
-        m_log.Emsg(" INFO", "redirecting to", hostPort.c_str());
+        m_log.Info("redirecting to", hostPort);
+        span.Attempt(rc, attempt_time, hostPort);
 
-        // Decide if the host should be added to the tried list 
-        // based on past error patterns
-        if (!m_observe && m_host_reliability.AvoidSite(hostStr, portVal)) {
+        // Decide if the host should be added to the tried list
+        // based on past error patterns. Observe mode still asks, since AvoidSite is what moves
+        // an open breaker to half-open, but never acts on the answer.
+        if (m_host_reliability.AvoidSite(hostStr, portVal) && !m_observe) {
             tried_hosts = tried_hosts.empty() ? hostPort : tried_hosts + "," + hostPort;
-            m_log.Emsg(" WARN", "skipping unhealthy host:", hostPort.c_str());
+            m_log.Warn("skipping unhealthy host:", hostPort);
+            span.Avoided(hostPort);
             continue;
         }
 
-        const std::string pathStr = fileName ? fileName : "";
         const auto key = MakeOpenVerifyCacheKey(pathStr, hostStr, portVal);
         const auto cached = m_cache.Get(key);
 
-        const char* verify_opaque = m_observe ? opaque : opaque_str.c_str();
+        // The verify sees the same opaque as the redirector (the client's alone in observe mode).
+        const std::string& verify_tried = m_observe ? no_tried_hosts : tried_hosts;
+        // A verify verdict on this host also updates the path's redirect cache entry.
+        const auto remember_target = [&]() {
+            if (!m_observe) m_redirect_cache.Put(pathStr, {redirectHost, port});
+        };
+        const auto forget_target = [&]() {
+            if (m_redirect_cache.Invalidate(pathStr, redirectHost, port)) m_metrics.RecordRedirectCacheInvalidated();
+        };
 
         switch (cached) {
             case OpenVerifyCache::Status::Miss: {
                 m_metrics.RecordCacheMiss();
-                m_log.Emsg(" INFO", "openverify cache miss for", key.c_str());
-                const auto verify_result = m_single_flight.Run(key, [&]() {
-                    const auto st = open_verify(key, verify_opaque, client, OpenVerifyTimeoutSeconds());
-                    if (st.IsOK()) {
-                        m_metrics.RecordVerifySuccess();
-                        m_host_reliability.RecordVerifySuccess(hostStr, portVal);
-                        m_cache.PutPositive(key, std::chrono::seconds(120));
-                    } else {
-                        const std::string failure_reason = st.GetErrorMessage().empty() ? "openverify_failure"
-                                                                                         : st.GetErrorMessage();
-                        m_metrics.RecordVerifyFailure(hostStr, portVal, failure_reason);
-                        m_host_reliability.RecordVerifyFailure(hostStr, portVal, st.code);
-                        m_cache.PutNegative(key, JitteredNegativeTTL(15));
-                    }
-                    return st;
-                });
+                m_log.Info("openverify cache miss for", key);
+                span.Cache(OpenVerifyOpenTrace::CacheResult::Miss);
+                // RunDetached starts the verify only on the leader; everyone, the leader included,
+                // then waits for its verdict until their own deadline.
+                const auto flight_start = span.Now();
+                bool led = false;
+                // The verify's XrdCl steps, for this open's trace; only while tracing.
+                std::shared_ptr<OpenVerifyOpenTrace::Recorder> verify_trace;
+                const auto start = [&](OpenVerifySingleFlight::Done done) {
+                    const auto verify_start = std::chrono::steady_clock::now();
+                    led = true;
+                    span.SingleFlight(OpenVerifyOpenTrace::Role::Leader, span.Now() - flight_start);
+                    if (span.Active()) verify_trace = std::make_shared<OpenVerifyOpenTrace::Recorder>();
+                    // The verdict may come after this open gave up waiting, so it only refers to
+                    // filesystem-wide state.
+                    auto on_done = [&metrics = m_metrics, &host_reliability = m_host_reliability, &cache = m_cache,
+                                    key, hostStr, portVal, verify_start, verify_trace,
+                                    done = std::move(done)](const XrdCl::XRootDStatus& st) {
+                        const auto verify_time = std::chrono::steady_clock::now() - verify_start;
+                        if (verify_trace) verify_trace->Verify(st.code, verify_time);
+                        // Cut off with nobody left waiting: not a verdict on the host, nothing to
+                        // cache or count against it.
+                        if (!OpenVerifySingleFlight::IsWaitExpired(st)) {
+                            metrics.ObserveVerify(hostStr, portVal, verify_time);
+                            if (st.IsOK()) {
+                                metrics.RecordVerifySuccess();
+                                host_reliability.RecordVerifySuccess(hostStr, portVal);
+                                cache.PutPositive(key, std::chrono::seconds(120));
+                            } else {
+                                const std::string failure_reason =
+                                    st.GetErrorMessage().empty() ? "openverify_failure" : st.GetErrorMessage();
+                                metrics.RecordVerifyFailure(hostStr, portVal, failure_reason);
+                                host_reliability.RecordVerifyFailure(hostStr, portVal, st.code);
+                                cache.PutNegative(key, JitteredNegativeTTL(15));
+                            }
+                        }
+                        done(st);
+                    };
+                    // The verify serves every caller waiting on the key, so it runs to the last of
+                    // their deadlines; this open's own deadline only ends its own wait.
+                    start_verify(key, client_opaque, verify_tried, client, OpenVerifyTimeoutSeconds(),
+                                 [&single_flight = m_single_flight, key] { return single_flight.VerifyDeadline(key); },
+                                 verify_trace, std::move(on_done));
+                };
+                const auto verify_result =
+                    m_single_flight.RunDetached(key, hostPort, ClientClass(client), deadline, start);
+                if (verify_trace) verify_trace->Replay(span);
+                if (!led) {
+                    const auto role = OpenVerifySingleFlight::IsOverloaded(verify_result)
+                                          ? OpenVerifyOpenTrace::Role::Refused
+                                          : OpenVerifyOpenTrace::Role::Follower;
+                    span.SingleFlight(role, span.Now() - flight_start);
+                }
 
                 if (verify_result.IsOK()) {
                     retry = false;
-                    m_log.Emsg(" INFO", "openverify succeeded for", key.c_str());
+                    remember_target();
+                    m_log.Info("openverify succeeded for", key);
+                } else if (OpenVerifySingleFlight::IsOverloaded(verify_result)) {
+                    // The verifier is overloaded, not the host: leave tried= alone. Degraded
+                    // even when the refusal came after the deadline.
+                    retry = false;
+                    const DegradeAction action = m_observe ? DegradeAction::Open : OverloadAction();
+                    m_metrics.RecordOverloadDegrade(action);
+                    m_log.Warn("openverify overloaded, degrading for", key,
+                               verify_result.GetErrorMessage().c_str());
+                    rc = Degrade(action, error, rc);
+                } else if (OpenVerifySingleFlight::IsWaitExpired(verify_result) && !out_of_time()) {
+                    retry = false;
+                    m_log.Warn("openverify gave up waiting for", key);
+                    if (!m_observe) rc = Degrade(WaitExpiredAction(), error, rc);
+                } else if (out_of_time()) {
+                    // A wait cut short by this open's deadline, or a verdict that came too late
+                    // to act on: the redirect is the best answer left.
+                    retry = false;
+                    m_metrics.RecordOpenDeadlineExceeded();
+                    m_log.Warn("openverify deadline exceeded for", key);
                 } else {
                     tried_hosts = tried_hosts.empty() ? hostPort : tried_hosts + "," + hostPort;
-                    m_log.Emsg(" WARN", "openverify failed for", key.c_str());
+                    forget_target();
+                    m_log.Warn("openverify failed for", key);
                 }
                 break;
             }
             case OpenVerifyCache::Status::Positive:
                 m_metrics.RecordCacheHitPositive();
-                m_log.Emsg(" INFO", "openverify succeeded (cached) for", key.c_str());
+                span.Cache(OpenVerifyOpenTrace::CacheResult::Positive);
+                m_log.Info("openverify succeeded (cached) for", key);
                 retry = false;
+                remember_target();
                 break;
             case OpenVerifyCache::Status::Negative:
                 m_metrics.RecordCacheHitNegative();
+                span.Cache(OpenVerifyOpenTrace::CacheResult::Negative);
                 tried_hosts = tried_hosts.empty() ? hostPort : tried_hosts + "," + hostPort;
-                m_log.Emsg(" WARN", "openverify failed (cached) for", key.c_str());
+                forget_target();
+                m_log.Warn("openverify failed (cached) for", key);
                 break;
         }
     }
 
+    m_metrics.ObserveOpen(std::chrono::steady_clock::now() - open_start);
+    span.Finish(rc, tried_hosts);
     return rc;
 }
 
@@ -192,103 +461,31 @@ int OpenVerifyFile::open(const char* fileName, XrdSfsFileOpenMode openMode, mode
 
 
 int OpenVerifyFile::close() {
-    m_log.Emsg(" INFO", "FileWrapper::close");
+    m_log.Debug("FileWrapper::close");
     return m_wrapped->close();
 }
 
 int OpenVerifyFile::checkpoint(cpAct act, struct iov* range, int n) {
-    m_log.Emsg(" INFO", "FileWrapper::checkpoint");
+    m_log.Debug("FileWrapper::checkpoint");
     return m_wrapped->checkpoint(act, range, n);
 }
 
 int OpenVerifyFile::fctl(const int cmd, const char* args, XrdOucErrInfo& out_error) {
-    m_log.Emsg(" INFO", "FileWrapper::fctl");
+    m_log.Debug("FileWrapper::fctl");
     return m_wrapped->fctl(cmd, args, out_error);
 }
 
-const char* OpenVerifyFile::FName() {
-    m_log.Emsg(" INFO", "FileWrapper::FName");
-    return m_wrapped->FName();
-}
-
 int OpenVerifyFile::getMmap(void** Addr, off_t& Size) {
-    m_log.Emsg(" INFO", "FileWrapper::getMmap");
+    m_log.Debug("FileWrapper::getMmap");
     return m_wrapped->getMmap(Addr, Size);
 }
 
-XrdSfsXferSize OpenVerifyFile::pgRead(XrdSfsFileOffset offset, char* buffer, XrdSfsXferSize rdlen, uint32_t* csvec,
-                                      uint64_t opts) {
-    m_log.Emsg(" INFO", "FileWrapper::pgRead(offset, buffer)");
-    return m_wrapped->pgRead(offset, buffer, rdlen, csvec, opts);
-}
-
-XrdSfsXferSize OpenVerifyFile::pgRead(XrdSfsAio* aioparm, uint64_t opts) {
-    m_log.Emsg(" INFO", "FileWrapper::pgRead(aioparm)");
-    return m_wrapped->pgRead(aioparm, opts);
-}
-
-XrdSfsXferSize OpenVerifyFile::pgWrite(XrdSfsFileOffset offset, char* buffer, XrdSfsXferSize rdlen, uint32_t* csvec,
-                                       uint64_t opts) {
-    m_log.Emsg(" INFO", "FileWrapper::pgWrite(offset, buffer)");
-    return m_wrapped->pgWrite(offset, buffer, rdlen, csvec, opts);
-}
-
-XrdSfsXferSize OpenVerifyFile::pgWrite(XrdSfsAio* aioparm, uint64_t opts) {
-    m_log.Emsg(" INFO", "FileWrapper::pgWrite(aioparm)");
-    return m_wrapped->pgWrite(aioparm, opts);
-}
-
-int OpenVerifyFile::read(XrdSfsFileOffset fileOffset, XrdSfsXferSize amount) {
-    m_log.Emsg(" INFO", "FileWrapper::read(offset, amount)");
-    return m_wrapped->read(fileOffset, amount);
-}
-
-XrdSfsXferSize OpenVerifyFile::read(XrdSfsFileOffset fileOffset, char* buffer, XrdSfsXferSize buffer_size) {
-    m_log.Emsg(" INFO", "FileWrapper::read(offset, buffer)");
-    return m_wrapped->read(fileOffset, buffer, buffer_size);
-}
-
-int OpenVerifyFile::read(XrdSfsAio* aioparm) {
-    m_log.Emsg(" INFO", "FileWrapper::read(aioparm)");
-    return m_wrapped->read(aioparm);
-}
-
-XrdSfsXferSize OpenVerifyFile::write(XrdSfsFileOffset fileOffset, const char* buffer, XrdSfsXferSize buffer_size) {
-    m_log.Emsg(" INFO", "FileWrapper::write(offset, buffer)");
-    return m_wrapped->write(fileOffset, buffer, buffer_size);
-}
-
-int OpenVerifyFile::write(XrdSfsAio* aioparm) {
-    m_log.Emsg(" INFO", "FileWrapper::write(aioparm)");
-    return m_wrapped->write(aioparm);
-}
-
-int OpenVerifyFile::sync() {
-    m_log.Emsg(" INFO", "FileWrapper::sync");
-    return m_wrapped->sync();
-}
-
-int OpenVerifyFile::sync(XrdSfsAio* aiop) {
-    m_log.Emsg(" INFO", "FileWrapper::sync(aiop)");
-    return m_wrapped->sync(aiop);
-}
-
-int OpenVerifyFile::stat(struct stat* buf) {
-    m_log.Emsg(" INFO", "FileWrapper::stat");
-    return m_wrapped->stat(buf);
-}
-
 int OpenVerifyFile::truncate(XrdSfsFileOffset fileOffset) {
-    m_log.Emsg(" INFO", "FileWrapper::truncate");
+    m_log.Debug("FileWrapper::truncate");
     return m_wrapped->truncate(fileOffset);
 }
 
 int OpenVerifyFile::getCXinfo(char cxtype[4], int& cxrsz) {
-    m_log.Emsg(" INFO", "FileWrapper::getCXinfo");
+    m_log.Debug("FileWrapper::getCXinfo");
     return m_wrapped->getCXinfo(cxtype, cxrsz);
 }
-
-int OpenVerifyFile::SendData(XrdSfsDio* sfDio, XrdSfsFileOffset offset, XrdSfsXferSize size) {
-    m_log.Emsg(" INFO", "FileWrapper::SendData");
-    return m_wrapped->SendData(sfDio, offset, size);
-}
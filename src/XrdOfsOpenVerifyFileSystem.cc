@@ -17,159 +17,195 @@ OpenVerifyFileSystem* ofs = nullptr;
 OpenVerifyFileSystem::OpenVerifyFileSystem(XrdSfsFileSystem* nativeFS, XrdSysLogger* Logger, const char* configFn,
                                          XrdOucEnv* envP)
     : m_next_sfs(nativeFS),
-      m_log(0, "ofs_plugin"),
+      m_syslog(0, "ofs_plugin"),
       m_config(configFn),
       m_env(envP),
       m_observe(OpenVerifyObserveModeEnabled()) {
-    m_log.logger(Logger);
-    m_log.Emsg("ERR:: ", "*** XrdOfsOpenVerify Initialised ****");
+    m_syslog.logger(Logger);
+    m_syslog.Emsg("ERR:: ", "*** XrdOfsOpenVerify Initialised ****");
     if (m_observe) {
-        m_log.Emsg("INFO",
-                   "openverify observe mode (XRD_OPENVERIFY_OBSERVE): cache metrics + verify on miss only; "
-                   "no cache/tried changes; redirect unchanged");
+        m_log.Info(
+            "openverify observe mode (XRD_OPENVERIFY_OBSERVE): cache metrics + verify on miss only; "
+            "no cache/tried changes; redirect unchanged");
+    }
+    if (!m_metrics.HttpStartError().empty()) {
+        m_log.Warn("openverify metrics endpoint (XRD_OPENVERIFY_METRICS_HTTP_PORT) not started:",
+                   m_metrics.HttpStartError());
+    }
+    if (m_open_trace.OpenError() != 0) {
+        m_log.Warn("openverify open tracing off, cannot open XRD_OPENVERIFY_TRACE_PATH", m_open_trace.Path(),
+                   std::strerror(m_open_trace.OpenError()));
     }
     m_cache.StartExpiryThread();
+    m_cache_collector_id = m_metrics.AddCollector(
+        [this](std::ostream& out, const std::string& lbl) { WriteCacheExposition(out, lbl); });
+    m_trace_collector_id = m_metrics.AddCollector(
+        [this](std::ostream& out, const std::string& lbl) { m_open_trace.WriteExposition(out, lbl); });
+}
+
+OpenVerifyFileSystem::~OpenVerifyFileSystem() {
+    // Detached verifies report into the cache, metrics and host reliability below.
+    m_single_flight.Drain();
+    m_metrics.RemoveCollector(m_trace_collector_id);
+    m_metrics.RemoveCollector(m_cache_collector_id);
+}
+
+void OpenVerifyFileSystem::WriteCacheExposition(std::ostream& out, const std::string& lbl) {
+    const OpenVerifyCache::Stats stats = m_cache.GetStats();
+    out << "# HELP xrootd_openverify_cache_entries OpenVerify cache entries by status (including expired, unpurged).\n"
+           "# TYPE xrootd_openverify_cache_entries gauge\n"
+           "xrootd_openverify_cache_entries{status=\"positive\""
+        << lbl << "} " << stats.positive_entries << "\n"
+        << "xrootd_openverify_cache_entries{status=\"negative\"" << lbl << "} " << stats.negative_entries << "\n";
+    const std::string labels = lbl.empty() ? std::string() : lbl.substr(1);
+    OpenVerifyMetrics::WriteGauge(out, "xrootd_openverify_cache_nodes", "Path-trie nodes held by the OpenVerify cache.",
+                                  labels, static_cast<double>(stats.nodes));
+    OpenVerifyMetrics::WriteGauge(out, "xrootd_openverify_cache_memory_bytes",
+                                  "Approximate heap footprint of the OpenVerify cache.", labels,
+                                  static_cast<double>(stats.approx_bytes));
 }
 
 XrdSfsDirectory* OpenVerifyFileSystem::newDir(char* user, int monid) {
-    m_log.Emsg(" INFO", "XrdOfsOpenVerify::newDir");
+    m_log.Debug("XrdOfsOpenVerify::newDir");
     return m_next_sfs->newDir(user, monid);
 }
 
 XrdSfsDirectory* OpenVerifyFileSystem::newDir(XrdOucErrInfo& einfo) {
-    m_log.Emsg(" INFO", "XrdOfsOpenVerify::newDir(einfo)");
+    m_log.Debug("XrdOfsOpenVerify::newDir(einfo)");
     return m_next_sfs->newDir(einfo);
 }
 
 XrdSfsFile* OpenVerifyFileSystem::newFile(char* user, int monid) {
-    m_log.Emsg(" INFO", "XrdOfsOpenVerify::newFile");
+    m_log.Debug("XrdOfsOpenVerify::newFile");
     XrdSfsFile* f = m_next_sfs->newFile(user, monid);
     if (!f) {
-        m_log.Emsg(" WARN", "XrdOfsOpenVerify::newFile - underlying newFile returned null");
+        m_log.Warn("XrdOfsOpenVerify::newFile - underlying newFile returned null");
         return nullptr;
     }
-    m_log.Emsg(" INFO", "XrdOfsOpenVerify::newFile - wrapping with FileWrapper");
-    XrdSfsFile* fw = new OpenVerifyFile(f, m_log, m_cache, m_metrics, m_single_flight, m_host_reliability, m_observe);
+    m_log.Debug("XrdOfsOpenVerify::newFile - wrapping with FileWrapper");
+    XrdSfsFile* fw = new OpenVerifyFile(f, m_log, m_cache, m_metrics, m_single_flight, m_host_reliability,
+                                        m_retry_budget, m_resume_state, m_redirect_cache, m_io_trace, m_open_trace,
+                                        m_executor, m_observe);
     return fw;
 }
 
 XrdSfsFile* OpenVerifyFileSystem::newFile(XrdOucErrInfo& einfo) {
-    m_log.Emsg(" INFO", "XrdOfsOpenVerify::newFile(einfo)");
+    m_log.Debug("XrdOfsOpenVerify::newFile(einfo)");
     return m_next_sfs->newFile(einfo);
 }
 
 int OpenVerifyFileSystem::chksum(csFunc Func, const char* csName, const char* path, XrdOucErrInfo& eInfo,
                                  const XrdSecEntity* client, const char* opaque) {
-    m_log.Emsg(" INFO", "XrdOfsOpenVerify::chksum");
+    m_log.Debug("XrdOfsOpenVerify::chksum");
     return m_next_sfs->chksum(Func, csName, path, eInfo, client, opaque);
 }
 
 int OpenVerifyFileSystem::chmod(const char* path, XrdSfsMode mode, XrdOucErrInfo& eInfo, const XrdSecEntity* client,
                                 const char* opaque) {
-    m_log.Emsg(" INFO", "XrdOfsOpenVerify::chmod");
+    m_log.Debug("XrdOfsOpenVerify::chmod");
     return m_next_sfs->chmod(path, mode, eInfo, client, opaque);
 }
 
 void OpenVerifyFileSystem::Connect(const XrdSecEntity* client) {
-    m_log.Emsg(" INFO", "XrdOfsOpenVerify::Connect");
+    m_log.Debug("XrdOfsOpenVerify::Connect");
     m_next_sfs->Connect(client);
 }
 
 void OpenVerifyFileSystem::Disc(const XrdSecEntity* client) {
-    m_log.Emsg(" INFO", "XrdOfsOpenVerify::Disc");
+    m_log.Debug("XrdOfsOpenVerify::Disc");
     m_next_sfs->Disc(client);
 }
 
 void OpenVerifyFileSystem::EnvInfo(XrdOucEnv* envP) {
-    m_log.Emsg(" INFO", "XrdOfsOpenVerify::EnvInfo");
+    m_log.Debug("XrdOfsOpenVerify::EnvInfo");
     m_next_sfs->EnvInfo(envP);
 }
 
 int OpenVerifyFileSystem::exists(const char* path, XrdSfsFileExistence& eFlag, XrdOucErrInfo& eInfo,
                                  const XrdSecEntity* client, const char* opaque) {
-    m_log.Emsg(" INFO", "XrdOfsOpenVerify::exists");
+    m_log.Debug("XrdOfsOpenVerify::exists");
     return m_next_sfs->exists(path, eFlag, eInfo, client, opaque);
 }
 
 int OpenVerifyFileSystem::FAttr(XrdSfsFACtl* faReq, XrdOucErrInfo& eInfo, const XrdSecEntity* client) {
-    m_log.Emsg(" INFO", "XrdOfsOpenVerify::FAttr");
+    m_log.Debug("XrdOfsOpenVerify::FAttr");
     return m_next_sfs->FAttr(faReq, eInfo, client);
 }
 
 int OpenVerifyFileSystem::FSctl(const int cmd, XrdSfsFSctl& args, XrdOucErrInfo& eInfo, const XrdSecEntity* client) {
-    m_log.Emsg(" INFO", "XrdOfsOpenVerify::FSctl");
+    m_log.Debug("XrdOfsOpenVerify::FSctl");
     return m_next_sfs->FSctl(cmd, args, eInfo, client);
 }
 
 int OpenVerifyFileSystem::fsctl(const int cmd, const char* args, XrdOucErrInfo& eInfo, const XrdSecEntity* client) {
-    m_log.Emsg(" INFO", "XrdOfsOpenVerify::fsctl");
+    m_log.Debug("XrdOfsOpenVerify::fsctl");
     return m_next_sfs->fsctl(cmd, args, eInfo, client);
 }
 
 int OpenVerifyFileSystem::getChkPSize() {
-    m_log.Emsg(" INFO", "XrdOfsOpenVerify::getChkPSize");
+    m_log.Debug("XrdOfsOpenVerify::getChkPSize");
     return m_next_sfs->getChkPSize();
 }
 
 int OpenVerifyFileSystem::getStats(char* buff, int blen) {
-    m_log.Emsg(" INFO", "XrdOfsOpenVerify::getStats");
+    m_log.Debug("XrdOfsOpenVerify::getStats");
     return m_next_sfs->getStats(buff, blen);
 }
 
 const char* OpenVerifyFileSystem::getVersion() {
-    m_log.Emsg(" INFO", "XrdOfsOpenVerify::getVersion");
+    m_log.Debug("XrdOfsOpenVerify::getVersion");
     return XrdVERSION;
 }
 
 int OpenVerifyFileSystem::gpFile(gpfFunc& gpAct, XrdSfsGPFile& gpReq, XrdOucErrInfo& eInfo,
                                  const XrdSecEntity* client) {
-    m_log.Emsg(" INFO", "XrdOfsOpenVerify::gpFile");
+    m_log.Debug("XrdOfsOpenVerify::gpFile");
     return m_next_sfs->gpFile(gpAct, gpReq, eInfo, client);
 }
 
 int OpenVerifyFileSystem::mkdir(const char* path, XrdSfsMode mode, XrdOucErrInfo& eInfo, const XrdSecEntity* client,
                                 const char* opaque) {
-    m_log.Emsg(" INFO", "XrdOfsOpenVerify::mkdir");
+    m_log.Debug("XrdOfsOpenVerify::mkdir");
     return m_next_sfs->mkdir(path, mode, eInfo, client, opaque);
 }
 
 int OpenVerifyFileSystem::prepare(XrdSfsPrep& pargs, XrdOucErrInfo& eInfo, const XrdSecEntity* client) {
-    m_log.Emsg(" INFO", "XrdOfsOpenVerify::prepare");
+    m_log.Debug("XrdOfsOpenVerify::prepare");
     return m_next_sfs->prepare(pargs, eInfo, client);
 }
 
 int OpenVerifyFileSystem::rem(const char* path, XrdOucErrInfo& eInfo, const XrdSecEntity* client, const char* opaque) {
-    m_log.Emsg(" INFO", "XrdOfsOpenVerify::rem");
+    m_log.Debug("XrdOfsOpenVerify::rem");
     return m_next_sfs->rem(path, eInfo, client, opaque);
 }
 
 int OpenVerifyFileSystem::remdir(const char* path, XrdOucErrInfo& eInfo, const XrdSecEntity* client,
                                  const char* opaque) {
-    m_log.Emsg(" INFO", "XrdOfsOpenVerify::remdir");
+    m_log.Debug("XrdOfsOpenVerify::remdir");
     return m_next_sfs->remdir(path, eInfo, client, opaque);
 }
 
 int OpenVerifyFileSystem::rename(const char* oPath, const char* nPath, XrdOucErrInfo& eInfo, const XrdSecEntity* client,
                                  const char* opaqueO, const char* opaqueN) {
-    m_log.Emsg(" INFO", "XrdOfsOpenVerify::rename");
+    m_log.Debug("XrdOfsOpenVerify::rename");
     return m_next_sfs->rename(oPath, nPath, eInfo, client, opaqueO, opaqueN);
 }
 
 int OpenVerifyFileSystem::stat(const char* Name, struct stat* buf, XrdOucErrInfo& eInfo, const XrdSecEntity* client,
                                const char* opaque) {
-    m_log.Emsg(" INFO", "XrdOfsOpenVerify::stat(struct stat)");
+    m_log.Debug("XrdOfsOpenVerify::stat(struct stat)");
     return m_next_sfs->stat(Name, buf, eInfo, client, opaque);
 }
 
 int OpenVerifyFileSystem::stat(const char* path, mode_t& mode, XrdOucErrInfo& eInfo, const XrdSecEntity* client,
                                const char* opaque) {
-    m_log.Emsg(" INFO", "XrdOfsOpenVerify::stat(mode_t)");
+    m_log.Debug("XrdOfsOpenVerify::stat(mode_t)");
     return m_next_sfs->stat(path, mode, eInfo, client, opaque);
 }
 
 int OpenVerifyFileSystem::truncate(const char* path, XrdSfsFileOffset fsize, XrdOucErrInfo& eInfo,
                                    const XrdSecEntity* client, const char* opaque) {
-    m_log.Emsg(" INFO", "XrdOfsOpenVerify::truncate");
+    m_log.Debug("XrdOfsOpenVerify::truncate");
     return m_next_sfs->truncate(path, fsize, eInfo, client, opaque);
 }
 
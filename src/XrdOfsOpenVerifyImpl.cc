@@ -1,49 +1,49 @@
+#include <algorithm>
 #include <array>
-#include <cctype>
+#include <chrono>
 #include <cerrno>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <functional>
 #include <string>
 #include <unordered_map>
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include "OpenVerifyOpaque.hh"
+#include "OpenVerifyXrdClAwait.hh"
 #include "XrdCl/XrdClFile.hh"
 #include "XrdCl/XrdClStatus.hh"
 #include "XrdCl/XrdClXRootDResponses.hh"
 #include "XrdOfsOpenVerify.hh"
 
 namespace {
-std::string MakeXrdClUrlFromKeyAndOpaque(const std::string& key, const char* opaque,
-                                         const char* ztnFilePath) {
+// `opaque` is the client's opaque; `tried_hosts` are merged into its tried= list.
+std::string MakeXrdClUrl(const std::string& key, const OpenVerifyOpaque& opaque, const std::string& tried_hosts) {
     // `key` format: <host>[:<port>]//<path>
-    std::string url = "root://";
+    std::string url;
+    // Room for the xrd.ztn= pair AppendZtnPath adds to most verifies.
+    url.reserve(7 + key.size() + 1 + opaque.SizeWithTried(tried_hosts) + 9 + 16);
+    url = "root://";
     url += key;
 
-    bool haveQuery = false;
-    if (opaque && *opaque) {
+    if (!opaque.Raw().empty() || !tried_hosts.empty()) {
         url.push_back('?');
-        haveQuery = true;
-        if (*opaque == '?') {
-            url.append(opaque + 1);
-        } else {
-            url.append(opaque);
-        }
-    }
-
-    // Per-request token file path for XrdSecztn (see xrd.ztn / findToken in XrdSecProtocolztn).
-    // Use the raw path: XrdCl::URL::SetParams does not percent-decode values, so encoding
-    // (e.g. %2F) would make readToken stat the wrong path. mkstemp paths under /tmp are safe.
-    if (ztnFilePath && *ztnFilePath) {
-        url.push_back(haveQuery ? '&' : '?');
-        url.append("xrd.ztn=");
-        url.append(ztnFilePath);
+        opaque.AppendWithTried(url, tried_hosts);
     }
-
     return url;
 }
 
+// Per-request token file path for XrdSecztn (see xrd.ztn / findToken in XrdSecProtocolztn).
+// Use the raw path: XrdCl::URL::SetParams does not percent-decode values, so encoding
+// (e.g. %2F) would make readToken stat the wrong path. mkstemp paths under /tmp are safe.
+void AppendZtnPath(std::string& url, const std::string& ztnFilePath) {
+    url.push_back(url.find('?') == std::string::npos ? '?' : '&');
+    url.append("xrd.ztn=");
+    url.append(ztnFilePath);
+}
+
 // Writes the bearer token to a private temp file; XrdCl ztn reads it via ?xrd.ztn=... on the URL.
 class ScopedTokenTempFile {
    public:
@@ -106,105 +106,6 @@ bool GetTokenFromClientCreds(const XrdSecEntity* client, std::string& outToken)
     return true;
 }
 
-bool IsHexDigit(char c) {
-    return std::isxdigit(static_cast<unsigned char>(c)) != 0;
-}
-
-int HexValue(char c) {
-    const unsigned char uc = static_cast<unsigned char>(c);
-    if (uc >= '0' && uc <= '9') return uc - '0';
-    if (uc >= 'a' && uc <= 'f') return 10 + (uc - 'a');
-    if (uc >= 'A' && uc <= 'F') return 10 + (uc - 'A');
-    return -1;
-}
-
-std::string UrlDecode(const std::string& in) {
-    std::string out;
-    out.reserve(in.size());
-
-    for (size_t i = 0; i < in.size(); ++i) {
-        const char c = in[i];
-        if (c == '%' && i + 2 < in.size() && IsHexDigit(in[i + 1]) && IsHexDigit(in[i + 2])) {
-            const int hi = HexValue(in[i + 1]);
-            const int lo = HexValue(in[i + 2]);
-            out.push_back(static_cast<char>((hi << 4) | lo));
-            i += 2;
-            continue;
-        }
-        if (c == '+') {
-            out.push_back(' ');
-            continue;
-        }
-        out.push_back(c);
-    }
-    return out;
-}
-
-std::string ToLowerCopy(const std::string& in) {
-    std::string out = in;
-    for (size_t i = 0; i < out.size(); ++i) {
-        out[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(out[i])));
-    }
-    return out;
-}
-
-std::string TrimAsciiWhitespace(const std::string& in) {
-    size_t first = 0;
-    while (first < in.size() && std::isspace(static_cast<unsigned char>(in[first])) != 0) {
-        ++first;
-    }
-
-    size_t last = in.size();
-    while (last > first && std::isspace(static_cast<unsigned char>(in[last - 1])) != 0) {
-        --last;
-    }
-
-    return in.substr(first, last - first);
-}
-
-bool TryExtractTokenFromOpaque(const char* opaque, std::string& outToken) {
-    outToken.clear();
-    if (!opaque || !*opaque) return false;
-
-    std::string q = (*opaque == '?') ? std::string(opaque + 1) : std::string(opaque);
-    if (q.empty()) return false;
-
-    size_t start = 0;
-    while (start <= q.size()) {
-        size_t end = q.find('&', start);
-        if (end == std::string::npos) end = q.size();
-
-        const std::string pair = q.substr(start, end - start);
-        if (!pair.empty()) {
-            size_t eq = pair.find('=');
-            const std::string rawKey = (eq == std::string::npos) ? pair : pair.substr(0, eq);
-            const std::string rawValue = (eq == std::string::npos) ? std::string() : pair.substr(eq + 1);
-            const std::string key = ToLowerCopy(UrlDecode(rawKey));
-            std::string value = UrlDecode(rawValue);
-
-            if (key == "authorization" || key == "authz" || key == "bearer" || key == "bearer_token" ||
-                key == "token" || key == "access_token") {
-                value = TrimAsciiWhitespace(value);
-                const std::string bearerPrefix = "bearer ";
-                const std::string lowerValue = ToLowerCopy(value);
-                if (lowerValue.compare(0, bearerPrefix.size(), bearerPrefix) == 0) {
-                    value = TrimAsciiWhitespace(value.substr(bearerPrefix.size()));
-                }
-
-                if (!value.empty()) {
-                    outToken = value;
-                    return true;
-                }
-            }
-        }
-
-        if (end == q.size()) break;
-        start = end + 1;
-    }
-
-    return false;
-}
-
 // Maps XrdCl::Status.code (XrdClStatus.hh) -> stable Prometheus `reason` label.
 // errOSError is excluded: refined by errno below.
 const std::unordered_map<uint16_t, const char*>& XrdClCodeToReason() {
@@ -275,68 +176,133 @@ std::string ClassifyXrdClStatus(const XrdCl::Status& st) {
 
 }  // namespace
 
-XrdCl::XRootDStatus OpenVerifyFile::open_verify(const std::string& key, const char* opaque, const XrdSecEntity* client,
-                                                time_t timeout_seconds) {
+void OpenVerifyFile::start_verify(const std::string& key, const OpenVerifyOpaque& opaque,
+                                  const std::string& tried_hosts, const XrdSecEntity* client,
+                                  time_t timeout_seconds, DeadlineFn deadline,
+                                  std::shared_ptr<OpenVerifyOpenTrace::Recorder> trace, VerifyDone on_done) {
+    // The client's credentials and opaque belong to this open; take what the verify needs now.
     std::string token;
     bool haveToken = GetTokenFromClientCreds(client, token);
     if (!haveToken) {
-        haveToken = TryExtractTokenFromOpaque(opaque, token);
+        haveToken = opaque.FindToken(token);
     }
-
-    // Use XrdCl to open the file and read the first and last byte
-    // If the read fails, return false
-    // If the read succeeds, return true
+    if (!haveToken) token.clear();
 
     const auto slashPos = key.find('/');
     if (slashPos == std::string::npos || slashPos == 0) {
-        m_log.Emsg(" WARN", "openverify invalid key (missing host/path):", key.c_str());
-        return XrdCl::XRootDStatus{XrdCl::stError, XrdCl::errInvalidAddr, 0, "openverify_invalid_key"};
+        m_log.Warn("openverify invalid key (missing host/path):", key);
+        on_done(XrdCl::XRootDStatus{XrdCl::stError, XrdCl::errInvalidAddr, 0, "openverify_invalid_key"});
+        return;
     }
 
-    ScopedTokenTempFile tokenFile(haveToken ? token : std::string());
-    const char* ztnPath = nullptr;
-    if (haveToken) {
+    OpenVerifyLog& log = m_log;
+    OpenVerifyMetrics& metrics = m_metrics;
+    m_executor.Submit([&log, &metrics, key, url = MakeXrdClUrl(key, opaque, tried_hosts),
+                       token = std::move(token), timeout_seconds, deadline = std::move(deadline),
+                       trace = std::move(trace), on_done = std::move(on_done)]() {
+        StartDetached(verify_flow(log, metrics, key, url, token, timeout_seconds, deadline, trace),
+                      [on_done](OpenVerifyTask<XrdCl::XRootDStatus>& task) {
+                          XrdCl::XRootDStatus st;
+                          try {
+                              st = task.Result();
+                          } catch (...) {
+                              st = XrdCl::XRootDStatus{XrdCl::stError, XrdCl::errInternal, 0, "openverify_exception"};
+                          }
+                          on_done(st);
+                      });
+    });
+}
+
+OpenVerifyTask<XrdCl::XRootDStatus> OpenVerifyFile::verify_flow(OpenVerifyLog& log, OpenVerifyMetrics& metrics,
+                                                                std::string key, std::string url, std::string token,
+                                                                time_t timeout_seconds, DeadlineFn deadline,
+                                                                std::shared_ptr<OpenVerifyOpenTrace::Recorder> trace) {
+    // Use XrdCl to open the file and read the first and last byte
+    // If the read fails, return false
+    // If the read succeeds, return true
+
+    ScopedTokenTempFile tokenFile(token);
+    if (!token.empty()) {
         if (!tokenFile.ok()) {
-            m_log.Emsg(" WARN", "openverify could not create temp token file for", key.c_str());
-            return XrdCl::XRootDStatus{XrdCl::stError, XrdCl::errOSError, static_cast<uint32_t>(errno),
-                                       "openverify_token_file_error"};
+            log.Warn("openverify could not create temp token file for", key);
+            co_return XrdCl::XRootDStatus{XrdCl::stError, XrdCl::errOSError, static_cast<uint32_t>(errno),
+                                          "openverify_token_file_error"};
         }
-        ztnPath = tokenFile.path().c_str();
+        AppendZtnPath(url, tokenFile.path());
     }
 
-    const std::string url = MakeXrdClUrlFromKeyAndOpaque(key, opaque, ztnPath);
+    using Clock = std::chrono::steady_clock;
+    using Step = OpenVerifyMetrics::XrdClStep;
+    // XrdCl timeout for the next step: the per-step cap, or what is left until the deadline.
+    const auto step_timeout = [&]() -> time_t {
+        const auto left = std::chrono::ceil<std::chrono::seconds>(deadline() - Clock::now()).count();
+        return std::max<time_t>(1, std::min<time_t>(timeout_seconds, static_cast<time_t>(left)));
+    };
+    // A step that timed out after the deadline passed was cut short by us, not by the host.
+    const auto failed = [&](const XrdCl::XRootDStatus& st) {
+        const bool timeout = st.code == XrdCl::errOperationExpired || st.code == XrdCl::errSocketTimeout;
+        if (timeout && Clock::now() >= deadline()) {
+            return XrdCl::XRootDStatus{XrdCl::stError, XrdCl::errOperationExpired, 0, "openverify_deadline_exceeded"};
+        }
+        return XrdCl::XRootDStatus{st, ClassifyXrdClStatus(st)};
+    };
+    // Between steps: stop once nobody waits for the result any more.
+    const auto interrupted = [&]() -> const char* {
+        if (Clock::now() < deadline()) return nullptr;
+        log.Info("openverify stopped early for", key, "openverify_deadline_exceeded");
+        return "openverify_deadline_exceeded";
+    };
+
+    // Step latency for the metrics, and for the open's trace with the step's status code.
+    const auto observe_step = [&](Step step, Clock::time_point start, const XrdCl::XRootDStatus& st) {
+        const auto d = Clock::now() - start;
+        metrics.ObserveXrdClStep(step, d);
+        if (trace) trace->XrdClStep(step, d, st.IsOK() ? 0 : st.code);
+    };
 
     XrdCl::File f;
+    const auto close_file = [&]() -> OpenVerifyTask<XrdCl::XRootDStatus> {
+        const auto start = Clock::now();
+        auto closed = co_await AsyncClose(f, step_timeout());
+        observe_step(Step::Close, start, closed.status);
+        co_return closed.status;
+    };
+
     // should we use others - readable open flags instead?
-    auto st = f.Open(url, XrdCl::OpenFlags::Read, XrdCl::Access::None, timeout_seconds);
-    if (!st.IsOK()) {
-        const std::string msg = st.ToString();
-        m_log.Emsg(" WARN", "openverify XrdCl open failed for", url.c_str(), msg.c_str());
-        return XrdCl::XRootDStatus{st, ClassifyXrdClStatus(st)};
+    auto start = Clock::now();
+    auto open_result =
+        co_await AsyncOpen(f, url, XrdCl::OpenFlags::Read, XrdCl::Access::None, step_timeout());
+    observe_step(Step::Open, start, open_result.status);
+    if (!open_result.status.IsOK()) {
+        const std::string msg = open_result.status.ToString();
+        log.Warn("openverify XrdCl open failed for", url, msg);
+        co_return failed(open_result.status);
+    }
+
+    if (const char* why = interrupted()) {
+        co_await close_file();
+        co_return XrdCl::XRootDStatus{XrdCl::stError, XrdCl::errOperationExpired, 0, why};
     }
 
-    XrdCl::StatInfo* statInfo = nullptr;
-    st = f.Stat(false, statInfo);
-    if (!st.IsOK() || !statInfo) {
-        const std::string msg = st.ToString();
-        m_log.Emsg(" WARN", "openverify XrdCl stat failed for", url.c_str(), msg.c_str());
-        auto closeSt = f.Close();
-        (void)closeSt;
-        if (st.IsOK()) {
-            return XrdCl::XRootDStatus{XrdCl::stError, XrdCl::errInvalidResponse, 0, "openverify_stat_no_info"};
+    start = Clock::now();
+    auto stat_result = co_await AsyncStat(f, false, step_timeout());
+    observe_step(Step::Stat, start, stat_result.status);
+    if (!stat_result.status.IsOK() || !stat_result.response) {
+        const std::string msg = stat_result.status.ToString();
+        log.Warn("openverify XrdCl stat failed for", url, msg);
+        co_await close_file();
+        if (stat_result.status.IsOK()) {
+            co_return XrdCl::XRootDStatus{XrdCl::stError, XrdCl::errInvalidResponse, 0, "openverify_stat_no_info"};
         }
-        return XrdCl::XRootDStatus{st, ClassifyXrdClStatus(st)};
+        co_return failed(stat_result.status);
     }
 
-    const uint64_t size = statInfo->GetSize();
-    delete statInfo;
-    statInfo = nullptr;
+    const uint64_t size = stat_result.response->GetSize();
 
     if (size == 0) {
         // Empty file: treat as failure
-        auto closeSt = f.Close();
-        (void)closeSt;
-        return XrdCl::XRootDStatus{XrdCl::stError, XrdCl::errDataError, 0, "openverify_empty_file"};
+        co_await close_file();
+        co_return XrdCl::XRootDStatus{XrdCl::stError, XrdCl::errDataError, 0, "openverify_empty_file"};
     }
 
     XrdCl::ChunkList chunks;
@@ -349,22 +315,22 @@ XrdCl::XRootDStatus OpenVerifyFile::open_verify(const std::string& key, const ch
         chunks.emplace_back(size - 1, 1, nullptr);
     }
 
-    XrdCl::VectorReadInfo* vri = nullptr;
-    st = f.VectorRead(chunks, buf.data(), vri);
-    if (vri) {
-        delete vri;
-        vri = nullptr;
+    if (const char* why = interrupted()) {
+        co_await close_file();
+        co_return XrdCl::XRootDStatus{XrdCl::stError, XrdCl::errOperationExpired, 0, why};
     }
 
-    if (!st.IsOK()) {
-        const std::string msg = st.ToString();
-        m_log.Emsg(" WARN", "openverify XrdCl vector read failed for", url.c_str(), msg.c_str());
-        auto closeSt = f.Close();
-        (void)closeSt;
-        return XrdCl::XRootDStatus{st, ClassifyXrdClStatus(st)};
+    start = Clock::now();
+    auto read_result = co_await AsyncVectorRead(f, chunks, buf.data(), step_timeout());
+    observe_step(Step::VectorRead, start, read_result.status);
+
+    if (!read_result.status.IsOK()) {
+        const std::string msg = read_result.status.ToString();
+        log.Warn("openverify XrdCl vector read failed for", url, msg);
+        co_await close_file();
+        co_return failed(read_result.status);
     }
 
-    auto closeSt = f.Close();
-    (void)closeSt;
-    return XrdCl::XRootDStatus{};
+    co_await close_file();
+    co_return XrdCl::XRootDStatus{};
 }
@@ -116,6 +116,30 @@ void Test_NoPrefixMatch() {
     Expect(cache.Get(key_abcd, t0) == OpenVerifyCache::Status::Miss, "NoPrefixMatch: should not match ancestor entry");
 }
 
+void Test_StatsTrackEntriesAndNodes() {
+    OpenVerifyCache cache;
+    const auto t0 = Clock::time_point{};
+    const auto k1 = MakeOpenVerifyCacheKey("/a/b", "h", 1);
+    const auto k2 = MakeOpenVerifyCacheKey("/a/c", "h", 1);
+    cache.PutPositive(k1, std::chrono::seconds(1), t0);
+    cache.PutNegative(k2, std::chrono::seconds(100), t0);
+    // Overwriting an entry must move it between counters, not add a new one.
+    cache.PutNegative(k1, std::chrono::seconds(1), t0);
+
+    auto stats = cache.GetStats();
+    Expect(stats.positive_entries == 0 && stats.negative_entries == 2, "Stats: overwrite moves entry to negative");
+    Expect(stats.nodes == 4, "Stats: h:1, a, b, c nodes");
+    Expect(stats.approx_bytes > 0, "Stats: footprint estimate is non-zero");
+
+    cache.Expire(t0 + std::chrono::seconds(2));
+    stats = cache.GetStats();
+    Expect(stats.negative_entries == 1 && stats.nodes == 3, "Stats: expired entry and its node are dropped");
+
+    cache.Reset();
+    stats = cache.GetStats();
+    Expect(stats.negative_entries == 0 && stats.nodes == 0, "Stats: reset clears counts");
+}
+
 }  // namespace
 
 int main() {
@@ -128,6 +152,7 @@ int main() {
     Test_ResetClearsAll();
     Test_ExpirePrunes();
     Test_NoPrefixMatch();
+    Test_StatsTrackEntriesAndNodes();
 
     if (g_failures) {
         std::cerr << g_failures << " test(s) failed.\n";
@@ -0,0 +1,81 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "OpenVerifyCoDel.hh"
+
+namespace {
+
+using Clock = OpenVerifyCoDel::Clock;
+using std::chrono::milliseconds;
+
+int g_failures = 0;
+
+void Expect(bool cond, const std::string& msg) {
+    if (!cond) {
+        ++g_failures;
+        std::cerr << "FAIL: " << msg << "\n";
+    }
+}
+
+void Test_DisabledNeverSheds() {
+    OpenVerifyCoDel codel(false, milliseconds(10), milliseconds(100));
+    auto t = Clock::now();
+    for (int i = 0; i < 10; ++i) {
+        t += milliseconds(200);
+        codel.OnAdmit(milliseconds(500), t);
+    }
+    Expect(!codel.Overloaded(), "disabled CoDel never reports overload");
+    Expect(!codel.ShouldShed(milliseconds(500)), "disabled CoDel never sheds");
+}
+
+void Test_StandingQueueTriggersOverload() {
+    OpenVerifyCoDel codel(true, milliseconds(10), milliseconds(100));
+    auto t = Clock::now();
+    codel.OnAdmit(milliseconds(50), t);
+    codel.OnAdmit(milliseconds(40), t + milliseconds(50));
+    Expect(!codel.Overloaded(), "no verdict before the first interval closes");
+
+    codel.OnAdmit(milliseconds(60), t + milliseconds(120));
+    Expect(codel.Overloaded(), "minimum sojourn above target for a whole interval is a standing queue");
+    Expect(codel.ShouldShed(milliseconds(11)), "waiters older than target are shed under overload");
+    Expect(!codel.ShouldShed(milliseconds(5)), "fresh waiters are kept under overload");
+}
+
+void Test_ShortBurstDoesNotTrigger() {
+    OpenVerifyCoDel codel(true, milliseconds(10), milliseconds(100));
+    auto t = Clock::now();
+    codel.OnAdmit(milliseconds(80), t);
+    codel.OnAdmit(milliseconds(0), t + milliseconds(30));  // queue drained once
+    codel.OnAdmit(milliseconds(90), t + milliseconds(60));
+    codel.OnAdmit(milliseconds(70), t + milliseconds(120));
+    Expect(!codel.Overloaded(), "a queue that drained within the interval is only a burst");
+}
+
+void Test_SlackClearsOverload() {
+    OpenVerifyCoDel codel(true, milliseconds(10), milliseconds(100));
+    auto t = Clock::now();
+    codel.OnAdmit(milliseconds(50), t);
+    codel.OnAdmit(milliseconds(50), t + milliseconds(120));
+    Expect(codel.Overloaded(), "precondition: overloaded");
+
+    codel.OnAdmit(milliseconds(0), t + milliseconds(150));
+    codel.OnAdmit(milliseconds(30), t + milliseconds(240));
+    Expect(!codel.Overloaded(), "an interval with an immediate admission clears overload");
+}
+
+}  // namespace
+
+int main() {
+    Test_DisabledNeverSheds();
+    Test_StandingQueueTriggersOverload();
+    Test_ShortBurstDoesNotTrigger();
+    Test_SlackClearsOverload();
+
+    if (g_failures) {
+        std::cerr << g_failures << " test(s) failed.\n";
+        return 1;
+    }
+    std::cout << "All tests passed.\n";
+    return 0;
+}
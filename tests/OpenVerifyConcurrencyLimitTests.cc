@@ -0,0 +1,91 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "OpenVerifyConcurrencyLimit.hh"
+
+namespace {
+
+using Clock = OpenVerifyConcurrencyLimit::Clock;
+using std::chrono::milliseconds;
+
+int g_failures = 0;
+
+void Expect(bool cond, const std::string& msg) {
+    if (!cond) {
+        ++g_failures;
+        std::cerr << "FAIL: " << msg << "\n";
+    }
+}
+
+OpenVerifyConcurrencyLimit::Options Adaptive(size_t initial, size_t min, size_t max) {
+    OpenVerifyConcurrencyLimit::Options opts;
+    opts.adaptive = true;
+    opts.initial = initial;
+    opts.min = min;
+    opts.max = max;
+    opts.window_samples = 4;
+    opts.min_window = milliseconds(10);
+    return opts;
+}
+
+// Feeds `windows` full windows of samples at `rtt`, each at the current limit's concurrency.
+Clock::time_point Feed(OpenVerifyConcurrencyLimit& limit, Clock::time_point t, milliseconds rtt, int windows,
+                       size_t inflight = 0) {
+    for (int w = 0; w < windows; ++w) {
+        for (int i = 0; i < 4; ++i) {
+            t += milliseconds(5);
+            limit.OnSample(rtt, inflight ? inflight : limit.Limit(), t);
+        }
+    }
+    return t;
+}
+
+void Test_StaticLimitNeverMoves() {
+    OpenVerifyConcurrencyLimit::Options opts;
+    opts.initial = 32;
+    OpenVerifyConcurrencyLimit limit(opts);
+    auto t = Clock::now();
+    t = Feed(limit, t, milliseconds(10), 20);
+    Expect(!limit.OnSample(milliseconds(500), 32, t), "static limit ignores samples");
+    Expect(limit.Limit() == 32, "static limit stays at its configured value");
+}
+
+void Test_GrowsWhileLatencyFlat() {
+    OpenVerifyConcurrencyLimit limit(Adaptive(8, 4, 64));
+    Feed(limit, Clock::now(), milliseconds(20), 30);
+    Expect(limit.Limit() > 8, "limit should grow while latency stays at the baseline");
+    Expect(limit.Limit() <= 64, "limit must respect the upper bound");
+    Expect(limit.NoLoadLatency() == milliseconds(20), "baseline tracks the flat latency");
+}
+
+void Test_NoGrowthWhenUnderused() {
+    OpenVerifyConcurrencyLimit limit(Adaptive(32, 4, 64));
+    Feed(limit, Clock::now(), milliseconds(20), 30, 2);
+    Expect(limit.Limit() == 32, "limit should not grow when far fewer verifies are in flight");
+}
+
+void Test_ShrinksWhenLatencyRises() {
+    OpenVerifyConcurrencyLimit limit(Adaptive(32, 4, 64));
+    auto t = Feed(limit, Clock::now(), milliseconds(20), 2);
+    const size_t before = limit.Limit();
+    Feed(limit, t, milliseconds(200), 10);
+    Expect(limit.Limit() < before, "limit should shrink once latency rises well above the baseline");
+    Expect(limit.Limit() >= 4, "limit must respect the lower bound");
+}
+
+}  // namespace
+
+int main() {
+    Test_StaticLimitNeverMoves();
+    Test_GrowsWhileLatencyFlat();
+    Test_NoGrowthWhenUnderused();
+    Test_ShrinksWhenLatencyRises();
+
+    if (g_failures) {
+        std::cerr << g_failures << " test(s) failed.\n";
+        return 1;
+    }
+    std::cout << "All tests passed.\n";
+    return 0;
+}
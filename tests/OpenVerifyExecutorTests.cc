@@ -0,0 +1,129 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "OpenVerifyExecutor.hh"
+
+namespace {
+
+int g_failures = 0;
+
+void Expect(bool cond, const std::string& msg) {
+    if (!cond) {
+        ++g_failures;
+        std::cerr << "FAIL: " << msg << "\n";
+    }
+}
+
+void Test_SubmitRunsOnPool() {
+    OpenVerifyMetrics metrics;
+    OpenVerifyExecutor pool(metrics, 2);
+    const std::thread::id caller = std::this_thread::get_id();
+    std::thread::id ran_on;
+    int v = 0;
+    pool.Submit([&]() {
+        ran_on = std::this_thread::get_id();
+        v = 42;
+    })->Wait();
+    Expect(v == 42, "Wait should return after the job ran");
+    Expect(ran_on != caller, "Submit should run the job on a pool thread");
+}
+
+void Test_ThrowingJobCompletes() {
+    OpenVerifyMetrics metrics;
+    OpenVerifyExecutor pool(metrics, 1);
+    auto failed = pool.Submit([]() { throw std::runtime_error("boom"); });
+    failed->Wait();
+    Expect(failed->Done(), "a throwing job still completes");
+    bool ran = false;
+    pool.Submit([&]() { ran = true; })->Wait();
+    Expect(ran, "the worker survives a throwing job");
+}
+
+void Test_ZeroThreadsRunsInline() {
+    OpenVerifyMetrics metrics;
+    OpenVerifyExecutor pool(metrics, 0);
+    const std::thread::id caller = std::this_thread::get_id();
+    std::thread::id ran_on;
+    auto done = pool.Submit([&]() { ran_on = std::this_thread::get_id(); });
+    Expect(done->Done(), "inline job should be complete on return");
+    Expect(ran_on == caller, "a pool without threads runs jobs on the caller");
+}
+
+void Test_ThreadsFromEnv() {
+    OpenVerifyMetrics metrics;
+    setenv("XRD_OPENVERIFY_EXECUTOR_THREADS", "0", 1);
+    Expect(OpenVerifyExecutor(metrics).Threads() == 0, "0 turns the pool off");
+    setenv("XRD_OPENVERIFY_EXECUTOR_THREADS", "3", 1);
+    Expect(OpenVerifyExecutor(metrics).Threads() == 3, "a number sizes the pool");
+    // A typo must not read as 0 and turn the pool off.
+    for (const char* bad : {"auto", "4x", " ", "-2", "99999999999"}) {
+        setenv("XRD_OPENVERIFY_EXECUTOR_THREADS", bad, 1);
+        Expect(OpenVerifyExecutor(metrics).Threads() == 32, std::string("bad value falls back: ") + bad);
+    }
+    unsetenv("XRD_OPENVERIFY_EXECUTOR_THREADS");
+}
+
+void Test_IdleWorkersStealFromBusyOne() {
+    OpenVerifyMetrics metrics;
+    OpenVerifyExecutor pool(metrics, 4);
+    std::atomic<int> ran{0};
+    // One job fans out from a worker: its children land on that worker's own deque, and the
+    // other workers can only get at them by stealing.
+    pool.Submit([&]() {
+        std::vector<std::shared_ptr<OpenVerifyExecutor::Completion>> children;
+        for (int i = 0; i < 64; ++i) {
+            children.push_back(pool.Submit([&]() {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                ran.fetch_add(1);
+            }));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    })->Wait();
+    for (int i = 0; i < 200 && ran.load() < 64; ++i) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    Expect(ran.load() == 64, "every child job should run");
+    Expect(pool.Steals() > 0, "idle workers should steal from the busy worker's deque");
+
+    const std::string body = metrics.BuildExpositionBody();
+    Expect(body.find("xrootd_openverify_executor_threads 4\n") != std::string::npos, "pool size gauge");
+    Expect(body.find("xrootd_openverify_executor_steals_total ") != std::string::npos, "steal counter");
+    Expect(body.find("xrootd_openverify_executor_jobs_total 65\n") != std::string::npos, "job counter");
+}
+
+void Test_DestructorDrainsQueuedJobs() {
+    std::atomic<int> ran{0};
+    {
+        OpenVerifyMetrics metrics;
+        OpenVerifyExecutor pool(metrics, 1);
+        for (int i = 0; i < 16; ++i) pool.Submit([&]() { ran.fetch_add(1); });
+    }
+    Expect(ran.load() == 16, "queued jobs should run before the pool shuts down");
+}
+
+}  // namespace
+
+int main() {
+    // Unlabelled samples and no metrics file.
+    setenv("XRD_OPENVERIFY_METRICS_PATH", "", 1);
+    setenv("XRD_OPENVERIFY_METRICS_INSTANCE", "", 1);
+
+    Test_SubmitRunsOnPool();
+    Test_ThrowingJobCompletes();
+    Test_ZeroThreadsRunsInline();
+    Test_ThreadsFromEnv();
+    Test_IdleWorkersStealFromBusyOne();
+    Test_DestructorDrainsQueuedJobs();
+
+    if (g_failures) {
+        std::cerr << g_failures << " test(s) failed.\n";
+        return 1;
+    }
+    std::cout << "All tests passed.\n";
+    return 0;
+}
@@ -0,0 +1,171 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "OpenVerifyHostReliability.hh"
+
+using Clock = std::chrono::steady_clock;
+using State = OpenVerifyHostReliability::BreakerState;
+
+namespace {
+
+int g_failures = 0;
+
+void Expect(bool cond, const std::string& msg) {
+    if (!cond) {
+        ++g_failures;
+        std::cerr << "FAIL: " << msg << "\n";
+    }
+}
+
+// Any errSocketError-class code carries full failure weight.
+constexpr uint16_t kNetworkError = 101;
+
+// Drive a host into the open state: enough failures inside one window to cross both gates.
+Clock::time_point OpenHost(OpenVerifyHostReliability& rel, const std::string& host, Clock::time_point t0) {
+    for (int i = 0; i < 40; ++i) {
+        rel.RecordVerifyFailure(host, 1094, kNetworkError, t0 + std::chrono::milliseconds(10 * i));
+    }
+    return t0 + std::chrono::seconds(1);
+}
+
+void Test_OpensAfterSustainedFailures() {
+    OpenVerifyMetrics metrics;
+    OpenVerifyHostReliability rel(metrics);
+    const auto t0 = Clock::time_point{} + std::chrono::hours(1);
+    Expect(!rel.AvoidSite("h", 1094, t0), "OpensAfterSustainedFailures: unknown host is not avoided");
+    const auto t1 = OpenHost(rel, "h", t0);
+    Expect(rel.State("h", 1094) == State::Open, "OpensAfterSustainedFailures: breaker should be open");
+    Expect(rel.AvoidSite("h", 1094, t1), "OpensAfterSustainedFailures: open host should be avoided");
+}
+
+void Test_StaleFailuresFallOutOfWindow() {
+    OpenVerifyMetrics metrics;
+    OpenVerifyHostReliability rel(metrics);
+    const auto t0 = Clock::time_point{} + std::chrono::hours(1);
+    // 15 failures, then a long quiet period, then 15 more: never 20 inside one window.
+    for (int i = 0; i < 15; ++i) rel.RecordVerifyFailure("h", 1094, kNetworkError, t0);
+    const auto later = t0 + std::chrono::hours(24);
+    for (int i = 0; i < 15; ++i) rel.RecordVerifyFailure("h", 1094, kNetworkError, later);
+    Expect(rel.State("h", 1094) == State::Closed, "StaleFailures: old failures must not count toward the gate");
+}
+
+void Test_HalfOpenAdmitsLimitedTrialsAndCloses() {
+    OpenVerifyMetrics metrics;
+    OpenVerifyHostReliability rel(metrics);
+    const auto t0 = Clock::time_point{} + std::chrono::hours(1);
+    OpenHost(rel, "h", t0);
+
+    // Past the (jittered) cooldown the breaker goes half-open and admits three trials.
+    const auto probe = t0 + std::chrono::minutes(5);
+    Expect(!rel.AvoidSite("h", 1094, probe), "HalfOpen: first trial admitted");
+    Expect(rel.State("h", 1094) == State::HalfOpen, "HalfOpen: breaker should be half-open");
+    Expect(!rel.AvoidSite("h", 1094, probe), "HalfOpen: second trial admitted");
+    Expect(!rel.AvoidSite("h", 1094, probe), "HalfOpen: third trial admitted");
+    Expect(rel.AvoidSite("h", 1094, probe), "HalfOpen: fourth concurrent trial rejected");
+
+    rel.RecordVerifySuccess("h", 1094, probe);
+    Expect(rel.State("h", 1094) == State::HalfOpen, "HalfOpen: one success is not enough to close");
+    rel.RecordVerifySuccess("h", 1094, probe);
+    Expect(rel.State("h", 1094) == State::Closed, "HalfOpen: two of three successes close the breaker");
+    Expect(!rel.AvoidSite("h", 1094, probe), "HalfOpen: closed host is no longer avoided");
+}
+
+void Test_HalfOpenReopensOnFailedTrials() {
+    OpenVerifyMetrics metrics;
+    OpenVerifyHostReliability rel(metrics);
+    const auto t0 = Clock::time_point{} + std::chrono::hours(1);
+    OpenHost(rel, "h", t0);
+
+    const auto probe = t0 + std::chrono::minutes(5);
+    Expect(!rel.AvoidSite("h", 1094, probe), "Reopen: trial admitted");
+    rel.RecordVerifyFailure("h", 1094, kNetworkError, probe);
+    rel.RecordVerifyFailure("h", 1094, kNetworkError, probe);
+    Expect(rel.State("h", 1094) == State::Open, "Reopen: two failed trials re-open the breaker");
+    Expect(rel.AvoidSite("h", 1094, probe + std::chrono::seconds(1)), "Reopen: host avoided during new cooldown");
+}
+
+void Test_OutcomesBeyondAdmittedTrials() {
+    OpenVerifyMetrics metrics;
+    OpenVerifyHostReliability rel(metrics);
+    const auto t0 = Clock::time_point{} + std::chrono::hours(1);
+    OpenHost(rel, "h", t0);
+
+    const auto probe = t0 + std::chrono::minutes(5);
+    Expect(!rel.AvoidSite("h", 1094, probe), "Unadmitted: trial admitted");
+    // One admitted trial, two outcomes: one from a verify that started before the half-open.
+    rel.RecordVerifySuccess("h", 1094, probe);
+    rel.RecordVerifyFailure("h", 1094, kNetworkError, probe);
+    Expect(rel.State("h", 1094) == State::HalfOpen, "Unadmitted: round still undecided");
+    Expect(!rel.AvoidSite("h", 1094, probe + std::chrono::seconds(1)), "Unadmitted: trial slots still free");
+}
+
+void Test_UnresolvedTrialsReleaseAfterDeadline() {
+    OpenVerifyMetrics metrics;
+    OpenVerifyHostReliability rel(metrics);
+    const auto t0 = Clock::time_point{} + std::chrono::hours(1);
+    OpenHost(rel, "h", t0);
+
+    const auto probe = t0 + std::chrono::minutes(5);
+    for (int i = 0; i < 3; ++i) rel.AvoidSite("h", 1094, probe);
+    Expect(rel.AvoidSite("h", 1094, probe), "TrialDeadline: slots exhausted");
+    // No outcome ever reported (e.g. positive cache hits); slots come back after the deadline.
+    Expect(!rel.AvoidSite("h", 1094, probe + std::chrono::minutes(5)), "TrialDeadline: slot released");
+}
+
+std::string ReadFile(const std::string& path) {
+    std::ifstream in(path);
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+void Test_GaugesExportedWithHostCap() {
+    const std::string path = "/tmp/openverify_host_reliability_test.prom";
+    setenv("XRD_OPENVERIFY_METRICS_PATH", path.c_str(), 1);
+    setenv("XRD_OPENVERIFY_HOST_METRICS_MAX", "1", 1);
+    {
+        OpenVerifyMetrics metrics;
+        OpenVerifyHostReliability rel(metrics);
+        const auto t0 = Clock::now();
+        rel.RecordVerifySuccess("good", 1094, t0);
+        OpenHost(rel, "bad", t0);
+        metrics.Flush();
+
+        const std::string body = ReadFile(path);
+        Expect(body.find("xrootd_openverify_host_breaker_state{host=\"bad\",port=\"1094\"} 1") != std::string::npos,
+               "Gauges: open host exported with breaker state 1");
+        Expect(body.find("host=\"good\"") == std::string::npos, "Gauges: host cap keeps only the worst host");
+        Expect(body.find("xrootd_openverify_hosts{state=\"closed\"} 1") != std::string::npos,
+               "Gauges: aggregate host count covers hosts beyond the cap");
+    }
+    std::remove(path.c_str());
+    setenv("XRD_OPENVERIFY_METRICS_PATH", "", 1);
+    unsetenv("XRD_OPENVERIFY_HOST_METRICS_MAX");
+}
+
+}  // namespace
+
+int main() {
+    setenv("XRD_OPENVERIFY_METRICS_PATH", "", 1);
+    setenv("XRD_OPENVERIFY_METRICS_INSTANCE", "", 1);
+
+    Test_OpensAfterSustainedFailures();
+    Test_StaleFailuresFallOutOfWindow();
+    Test_HalfOpenAdmitsLimitedTrialsAndCloses();
+    Test_HalfOpenReopensOnFailedTrials();
+    Test_OutcomesBeyondAdmittedTrials();
+    Test_UnresolvedTrialsReleaseAfterDeadline();
+    Test_GaugesExportedWithHostCap();
+
+    if (g_failures) {
+        std::cerr << g_failures << " test(s) failed.\n";
+        return 1;
+    }
+    std::cout << "All tests passed.\n";
+    return 0;
+}
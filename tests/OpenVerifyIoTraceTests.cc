@@ -0,0 +1,116 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "OpenVerifyIoTrace.hh"
+
+using Op = OpenVerifyIoTrace::Op;
+
+namespace {
+
+int g_failures = 0;
+
+void Expect(bool cond, const std::string& msg) {
+    if (!cond) {
+        ++g_failures;
+        std::cerr << "FAIL: " << msg << "\n";
+    }
+}
+
+void Test_OffByDefault() {
+    unsetenv("XRD_OPENVERIFY_IO_SAMPLE");
+    OpenVerifyMetrics metrics;
+    OpenVerifyIoTrace trace(metrics);
+    Expect(!trace.Enabled(), "Off: sampling is off without XRD_OPENVERIFY_IO_SAMPLE");
+    Expect(metrics.BuildExpositionBody().find("xrootd_openverify_io_") == std::string::npos,
+           "Off: nothing is exported");
+}
+
+void Test_SamplesOneInN() {
+    OpenVerifyMetrics metrics;
+    OpenVerifyIoTrace trace(metrics, 4, std::chrono::milliseconds(100), 8);
+    Expect(trace.Enabled(), "Sample: enabled with a rate");
+    // Each thread keeps its own countdown; start on a fresh one.
+    int sampled = 0;
+    std::thread([&] {
+        for (int i = 0; i < 100; ++i) sampled += trace.Sample() ? 1 : 0;
+    }).join();
+    Expect(sampled == 25, "Sample: one call in four is timed");
+
+    OpenVerifyIoTrace every(metrics, 1, std::chrono::milliseconds(100), 8);
+    bool all = true;
+    for (int i = 0; i < 10; ++i) all = all && every.Sample();
+    Expect(all, "Sample: a rate of 1 times every call");
+}
+
+void Test_CountsAndHistograms() {
+    OpenVerifyMetrics metrics;
+    OpenVerifyIoTrace trace(metrics, 1, std::chrono::milliseconds(100), 8);
+    trace.Count(Op::Read, 4096);
+    trace.Count(Op::Read, 4096);
+    trace.Count(Op::Sync, 0);
+    trace.Observe(Op::Read, std::chrono::milliseconds(2), "/store/a", 0, 4096);
+
+    const std::string body = metrics.BuildExpositionBody();
+    Expect(body.find("xrootd_openverify_io_calls_total{op=\"read\"} 2\n") != std::string::npos,
+           "Counts: calls per operation");
+    Expect(body.find("xrootd_openverify_io_calls_total{op=\"sync\"} 1\n") != std::string::npos,
+           "Counts: calls without bytes");
+    Expect(body.find("xrootd_openverify_io_bytes_total{op=\"read\"} 8192\n") != std::string::npos,
+           "Counts: bytes per operation");
+    Expect(body.find("xrootd_openverify_io_duration_seconds_count{op=\"read\"} 1\n") != std::string::npos,
+           "Counts: sampled durations go to the operation's histogram");
+    Expect(body.find("xrootd_openverify_io_slow_total 0\n") != std::string::npos, "Counts: fast call is not slow");
+}
+
+void Test_SlowRingKeepsNewest() {
+    OpenVerifyMetrics metrics;
+    OpenVerifyIoTrace trace(metrics, 1, std::chrono::milliseconds(10), 2);
+    Expect(trace.Observe(Op::Read, std::chrono::milliseconds(50), "/store/a", 0, 10) == 1, "Slow: first one logged");
+    Expect(trace.Observe(Op::Write, std::chrono::milliseconds(5), "/store/fast", 0, 10) == 0, "Slow: fast call is not");
+    Expect(trace.Observe(Op::SendData, std::chrono::milliseconds(60), "/store/b", 1024, 20) == 0,
+           "Slow: next one within the interval not logged");
+    trace.Observe(Op::PgRead, std::chrono::milliseconds(70), "/store/\"c\"", 2048, 30);
+
+    const std::vector<OpenVerifyIoTrace::SlowOp> slow = trace.SlowOps();
+    Expect(slow.size() == 2, "Slow: ring holds its capacity");
+    Expect(slow.size() == 2 && slow[0].path == "/store/\"c\"" && slow[1].path == "/store/b",
+           "Slow: newest first, oldest dropped");
+    Expect(slow.size() == 2 && slow[0].seq == 2 && slow[1].op == Op::SendData && slow[1].offset == 1024,
+           "Slow: entry fields");
+
+    const std::string body = metrics.BuildExpositionBody();
+    Expect(body.find("xrootd_openverify_io_slow_total 3\n") != std::string::npos, "Slow: total counts every slow call");
+    Expect(body.find("xrootd_openverify_io_slow_op_seconds{op=\"pgread\",slot=\"0\"} 0.07\n") != std::string::npos,
+           "Slow: newest entry in slot 0");
+    Expect(body.find("xrootd_openverify_io_slow_op_seconds{op=\"senddata\",slot=\"1\"} 0.06\n") != std::string::npos,
+           "Slow: older entry in slot 1");
+    Expect(body.find("path=") == std::string::npos, "Slow: paths stay out of the labels");
+
+    std::this_thread::sleep_for(OpenVerifyIoTrace::kSlowLogInterval + std::chrono::milliseconds(20));
+    Expect(trace.Observe(Op::Read, std::chrono::milliseconds(50), "/store/d", 0, 10) == 3,
+           "Slow: next line reports the calls not logged");
+}
+
+}  // namespace
+
+int main() {
+    // Unlabelled samples and no metrics file.
+    setenv("XRD_OPENVERIFY_METRICS_PATH", "", 1);
+    setenv("XRD_OPENVERIFY_METRICS_INSTANCE", "", 1);
+
+    Test_OffByDefault();
+    Test_SamplesOneInN();
+    Test_CountsAndHistograms();
+    Test_SlowRingKeepsNewest();
+
+    if (g_failures) {
+        std::cerr << g_failures << " test(s) failed.\n";
+        return 1;
+    }
+    std::cout << "All tests passed.\n";
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "OpenVerifyLatencyHistogram.hh"
+
+namespace {
+
+int g_failures = 0;
+
+void Expect(bool cond, const std::string& msg) {
+    if (!cond) {
+        ++g_failures;
+        std::cerr << "FAIL: " << msg << "\n";
+    }
+}
+
+bool Contains(const std::string& haystack, const std::string& needle) {
+    return haystack.find(needle) != std::string::npos;
+}
+
+void Test_CumulativeBucketsAndSum() {
+    OpenVerifyLatencyHistogram h;
+    h.Observe(std::chrono::microseconds(50));   // < 0.0001
+    h.Observe(std::chrono::milliseconds(3));    // <= 0.005
+    h.Observe(std::chrono::milliseconds(700));  // <= 1
+    h.Observe(std::chrono::seconds(30));        // +Inf only
+
+    std::ostringstream out;
+    h.WriteTo(out, "x", "");
+    const std::string body = out.str();
+    Expect(Contains(body, "x_bucket{le=\"0.0001\"} 1\n"), "Cumulative: 50us in first bucket");
+    Expect(Contains(body, "x_bucket{le=\"0.0025\"} 1\n"), "Cumulative: 3ms not under 2.5ms");
+    Expect(Contains(body, "x_bucket{le=\"0.005\"} 2\n"), "Cumulative: 3ms under 5ms");
+    Expect(Contains(body, "x_bucket{le=\"1\"} 3\n"), "Cumulative: 700ms under 1s");
+    Expect(Contains(body, "x_bucket{le=\"10\"} 3\n"), "Cumulative: 30s above last finite bound");
+    Expect(Contains(body, "x_bucket{le=\"+Inf\"} 4\n"), "Cumulative: +Inf equals count");
+    Expect(Contains(body, "x_count 4\n"), "Count: four observations");
+    Expect(Contains(body, "x_sum 30.703050\n"), "Sum: exact microsecond sum in seconds");
+}
+
+void Test_LabelsAndNegativeDurations() {
+    OpenVerifyLatencyHistogram h;
+    h.Observe(std::chrono::microseconds(-5));
+    std::ostringstream out;
+    h.WriteTo(out, "y", "step=\"open\"");
+    const std::string body = out.str();
+    Expect(Contains(body, "y_bucket{step=\"open\",le=\"0.0001\"} 1\n"), "Labels: le appended after labels");
+    Expect(Contains(body, "y_sum{step=\"open\"} 0.000000\n"), "Negative: clamped to zero");
+    Expect(Contains(body, "y_count{step=\"open\"} 1\n"), "Labels: count carries labels");
+}
+
+}  // namespace
+
+int main() {
+    Test_CumulativeBucketsAndSum();
+    Test_LabelsAndNegativeDurations();
+
+    if (g_failures) {
+        std::cerr << g_failures << " test(s) failed.\n";
+        return 1;
+    }
+    std::cout << "All tests passed.\n";
+    return 0;
+}
@@ -0,0 +1,162 @@
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "OpenVerifyLog.hh"
+
+namespace {
+
+int g_failures = 0;
+
+void Expect(bool cond, const std::string& msg) {
+    if (!cond) {
+        ++g_failures;
+        std::cerr << "FAIL: " << msg << "\n";
+    }
+}
+
+struct Line {
+    OpenVerifyLog::Level level;
+    std::string text;
+};
+
+// Collects what the drain thread writes.
+struct Collector {
+    std::mutex mtx;
+    std::vector<Line> lines;
+
+    OpenVerifyLog::Sink Sink() {
+        return [this](OpenVerifyLog::Level level, const char* line) {
+            std::lock_guard<std::mutex> lk(mtx);
+            lines.push_back({level, line});
+        };
+    }
+    std::vector<Line> Take() {
+        std::lock_guard<std::mutex> lk(mtx);
+        return lines;
+    }
+};
+
+void Test_LevelFiltering() {
+    Collector out;
+    OpenVerifyLog log(out.Sink(), OpenVerifyLog::Level::Info, 64);
+    int formatted = 0;
+    auto counted = [&formatted]() {
+        ++formatted;
+        return "x";
+    };
+    log.Debug("hidden");
+    if (log.Enabled(OpenVerifyLog::Level::Debug)) log.Debug(counted());
+    log.Info("shown");
+    log.SetLevel(OpenVerifyLog::Level::Error);
+    log.Warn("hidden too");
+    log.Error("error");
+    log.Flush();
+
+    const std::vector<Line> lines = out.Take();
+    Expect(formatted == 0, "Filter: Enabled() lets callers skip building disabled arguments");
+    Expect(lines.size() == 2, "Filter: only messages at or above the level reach the sink");
+    Expect(lines.size() == 2 && lines[0].text == "shown" && lines[0].level == OpenVerifyLog::Level::Info,
+           "Filter: info line");
+    Expect(lines.size() == 2 && lines[1].text == "error" && lines[1].level == OpenVerifyLog::Level::Error,
+           "Filter: error line after SetLevel");
+    Expect(std::string(OpenVerifyLog::LevelName(OpenVerifyLog::Level::Warn)) == " WARN", "LevelName: XrdSysError tag");
+}
+
+void Test_Formatting() {
+    Collector out;
+    OpenVerifyLog log(out.Sink(), OpenVerifyLog::Level::Debug, 64);
+    const std::string s = "str";
+    const char* null_str = nullptr;
+    log.Info("rc =", -42, s, std::string_view("view"), 18446744073709551615ull, null_str);
+    log.Info(std::string(2 * OpenVerifyLog::kLineMax, 'a'));
+    log.Flush();
+
+    const std::vector<Line> lines = out.Take();
+    Expect(lines.size() == 2, "Format: both lines written");
+    if (lines.size() != 2) return;
+    Expect(lines[0].text == "rc = -42 str view 18446744073709551615 (null)", "Format: arguments joined by spaces");
+    Expect(lines[1].text.size() == OpenVerifyLog::kLineMax, "Format: long lines are cut at kLineMax");
+    Expect(lines[1].text.compare(lines[1].text.size() - 3, 3, "...") == 0, "Format: cut lines end in ...");
+}
+
+void Test_ProducersKeepTheirOrder() {
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 2000;
+    Collector out;
+    {
+        OpenVerifyLog log(out.Sink(), OpenVerifyLog::Level::Debug, 1 << 15);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < kThreads; ++t) {
+            threads.emplace_back([&log, t]() {
+                for (int i = 0; i < kPerThread; ++i) log.Info(t, i);
+            });
+        }
+        for (std::thread& th : threads) th.join();
+        Expect(log.Dropped() == 0, "Order: nothing dropped with room in the ring");
+    }
+
+    // The destructor drained everything.
+    const std::vector<Line> lines = out.Take();
+    Expect(lines.size() == static_cast<size_t>(kThreads * kPerThread), "Order: every message written");
+    std::vector<int> next(kThreads, 0);
+    bool ordered = true;
+    for (const Line& line : lines) {
+        const int t = std::stoi(line.text);
+        const int i = std::stoi(line.text.substr(line.text.find(' ') + 1));
+        if (t < 0 || t >= kThreads || i != next[t]) {
+            ordered = false;
+            break;
+        }
+        ++next[t];
+    }
+    Expect(ordered, "Order: each producer's messages arrive in the order they were logged");
+}
+
+void Test_FullRingDropsAndReports() {
+    std::atomic<bool> release{false};
+    Collector out;
+    {
+        OpenVerifyLog log(
+            [&](OpenVerifyLog::Level level, const char* line) {
+                while (!release.load()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                out.Sink()(level, line);
+            },
+            OpenVerifyLog::Level::Debug, 4);
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < 100; ++i) log.Info("msg", i);
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        Expect(elapsed < std::chrono::seconds(1), "Drop: callers do not wait on a blocked sink");
+        Expect(log.Dropped() >= 95, "Drop: messages beyond the ring are dropped and counted");
+        release = true;
+        log.Flush();
+    }
+
+    const std::vector<Line> lines = out.Take();
+    bool reported = false;
+    for (const Line& line : lines) {
+        if (line.level == OpenVerifyLog::Level::Warn && line.text.find("dropped") != std::string::npos) reported = true;
+    }
+    Expect(reported, "Drop: the drain thread reports dropped messages");
+    Expect(!lines.empty() && lines[0].text == "msg 0", "Drop: the first messages were kept");
+}
+
+}  // namespace
+
+int main() {
+    Test_LevelFiltering();
+    Test_Formatting();
+    Test_ProducersKeepTheirOrder();
+    Test_FullRingDropsAndReports();
+
+    if (g_failures) {
+        std::cerr << g_failures << " test(s) failed.\n";
+        return 1;
+    }
+    std::cout << "All tests passed.\n";
+    return 0;
+}
@@ -0,0 +1,128 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+#include "OpenVerifyMetrics.hh"
+#include "OpenVerifyMetricsHttp.hh"
+
+namespace {
+
+int g_failures = 0;
+
+void Expect(bool cond, const std::string& msg) {
+    if (!cond) {
+        ++g_failures;
+        std::cerr << "FAIL: " << msg << "\n";
+    }
+}
+
+// Sends one raw request to 127.0.0.1:port and returns everything read until the server closes.
+std::string Request(uint16_t port, const std::string& raw) {
+    const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return {};
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    ::inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    std::string out;
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0) {
+        (void)!::send(fd, raw.data(), raw.size(), 0);
+        char buf[4096];
+        ssize_t r;
+        while ((r = ::recv(fd, buf, sizeof(buf), 0)) > 0) out.append(buf, static_cast<size_t>(r));
+    }
+    ::close(fd);
+    return out;
+}
+
+void Test_ServesMetricsRenderedPerScrape() {
+    std::atomic<int> renders{0};
+    OpenVerifyMetricsHttpServer server([&] { return "scrape " + std::to_string(++renders) + "\n"; });
+    Expect(server.Start("127.0.0.1", 0), "Serve: server should start on an ephemeral port");
+    Expect(server.Port() != 0, "Serve: bound port reported");
+    Expect(renders.load() == 0, "Serve: nothing rendered before the first scrape");
+
+    const std::string r1 = Request(server.Port(), "GET /metrics HTTP/1.1\r\nHost: x\r\n\r\n");
+    Expect(r1.rfind("HTTP/1.1 200 OK\r\n", 0) == 0, "Serve: 200 for /metrics");
+    Expect(r1.find("Content-Type: text/plain; version=0.0.4") != std::string::npos, "Serve: exposition content type");
+    Expect(r1.find("\r\n\r\nscrape 1\n") != std::string::npos, "Serve: body rendered on scrape");
+
+    const std::string r2 = Request(server.Port(), "GET /metrics?x=1 HTTP/1.0\r\n\r\n");
+    Expect(r2.find("\r\n\r\nscrape 2\n") != std::string::npos, "Serve: each scrape renders again");
+    server.Stop();
+}
+
+void Test_RejectsOtherPathsAndMethods() {
+    OpenVerifyMetricsHttpServer server([] { return std::string("body\n"); });
+    Expect(server.Start("127.0.0.1", 0), "Reject: server should start");
+    Expect(Request(server.Port(), "GET / HTTP/1.1\r\n\r\n").rfind("HTTP/1.1 404", 0) == 0, "Reject: 404 for /");
+    Expect(Request(server.Port(), "POST /metrics HTTP/1.1\r\n\r\n").rfind("HTTP/1.1 405", 0) == 0,
+           "Reject: 405 for POST");
+    Expect(Request(server.Port(), "garbage\r\n\r\n").rfind("HTTP/1.1 400", 0) == 0, "Reject: 400 for bad line");
+    const std::string head = Request(server.Port(), "HEAD /metrics HTTP/1.1\r\n\r\n");
+    Expect(head.rfind("HTTP/1.1 200", 0) == 0 && head.find("body") == std::string::npos, "Reject: HEAD has no body");
+}
+
+void Test_StartFailureReported() {
+    OpenVerifyMetricsHttpServer taken([] { return std::string(); });
+    Expect(taken.Start("127.0.0.1", 0), "Fail: first server should start");
+    OpenVerifyMetricsHttpServer second([] { return std::string(); });
+    Expect(!second.Start("127.0.0.1", taken.Port()), "Fail: port in use is refused");
+    Expect(second.StartError() == EADDRINUSE, "Fail: errno kept");
+    OpenVerifyMetricsHttpServer bad([] { return std::string(); });
+    Expect(!bad.Start("localhost:x", 0) && bad.StartError() == EINVAL, "Fail: bad address is EINVAL");
+
+    // Without the endpoint the default textfile stays on, in the working directory.
+    char dir_template[] = "/tmp/openverify_http_XXXXXX";
+    const char* dir = ::mkdtemp(dir_template);
+    Expect(dir != nullptr, "Fail: temp dir");
+    if (!dir) return;
+    const std::filesystem::path old_cwd = std::filesystem::current_path();
+    std::filesystem::current_path(dir);
+    unsetenv("XRD_OPENVERIFY_METRICS_PATH");
+    setenv("XRD_OPENVERIFY_METRICS_HTTP_PORT", std::to_string(taken.Port()).c_str(), 1);
+    {
+        OpenVerifyMetrics metrics;
+        Expect(metrics.HttpPort() == 0, "Fail: no endpoint");
+        Expect(metrics.HttpStartError().find("127.0.0.1:" + std::to_string(taken.Port()) + ": ") == 0,
+               "Fail: error names the address");
+        Expect(metrics.FileExportEnabled(), "Fail: default textfile kept");
+    }
+    {
+        taken.Stop();
+        OpenVerifyMetrics metrics;
+        Expect(metrics.HttpPort() != 0 && metrics.HttpStartError().empty(), "Fail: endpoint serves once free");
+        Expect(!metrics.FileExportEnabled(), "Fail: endpoint replaces the default textfile");
+    }
+    unsetenv("XRD_OPENVERIFY_METRICS_HTTP_PORT");
+    setenv("XRD_OPENVERIFY_METRICS_PATH", "", 1);
+    std::filesystem::current_path(old_cwd);
+    std::filesystem::remove_all(dir);
+}
+
+}  // namespace
+
+int main() {
+    // No metrics file.
+    setenv("XRD_OPENVERIFY_METRICS_PATH", "", 1);
+    setenv("XRD_OPENVERIFY_METRICS_INSTANCE", "", 1);
+    Test_ServesMetricsRenderedPerScrape();
+    Test_RejectsOtherPathsAndMethods();
+    Test_StartFailureReported();
+
+    if (g_failures) {
+        std::cerr << g_failures << " test(s) failed.\n";
+        return 1;
+    }
+    std::cout << "All tests passed.\n";
+    return 0;
+}
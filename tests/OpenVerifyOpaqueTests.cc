@@ -0,0 +1,84 @@
+#include <iostream>
+#include <string>
+
+#include "OpenVerifyOpaque.hh"
+
+namespace {
+
+int g_failures = 0;
+
+void Expect(bool cond, const std::string& msg) {
+    if (!cond) {
+        ++g_failures;
+        std::cerr << "FAIL: " << msg << "\n";
+    }
+}
+
+std::string WithTried(const char* opaque, const std::string& tried) {
+    const OpenVerifyOpaque parsed(opaque);
+    std::string out;
+    parsed.AppendWithTried(out, tried);
+    Expect(out.size() == parsed.SizeWithTried(tried), "SizeWithTried should match what AppendWithTried adds");
+    return out;
+}
+
+void Test_SplitsPairs() {
+    const OpenVerifyOpaque o("?a=1&&b&c=x=y&");
+    Expect(o.Raw() == "a=1&&b&c=x=y&", "Split: leading '?' is dropped");
+    Expect(o.Size() == 3, "Split: empty pairs are skipped");
+    Expect(o[0].name == "a" && o[0].value == "1", "Split: name and value");
+    Expect(o[1].name == "b" && o[1].value.empty(), "Split: pair without '='");
+    Expect(o[2].name == "c" && o[2].value == "x=y", "Split: value keeps later '='");
+    Expect(o.Find("c") == "x=y" && o.Find("d").empty(), "Split: Find by exact name");
+    Expect(o.Has("b") && !o.Has("B"), "Split: names are case-sensitive");
+
+    const OpenVerifyOpaque none(static_cast<const char*>(nullptr));
+    Expect(none.Size() == 0 && none.Raw().empty(), "Split: null opaque is empty");
+}
+
+void Test_ManyPairsOverflowInlineIndex() {
+    std::string s;
+    for (int i = 0; i < 40; ++i) s += "k" + std::to_string(i) + "=" + std::to_string(i) + "&";
+    const OpenVerifyOpaque o(s.c_str());
+    Expect(o.Size() == 40, "Overflow: every pair is indexed");
+    Expect(o.Find("k0") == "0" && o.Find("k39") == "39", "Overflow: pairs past the inline index are found");
+}
+
+void Test_FindToken() {
+    std::string token;
+    Expect(OpenVerifyOpaque("x=1&authz=Bearer%20abc.def").FindToken(token) && token == "abc.def",
+           "Token: authz with encoded Bearer prefix");
+    Expect(OpenVerifyOpaque("ACCESS_TOKEN=+tok+").FindToken(token) && token == "tok",
+           "Token: name case-insensitive, '+' decoded and trimmed");
+    Expect(OpenVerifyOpaque("acc%65ss_token=t1").FindToken(token) && token == "t1", "Token: encoded name");
+    Expect(OpenVerifyOpaque("token=&bearer=t2").FindToken(token) && token == "t2", "Token: empty value skipped");
+    Expect(OpenVerifyOpaque("authorization=Bearer%20%20x%20").FindToken(token) && token == "x",
+           "Token: whitespace around the prefixed token is trimmed");
+    Expect(!OpenVerifyOpaque("tokens=t&xtoken=t").FindToken(token), "Token: only exact names count");
+}
+
+void Test_AppendWithTried() {
+    Expect(WithTried("a=1", "") == "a=1", "Tried: nothing to add");
+    Expect(WithTried("", "h1:1094") == "tried=h1:1094", "Tried: empty opaque");
+    Expect(WithTried("?a=1", "h1:1094") == "a=1&tried=h1:1094", "Tried: new pair appended");
+    Expect(WithTried("tried=h0&a=1", "h1,h2") == "tried=h0,h1,h2&a=1", "Tried: merged into existing list");
+    Expect(WithTried("a=1&tried=h0", "h1") == "a=1&tried=h0,h1", "Tried: existing list at the end");
+    Expect(WithTried("a=1&tried", "h1") == "a=1&tried&tried=h1", "Tried: bare name is not a list");
+    Expect(WithTried("triedrc=enoent", "h1") == "triedrc=enoent&tried=h1", "Tried: other names are left alone");
+}
+
+}  // namespace
+
+int main() {
+    Test_SplitsPairs();
+    Test_ManyPairsOverflowInlineIndex();
+    Test_FindToken();
+    Test_AppendWithTried();
+
+    if (g_failures) {
+        std::cerr << g_failures << " test(s) failed.\n";
+        return 1;
+    }
+    std::cout << "All tests passed.\n";
+    return 0;
+}
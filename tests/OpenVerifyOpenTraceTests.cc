@@ -0,0 +1,240 @@
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "OpenVerifyOpenTrace.hh"
+
+using CacheResult = OpenVerifyOpenTrace::CacheResult;
+using Role = OpenVerifyOpenTrace::Role;
+using Step = OpenVerifyMetrics::XrdClStep;
+
+namespace {
+
+int g_failures = 0;
+
+void Expect(bool cond, const std::string& msg) {
+    if (!cond) {
+        ++g_failures;
+        std::cerr << "FAIL: " << msg << "\n";
+    }
+}
+
+std::string TempPath(const char* name) {
+    return "/tmp/openverify_open_trace_" + std::to_string(getpid()) + "_" + name + ".jsonl";
+}
+
+std::vector<std::string> ReadLines(const std::string& path) {
+    std::vector<std::string> lines;
+    std::ifstream in(path);
+    for (std::string line; std::getline(in, line);) lines.push_back(line);
+    return lines;
+}
+
+bool Contains(const std::string& s, const std::string& part) { return s.find(part) != std::string::npos; }
+
+void Test_OffWithoutPath() {
+    unsetenv("XRD_OPENVERIFY_TRACE_PATH");
+    OpenVerifyOpenTrace trace;
+    Expect(!trace.Enabled(), "Off: tracing is off without XRD_OPENVERIFY_TRACE_PATH");
+    OpenVerifyOpenTrace::Span span(trace, "/store/a");
+    Expect(!span.Active(), "Off: spans are inactive");
+    span.Attempt(-256, std::chrono::milliseconds(1), "h:1094");
+    span.Finish(0, "");
+    trace.Flush();
+    Expect(trace.Dropped() == 0, "Off: nothing kept or dropped");
+    Expect(trace.OpenError() == 0, "Off: no open error without a path");
+    std::ostringstream body;
+    trace.WriteExposition(body, "");
+    Expect(body.str().empty(), "Off: nothing exported");
+}
+
+void Test_UnopenableFileReported() {
+    OpenVerifyOpenTrace trace("/nonexistent_openverify_dir/trace.jsonl", 1, std::chrono::milliseconds(1000), 8);
+    Expect(!trace.Enabled(), "Unopenable: tracing stays off");
+    Expect(trace.OpenError() == ENOENT, "Unopenable: errno kept for the startup warning");
+    Expect(trace.Path() == "/nonexistent_openverify_dir/trace.jsonl", "Unopenable: path kept");
+    OpenVerifyOpenTrace::Span span(trace, "/store/a");
+    Expect(!span.Active(), "Unopenable: spans are inactive");
+}
+
+void Test_RecordsOpenAsJsonLine() {
+    const std::string path = TempPath("json");
+    std::remove(path.c_str());
+    {
+        OpenVerifyOpenTrace trace(path, 1, std::chrono::milliseconds(1000), 8);
+        Expect(trace.Enabled(), "Json: enabled with a path");
+        OpenVerifyOpenTrace::Span span(trace, "/store/\"quoted\"\n");
+        Expect(span.Active(), "Json: span active");
+        span.Resumed();
+        span.Attempt(-256, std::chrono::microseconds(1500), "h1:1094");
+        span.Avoided("h1:1094");
+        span.Attempt(-256, std::chrono::microseconds(700), "h2:1094");
+        span.Cache(CacheResult::Miss);
+        span.SingleFlight(Role::Leader, std::chrono::microseconds(20));
+        span.XrdClStep(Step::Open, std::chrono::microseconds(300), 0);
+        span.XrdClStep(Step::Stat, std::chrono::microseconds(100), 101);
+        span.Verify(101, std::chrono::microseconds(450));
+        span.Finish(-256, "h1:1094");
+        trace.Flush();
+
+        const std::vector<std::string> lines = ReadLines(path);
+        Expect(lines.size() == 1, "Json: one line per open");
+        const std::string line = lines.empty() ? std::string() : lines[0];
+        Expect(line.front() == '{' && line.back() == '}', "Json: line is an object");
+        Expect(Contains(line, "\"path\":\"/store/\\\"quoted\\\"\\u000a\""), "Json: path escaped");
+        Expect(Contains(line, "\"rc\":-256,\"resumed\":true,\"tried\":\"h1:1094\""), "Json: open result");
+        Expect(Contains(line, "\"event\":\"attempt\",\"duration_us\":1500,\"rc\":-256,\"target\":\"h1:1094\""),
+               "Json: first attempt with its target");
+        Expect(Contains(line, "\"event\":\"avoided\",\"target\":\"h1:1094\""), "Json: avoided host");
+        Expect(Contains(line, "\"event\":\"cache\",\"result\":\"miss\""), "Json: cache outcome");
+        Expect(Contains(line, "\"event\":\"single_flight\",\"role\":\"leader\",\"wait_us\":20"),
+               "Json: single-flight role and wait");
+        Expect(Contains(line, "\"event\":\"xrdcl\",\"step\":\"stat\",\"duration_us\":100,\"code\":101"),
+               "Json: XrdCl step with status");
+        Expect(Contains(line, "\"event\":\"verify\",\"duration_us\":450,\"code\":101"), "Json: verify result");
+        Expect(line.find("\"h2:1094\"") > line.find("\"avoided\""), "Json: events in order");
+        Expect(!Contains(line, "events_cut"), "Json: nothing cut");
+    }
+    std::remove(path.c_str());
+}
+
+void Test_SampledOrSlow() {
+    const std::string path = TempPath("sample");
+    std::remove(path.c_str());
+    {
+        // A threshold no open here comes near, so only sampling keeps these.
+        OpenVerifyOpenTrace trace(path, 4, std::chrono::seconds(10), 64);
+        // Each thread keeps its own countdown; start on a fresh one.
+        std::thread([&] {
+            for (int i = 0; i < 9; ++i) {
+                OpenVerifyOpenTrace::Span span(trace, "/store/fast");
+                span.Finish(0, "");
+            }
+        }).join();
+        trace.Flush();
+        int fast = 0;
+        for (const std::string& line : ReadLines(path)) fast += Contains(line, "/store/fast") ? 1 : 0;
+        Expect(fast == 3, "Sample: one open in four kept");
+    }
+    std::remove(path.c_str());
+    {
+        OpenVerifyOpenTrace trace(path, 1000, std::chrono::milliseconds(5), 64);
+        std::thread([&] {
+            // The first open on a thread is sampled; the second is kept only for being slow.
+            OpenVerifyOpenTrace::Span first(trace, "/store/first");
+            first.Finish(0, "");
+            OpenVerifyOpenTrace::Span slow(trace, "/store/slow");
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            slow.Finish(0, "");
+        }).join();
+        trace.Flush();
+        int slow = 0;
+        for (const std::string& line : ReadLines(path)) slow += Contains(line, "/store/slow") ? 1 : 0;
+        Expect(slow == 1, "Sample: slow open kept although not sampled");
+    }
+    std::remove(path.c_str());
+}
+
+void Test_EventsCut() {
+    const std::string path = TempPath("cut");
+    std::remove(path.c_str());
+    {
+        OpenVerifyOpenTrace trace(path, 1, std::chrono::milliseconds(1000), 2);
+        OpenVerifyOpenTrace::Span span(trace, std::string(400, 'p'));
+        for (size_t i = 0; i < OpenVerifyOpenTrace::kMaxEvents + 5; ++i) span.Cache(CacheResult::Negative);
+        span.Finish(-256, std::string(400, 't'));
+        trace.Flush();
+        const std::vector<std::string> lines = ReadLines(path);
+        const std::string line = lines.empty() ? std::string() : lines[0];
+        Expect(Contains(line, "\"events_cut\":true"), "Cut: overflowing events flagged");
+        Expect(Contains(line, "\"" + std::string(OpenVerifyOpenTrace::kTextMax, 'p') + "\""), "Cut: long path cut");
+        Expect(!Contains(line, std::string(OpenVerifyOpenTrace::kTextMax + 1, 't')), "Cut: long tried list cut");
+    }
+    std::remove(path.c_str());
+
+    const OpenVerifyOpenTrace::Record empty{};
+    Expect(OpenVerifyOpenTrace::Format(empty) == "{\"start_us\":0,\"path\":\"\",\"duration_us\":0,\"rc\":0,"
+                                                 "\"resumed\":false,\"tried\":\"\",\"events\":[]}",
+           "Cut: empty record formats");
+}
+
+void Test_FullRingDrops() {
+    const std::string path = TempPath("drop");
+    std::remove(path.c_str());
+    {
+        OpenVerifyOpenTrace trace(path, 1, std::chrono::milliseconds(1000), 4);
+        // Faster than the writer drains: either written or counted as dropped, never lost silently.
+        constexpr int kOpens = 2000;
+        for (int i = 0; i < kOpens; ++i) {
+            OpenVerifyOpenTrace::Span span(trace, "/store/many");
+            span.Finish(0, "");
+        }
+        trace.Flush();
+        const size_t written = ReadLines(path).size();
+        Expect(written + trace.Dropped() == kOpens, "Drop: every kept open written or counted");
+        Expect(written >= 4, "Drop: at least a ring's worth written");
+
+        std::ostringstream body;
+        trace.WriteExposition(body, ",xrootd_instance=\"a\"");
+        Expect(Contains(body.str(), "xrootd_openverify_open_trace_dropped_total{xrootd_instance=\"a\"} " +
+                                        std::to_string(trace.Dropped()) + "\n"),
+               "Drop: dropped traces exported");
+        Expect(Contains(body.str(), "xrootd_openverify_open_trace_written_total{xrootd_instance=\"a\"} " +
+                                        std::to_string(written) + "\n"),
+               "Drop: written traces exported");
+    }
+    std::remove(path.c_str());
+}
+
+void Test_ConcurrentProducers() {
+    const std::string path = TempPath("mt");
+    std::remove(path.c_str());
+    size_t written = 0;
+    uint64_t dropped = 0;
+    {
+        OpenVerifyOpenTrace trace(path, 1, std::chrono::milliseconds(1000), 64);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&trace] {
+                for (int i = 0; i < 200; ++i) {
+                    OpenVerifyOpenTrace::Span span(trace, "/store/mt");
+                    span.Attempt(-256, std::chrono::microseconds(i), "h:1094");
+                    span.Finish(-256, "");
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+        dropped = trace.Dropped();
+    }
+    // The destructor writes out what is still queued.
+    for (const std::string& line : ReadLines(path)) written += Contains(line, "\"target\":\"h:1094\"") ? 1 : 0;
+    Expect(written + dropped == 800, "Concurrent: every open written or counted");
+    std::remove(path.c_str());
+}
+
+}  // namespace
+
+int main() {
+    Test_OffWithoutPath();
+    Test_UnopenableFileReported();
+    Test_RecordsOpenAsJsonLine();
+    Test_SampledOrSlow();
+    Test_EventsCut();
+    Test_FullRingDrops();
+    Test_ConcurrentProducers();
+
+    if (g_failures) {
+        std::cerr << g_failures << " test(s) failed.\n";
+        return 1;
+    }
+    std::cout << "All tests passed.\n";
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "OpenVerifyRedirectCache.hh"
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+int g_failures = 0;
+
+void Expect(bool cond, const std::string& msg) {
+    if (!cond) {
+        ++g_failures;
+        std::cerr << "FAIL: " << msg << "\n";
+    }
+}
+
+void Test_OffByDefault() {
+    unsetenv("XRD_OPENVERIFY_REDIRECT_CACHE_TTL_MS");
+    OpenVerifyRedirectCache cache;
+    Expect(!cache.Enabled(), "OffByDefault: cache should be off without a TTL");
+    cache.Put("/store/f", {"a.example", 1094});
+    OpenVerifyRedirectCache::Target t;
+    Expect(!cache.Get("/store/f", t), "OffByDefault: a disabled cache never answers");
+    Expect(cache.Size() == 0, "OffByDefault: a disabled cache stores nothing");
+}
+
+void Test_TargetLivesForTtl() {
+    OpenVerifyRedirectCache cache(std::chrono::milliseconds(500), 16);
+    const auto t0 = Clock::time_point{} + std::chrono::hours(1);
+    cache.Put("/store/f", {"a.example?cgi=1", 1094}, t0);
+
+    OpenVerifyRedirectCache::Target t;
+    Expect(cache.Get("/store/f", t, t0 + std::chrono::milliseconds(499)), "Ttl: fresh target should be found");
+    Expect(t.host == "a.example?cgi=1" && t.port == 1094, "Ttl: target should round-trip unchanged");
+    Expect(!cache.Get("/store/g", t, t0), "Ttl: other paths are not answered");
+    Expect(!cache.Get("/store/f", t, t0 + std::chrono::milliseconds(500)), "Ttl: expired target is not answered");
+}
+
+void Test_InvalidateOnlyMatchingTarget() {
+    OpenVerifyRedirectCache cache(std::chrono::seconds(10), 16);
+    const auto t0 = Clock::time_point{} + std::chrono::hours(1);
+    cache.Put("/store/f", {"a.example", 1094}, t0);
+
+    Expect(!cache.Invalidate("/store/f", "b.example", 1094), "Invalidate: another host leaves the entry");
+    Expect(!cache.Invalidate("/store/f", "a.example", 1095), "Invalidate: another port leaves the entry");
+    Expect(cache.Invalidate("/store/f", "a.example", 1094), "Invalidate: the cached target is dropped");
+    OpenVerifyRedirectCache::Target t;
+    Expect(!cache.Get("/store/f", t, t0), "Invalidate: dropped target is not answered");
+}
+
+void Test_PutReplacesTarget() {
+    OpenVerifyRedirectCache cache(std::chrono::seconds(10), 16);
+    const auto t0 = Clock::time_point{} + std::chrono::hours(1);
+    cache.Put("/store/f", {"a.example", 1094}, t0);
+    cache.Put("/store/f", {"b.example", 1094}, t0);
+
+    OpenVerifyRedirectCache::Target t;
+    Expect(cache.Get("/store/f", t, t0) && t.host == "b.example", "Replace: latest verified target wins");
+    Expect(cache.Size() == 1, "Replace: one entry per path");
+}
+
+void Test_CapacityDropsOldest() {
+    OpenVerifyRedirectCache cache(std::chrono::seconds(10), 2);
+    const auto t0 = Clock::time_point{} + std::chrono::hours(1);
+    cache.Put("/a", {"h", 1}, t0);
+    cache.Put("/b", {"h", 1}, t0);
+    cache.Put("/c", {"h", 1}, t0);
+
+    OpenVerifyRedirectCache::Target t;
+    Expect(cache.Size() == 2, "Capacity: size stays at the cap");
+    Expect(!cache.Get("/a", t, t0), "Capacity: oldest path is dropped first");
+    Expect(cache.Get("/b", t, t0) && cache.Get("/c", t, t0), "Capacity: newer paths are kept");
+}
+
+}  // namespace
+
+int main() {
+    Test_OffByDefault();
+    Test_TargetLivesForTtl();
+    Test_InvalidateOnlyMatchingTarget();
+    Test_PutReplacesTarget();
+    Test_CapacityDropsOldest();
+
+    if (g_failures) {
+        std::cerr << g_failures << " test(s) failed.\n";
+        return 1;
+    }
+    std::cout << "All tests passed.\n";
+    return 0;
+}
@@ -0,0 +1,85 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "OpenVerifyResumeState.hh"
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+int g_failures = 0;
+
+void Expect(bool cond, const std::string& msg) {
+    if (!cond) {
+        ++g_failures;
+        std::cerr << "FAIL: " << msg << "\n";
+    }
+}
+
+void Test_RetryResumesStalledOpen() {
+    OpenVerifyResumeState state;
+    const auto t0 = Clock::time_point{} + std::chrono::hours(1);
+    const std::string key = OpenVerifyResumeState::Key("user.1:2@client", "/store/f");
+    state.Put(key, {"a:1094,b:1094", 2}, std::chrono::seconds(5), t0);
+
+    OpenVerifyResumeState::Entry e;
+    Expect(state.Take(key, e, t0 + std::chrono::seconds(5)), "RetryResumes: entry should be found on retry");
+    Expect(e.tried_hosts == "a:1094,b:1094" && e.attempts == 2, "RetryResumes: state should round-trip");
+    Expect(!state.Take(key, e, t0 + std::chrono::seconds(6)), "RetryResumes: entry is consumed by the retry");
+}
+
+void Test_KeysSeparateClientsAndPaths() {
+    OpenVerifyResumeState state;
+    const auto t0 = Clock::time_point{} + std::chrono::hours(1);
+    state.Put(OpenVerifyResumeState::Key("c1", "/f"), {"a:1094", 1}, std::chrono::seconds(5), t0);
+
+    OpenVerifyResumeState::Entry e;
+    Expect(!state.Take(OpenVerifyResumeState::Key("c2", "/f"), e, t0), "Keys: other clients do not see the state");
+    Expect(!state.Take(OpenVerifyResumeState::Key("c1", "/g"), e, t0), "Keys: other paths do not see the state");
+    Expect(state.Take(OpenVerifyResumeState::Key("c1", "/f"), e, t0), "Keys: the stalled open's key does");
+}
+
+void Test_EntriesExpire() {
+    setenv("XRD_OPENVERIFY_RESUME_TTL_S", "10", 1);
+    OpenVerifyResumeState state;
+    const auto t0 = Clock::time_point{} + std::chrono::hours(1);
+    state.Put("k", {"a:1094", 1}, std::chrono::seconds(5), t0);
+
+    OpenVerifyResumeState::Entry e;
+    Expect(!state.Take("k", e, t0 + std::chrono::seconds(16)), "Expiry: stale state is not resumed");
+    Expect(state.Size() == 0, "Expiry: a stale entry is dropped when looked up");
+    unsetenv("XRD_OPENVERIFY_RESUME_TTL_S");
+}
+
+void Test_CapacityDropsOldest() {
+    setenv("XRD_OPENVERIFY_RESUME_MAX", "2", 1);
+    OpenVerifyResumeState state;
+    const auto t0 = Clock::time_point{} + std::chrono::hours(1);
+    state.Put("k1", {"a", 1}, std::chrono::seconds(5), t0);
+    state.Put("k2", {"b", 1}, std::chrono::seconds(5), t0);
+    state.Put("k3", {"c", 1}, std::chrono::seconds(5), t0);
+
+    OpenVerifyResumeState::Entry e;
+    Expect(state.Size() == 2, "Capacity: no more than the configured entries are kept");
+    Expect(!state.Take("k1", e, t0), "Capacity: the oldest entry is dropped");
+    Expect(state.Take("k3", e, t0) && e.tried_hosts == "c", "Capacity: the newest entry is kept");
+    unsetenv("XRD_OPENVERIFY_RESUME_MAX");
+}
+
+}  // namespace
+
+int main() {
+    Test_RetryResumesStalledOpen();
+    Test_KeysSeparateClientsAndPaths();
+    Test_EntriesExpire();
+    Test_CapacityDropsOldest();
+
+    if (g_failures) {
+        std::cerr << g_failures << " test(s) failed.\n";
+        return 1;
+    }
+    std::cout << "All tests passed.\n";
+    return 0;
+}
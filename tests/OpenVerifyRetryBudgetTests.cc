@@ -0,0 +1,100 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "OpenVerifyRetryBudget.hh"
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+int g_failures = 0;
+
+void Expect(bool cond, const std::string& msg) {
+    if (!cond) {
+        ++g_failures;
+        std::cerr << "FAIL: " << msg << "\n";
+    }
+}
+
+void Configure(int percent, int min_per_sec, int ttl_s) {
+    setenv("XRD_OPENVERIFY_RETRY_BUDGET_PERCENT", std::to_string(percent).c_str(), 1);
+    setenv("XRD_OPENVERIFY_RETRY_BUDGET_MIN_PER_SEC", std::to_string(min_per_sec).c_str(), 1);
+    setenv("XRD_OPENVERIFY_RETRY_BUDGET_TTL_S", std::to_string(ttl_s).c_str(), 1);
+}
+
+int Drain(OpenVerifyRetryBudget& budget, Clock::time_point t) {
+    int granted = 0;
+    while (granted < 10000 && budget.TryWithdraw(t)) ++granted;
+    return granted;
+}
+
+void Test_ReserveAllowsRetriesWithoutTraffic() {
+    Configure(20, 1, 10);
+    OpenVerifyMetrics metrics;
+    OpenVerifyRetryBudget budget(metrics);
+    const auto t0 = Clock::time_point{} + std::chrono::hours(1);
+    Expect(Drain(budget, t0) == 10, "ReserveAllowsRetries: min_per_sec * ttl retries without deposits");
+    Expect(!budget.TryWithdraw(t0), "ReserveAllowsRetries: budget should then be exhausted");
+}
+
+void Test_DepositsFundAFractionOfRetries() {
+    Configure(20, 1, 10);
+    OpenVerifyMetrics metrics;
+    OpenVerifyRetryBudget budget(metrics);
+    const auto t0 = Clock::time_point{} + std::chrono::hours(1);
+    for (int i = 0; i < 100; ++i) budget.Deposit(t0);
+    Expect(Drain(budget, t0) == 30, "DepositsFund: 20% of 100 first attempts plus the reserve of 10");
+}
+
+void Test_WithdrawalsExpireWithTheWindow() {
+    Configure(20, 1, 10);
+    OpenVerifyMetrics metrics;
+    OpenVerifyRetryBudget budget(metrics);
+    const auto t0 = Clock::time_point{} + std::chrono::hours(1);
+    for (int i = 0; i < 50; ++i) budget.Deposit(t0);
+    Drain(budget, t0);
+    Expect(!budget.TryWithdraw(t0 + std::chrono::seconds(5)), "WindowExpiry: still exhausted inside the window");
+    const auto later = t0 + std::chrono::seconds(11);
+    Expect(budget.Balance(later) == 10.0, "WindowExpiry: only the reserve remains after the window");
+    Expect(budget.TryWithdraw(later), "WindowExpiry: retries are allowed again");
+}
+
+void Test_ExpositionCountsBudgetUse() {
+    Configure(20, 1, 10);
+    OpenVerifyMetrics metrics;
+    OpenVerifyRetryBudget budget(metrics);
+    const auto t0 = Clock::time_point{} + std::chrono::hours(1);
+    budget.Deposit(t0);
+    Drain(budget, t0);
+    const std::string body = metrics.BuildExpositionBody();
+    Expect(body.find("xrootd_openverify_retry_budget_total{result=\"deposited\"} 1\n") != std::string::npos,
+           "Exposition: one deposit");
+    Expect(body.find("xrootd_openverify_retry_budget_total{result=\"withdrawn\"} 10\n") != std::string::npos,
+           "Exposition: ten retries granted");
+    Expect(body.find("xrootd_openverify_retry_budget_total{result=\"exhausted\"} 1\n") != std::string::npos,
+           "Exposition: one retry refused");
+    Expect(body.find("# TYPE xrootd_openverify_retry_budget_balance gauge\n") != std::string::npos,
+           "Exposition: balance gauge is exported");
+}
+
+}  // namespace
+
+int main() {
+    // Unlabelled samples and no metrics file.
+    setenv("XRD_OPENVERIFY_METRICS_PATH", "", 1);
+    setenv("XRD_OPENVERIFY_METRICS_INSTANCE", "", 1);
+
+    Test_ReserveAllowsRetriesWithoutTraffic();
+    Test_DepositsFundAFractionOfRetries();
+    Test_WithdrawalsExpireWithTheWindow();
+    Test_ExpositionCountsBudgetUse();
+
+    if (g_failures) {
+        std::cerr << g_failures << " test(s) failed.\n";
+        return 1;
+    }
+    std::cout << "All tests passed.\n";
+    return 0;
+}
@@ -1,8 +1,10 @@
 #include <chrono>
 #include <future>
 #include <iostream>
+#include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "OpenVerifySingleFlight.hh"
 
@@ -22,6 +24,16 @@ void ConfigureSmallLimits(int queue_timeout_ms = 120, int verify_timeout_ms = 10
     setenv("XRD_OPENVERIFY_MAX_WAITERS", "1", 1);
     setenv("XRD_OPENVERIFY_QUEUE_TIMEOUT_MS", std::to_string(queue_timeout_ms).c_str(), 1);
     setenv("XRD_OPENVERIFY_VERIFY_TIMEOUT_MS", std::to_string(verify_timeout_ms).c_str(), 1);
+    unsetenv("XRD_OPENVERIFY_MAX_INFLIGHT_PER_HOST");
+    unsetenv("XRD_OPENVERIFY_MAX_WAITERS_PER_HOST");
+}
+
+void ConfigureBulkheads(int inflight, int waiters, int per_host_inflight, int per_host_waiters) {
+    setenv("XRD_OPENVERIFY_MAX_INFLIGHT", std::to_string(inflight).c_str(), 1);
+    setenv("XRD_OPENVERIFY_MAX_WAITERS", std::to_string(waiters).c_str(), 1);
+    setenv("XRD_OPENVERIFY_MAX_INFLIGHT_PER_HOST", std::to_string(per_host_inflight).c_str(), 1);
+    setenv("XRD_OPENVERIFY_MAX_WAITERS_PER_HOST", std::to_string(per_host_waiters).c_str(), 1);
+    setenv("XRD_OPENVERIFY_QUEUE_TIMEOUT_MS", "2000", 1);
 }
 
 void Test_WaitSlotReleasedAfterQueueTimeout() {
@@ -35,7 +47,7 @@ void Test_WaitSlotReleasedAfterQueueTimeout() {
 
     // Keep k1 in-flight so later requests must queue behind it.
     auto leader = std::async(std::launch::async, [&]() {
-        return sf.Run("k1", [&]() {
+        return sf.Run("k1", "h", [&]() {
             release_signal.wait();
             return XrdCl::XRootDStatus{};
         });
@@ -44,7 +56,7 @@ void Test_WaitSlotReleasedAfterQueueTimeout() {
     std::this_thread::sleep_for(std::chrono::milliseconds(20));
 
     auto waiter1 = std::async(std::launch::async, [&]() {
-        return sf.Run("k2", [&]() { return XrdCl::XRootDStatus{}; });
+        return sf.Run("k2", "h", [&]() { return XrdCl::XRootDStatus{}; });
     });
     const auto r1 = waiter1.get();
     // k2 should wait for in-flight capacity and eventually hit queue timeout.
@@ -52,7 +64,7 @@ void Test_WaitSlotReleasedAfterQueueTimeout() {
            "first waiter should timeout while waiting for in-flight slot");
 
     auto waiter2 = std::async(std::launch::async, [&]() {
-        return sf.Run("k3", [&]() { return XrdCl::XRootDStatus{}; });
+        return sf.Run("k3", "h", [&]() { return XrdCl::XRootDStatus{}; });
     });
     const auto r2 = waiter2.get();
     // If waiter bookkeeping is correct, k3 can also occupy the wait slot and timeout.
@@ -78,7 +90,7 @@ void Test_WaitSlotReleasedOnWaitToInFlightTransition() {
 
     // k1 starts first and holds the in-flight slot.
     auto leader = std::async(std::launch::async, [&]() {
-        return sf.Run("k1", [&]() {
+        return sf.Run("k1", "h", [&]() {
             leader_signal.wait();
             return XrdCl::XRootDStatus{};
         });
@@ -88,7 +100,7 @@ void Test_WaitSlotReleasedOnWaitToInFlightTransition() {
 
     // k2 should initially be a waiter, then become in-flight after k1 releases.
     auto second = std::async(std::launch::async, [&]() {
-        return sf.Run("k2", [&]() {
+        return sf.Run("k2", "h", [&]() {
             second_signal.wait();
             return XrdCl::XRootDStatus{};
         });
@@ -100,7 +112,7 @@ void Test_WaitSlotReleasedOnWaitToInFlightTransition() {
 
     // k3 arrives while k2 is in-flight; it should be able to wait (not queue_full) then timeout.
     auto third = std::async(std::launch::async, [&]() {
-        return sf.Run("k3", [&]() { return XrdCl::XRootDStatus{}; });
+        return sf.Run("k3", "h", [&]() { return XrdCl::XRootDStatus{}; });
     });
     const auto t = third.get();
     Expect(!t.IsOK() && t.GetErrorMessage() == "openverify_queue_timeout",
@@ -114,11 +126,478 @@ void Test_WaitSlotReleasedOnWaitToInFlightTransition() {
     Expect(r2.IsOK(), "second should succeed after becoming in-flight");
 }
 
+void Test_OccupancyGauges() {
+    ConfigureSmallLimits(200);
+    OpenVerifyMetrics metrics;
+    OpenVerifySingleFlight sf(metrics);
+
+    std::promise<void> release_leader;
+    std::shared_future<void> leader_signal(release_leader.get_future());
+
+    // One leader on k1 with two followers, plus a k2 leader parked in the FIFO.
+    auto leader = std::async(std::launch::async, [&]() {
+        return sf.Run("k1", "h", [&]() {
+            leader_signal.wait();
+            return XrdCl::XRootDStatus{};
+        });
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    auto f1 = std::async(std::launch::async, [&]() { return sf.Run("k1", "h", nullptr); });
+    auto f2 = std::async(std::launch::async, [&]() { return sf.Run("k1", "h", nullptr); });
+    auto queued = std::async(std::launch::async, [&]() { return sf.Run("k2", "h", nullptr); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+
+    const std::string body = metrics.BuildExpositionBody();
+    Expect(body.find("xrootd_openverify_singleflight_active_leaders 1\n") != std::string::npos,
+           "one leader should be active");
+    Expect(body.find("xrootd_openverify_singleflight_waiting_leaders 1\n") != std::string::npos,
+           "one leader should be waiting in the FIFO");
+    Expect(body.find("xrootd_openverify_singleflight_inflight_keys 2\n") != std::string::npos,
+           "k1 and k2 should both be in flight");
+    Expect(body.find("xrootd_openverify_singleflight_waiting_followers 2\n") != std::string::npos,
+           "two followers should be waiting");
+    Expect(body.find("xrootd_openverify_singleflight_max_followers_per_key 2\n") != std::string::npos,
+           "k1 should carry both followers");
+
+    release_leader.set_value();
+    leader.get();
+    f1.get();
+    f2.get();
+    queued.get();
+
+    const std::string idle = metrics.BuildExpositionBody();
+    Expect(idle.find("xrootd_openverify_singleflight_inflight_keys 0\n") != std::string::npos,
+           "no keys should remain in flight");
+    Expect(idle.find("xrootd_openverify_singleflight_waiting_followers 0\n") != std::string::npos,
+           "no followers should remain");
+}
+
+void Test_SlowHostDoesNotStarveOthers() {
+    // Plenty of global capacity, but one slot and one queue place per host.
+    ConfigureBulkheads(4, 8, 1, 1);
+    OpenVerifyMetrics metrics;
+    OpenVerifySingleFlight sf(metrics);
+
+    std::promise<void> release_bad;
+    std::shared_future<void> bad_signal(release_bad.get_future());
+    auto stuck = [&]() {
+        bad_signal.wait();
+        return XrdCl::XRootDStatus{};
+    };
+
+    auto bad1 = std::async(std::launch::async, [&]() { return sf.Run("bad/1", "bad:1094", stuck); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    auto bad2 = std::async(std::launch::async, [&]() { return sf.Run("bad/2", "bad:1094", stuck); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    const auto bad3 = sf.Run("bad/3", "bad:1094", stuck);
+    Expect(!bad3.IsOK() && bad3.GetErrorMessage() == "openverify_queue_full",
+           "a host whose queue is full should be rejected without touching other hosts");
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto good = sf.Run("good/1", "good:1094", []() { return XrdCl::XRootDStatus{}; });
+    Expect(good.IsOK(), "healthy host should be verified while the bad host is stuck");
+    Expect(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(500),
+           "healthy host should not wait behind the bad host");
+
+    release_bad.set_value();
+    Expect(bad1.get().IsOK(), "stuck leader should finish once released");
+    Expect(bad2.get().IsOK(), "queued leader for the bad host should run after the first");
+}
+
+void Test_TimeoutsOnOneHostKeepLimitForOthers() {
+    ConfigureBulkheads(8, 32, 2, 8);
+    setenv("XRD_OPENVERIFY_ADAPTIVE_LIMIT", "1", 1);
+    setenv("XRD_OPENVERIFY_INFLIGHT_MIN", "2", 1);
+    OpenVerifyMetrics metrics;
+    OpenVerifySingleFlight sf(metrics);
+    unsetenv("XRD_OPENVERIFY_ADAPTIVE_LIMIT");
+    unsetenv("XRD_OPENVERIFY_INFLIGHT_MIN");
+
+    // A blackholed host: every verify to it times out.
+    auto timed_out = []() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        return XrdCl::XRootDStatus{XrdCl::stError, XrdCl::errOperationExpired, 0, "timeout"};
+    };
+    std::vector<std::future<void>> bad;
+    for (int t = 0; t < 2; ++t) {
+        bad.push_back(std::async(std::launch::async, [&, t]() {
+            for (int i = 0; i < 30; ++i) {
+                sf.Run("bad/" + std::to_string(t) + "/" + std::to_string(i), "bad:1094", timed_out);
+            }
+        }));
+    }
+    for (auto& f : bad) f.get();
+    Expect(metrics.BuildExpositionBody().find("xrootd_openverify_concurrency_limit 8\n") != std::string::npos,
+           "timeouts on one host leave the global limit alone");
+
+    // The other hosts still get the remaining global slots at once.
+    std::promise<void> release;
+    std::shared_future<void> released(release.get_future());
+    std::vector<std::future<XrdCl::XRootDStatus>> good;
+    for (int h = 0; h < 3; ++h) {
+        for (int i = 0; i < 2; ++i) {
+            const std::string host = "good" + std::to_string(h);
+            good.push_back(std::async(std::launch::async, [&, host, i]() {
+                return sf.Run(host + "/" + std::to_string(i), host + ":1094", [&]() {
+                    released.wait();
+                    return XrdCl::XRootDStatus{};
+                });
+            }));
+        }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    Expect(metrics.BuildExpositionBody().find("xrootd_openverify_singleflight_active_leaders 6\n") !=
+               std::string::npos,
+           "healthy partitions run side by side after the bad host's timeouts");
+    release.set_value();
+    for (auto& f : good) Expect(f.get().IsOK(), "healthy verifies succeed");
+}
+
+void Test_RoundRobinAcrossHosts() {
+    // One global slot, so admission order is fully determined by the dispatcher.
+    ConfigureBulkheads(1, 8, 4, 8);
+    OpenVerifyMetrics metrics;
+    OpenVerifySingleFlight sf(metrics);
+
+    std::mutex order_mtx;
+    std::vector<std::string> order;
+    auto record = [&](const std::string& name) {
+        return [&, name]() {
+            std::lock_guard<std::mutex> lk(order_mtx);
+            order.push_back(name);
+            return XrdCl::XRootDStatus{};
+        };
+    };
+
+    std::promise<void> release_first;
+    std::shared_future<void> first_signal(release_first.get_future());
+    auto first = std::async(std::launch::async, [&]() {
+        return sf.Run("a/0", "a:1094", [&]() {
+            first_signal.wait();
+            return XrdCl::XRootDStatus{};
+        });
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    std::vector<std::future<XrdCl::XRootDStatus>> queued;
+    for (const std::string name : {"a/1", "a/2", "b/1"}) {
+        const std::string host = name.substr(0, 1) + ":1094";
+        queued.push_back(
+            std::async(std::launch::async, [&, name, host]() { return sf.Run(name, host, record(name)); }));
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    release_first.set_value();
+    first.get();
+    for (auto& f : queued) Expect(f.get().IsOK(), "queued leader should be admitted");
+
+    Expect(order == std::vector<std::string>({"a/1", "b/1", "a/2"}),
+           "hosts should be served round-robin, FIFO within a host");
+}
+
+void Test_CoDelShedsStaleWaitersAndServesNewest() {
+    ConfigureBulkheads(1, 8, 4, 8);
+    setenv("XRD_OPENVERIFY_CODEL", "1", 1);
+    setenv("XRD_OPENVERIFY_CODEL_TARGET_MS", "60", 1);
+    setenv("XRD_OPENVERIFY_CODEL_INTERVAL_MS", "120", 1);
+    OpenVerifyMetrics metrics;
+    OpenVerifySingleFlight sf(metrics);
+    unsetenv("XRD_OPENVERIFY_CODEL");
+
+    auto sleeper = [](int ms) {
+        return [ms]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+            return XrdCl::XRootDStatus{};
+        };
+    };
+
+    // t=0: a/0 holds the only slot for 200 ms; a/1 queues behind it and waits ~200 ms, well
+    // over target, then runs 150 ms. a/2 (t~210) and a/3 (t~340) queue while a/1 runs.
+    auto a0 = std::async(std::launch::async, [&]() { return sf.Run("a/0", "a:1094", sleeper(200)); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    auto a1 = std::async(std::launch::async, [&]() { return sf.Run("a/1", "a:1094", sleeper(150)); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(205));
+    auto a2 = std::async(std::launch::async, [&]() { return sf.Run("a/2", "a:1094", sleeper(0)); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(130));
+    auto a3 = std::async(std::launch::async, [&]() { return sf.Run("a/3", "a:1094", sleeper(0)); });
+
+    Expect(a0.get().IsOK(), "first leader runs");
+    Expect(a1.get().IsOK(), "second leader is admitted before overload is detected");
+    // When a/1 finishes (t~355) the interval has closed with a minimum sojourn of ~200 ms.
+    const auto r2 = a2.get();
+    Expect(!r2.IsOK() && r2.GetErrorMessage() == "openverify_queue_shed",
+           "waiter older than target is shed under overload");
+    Expect(a3.get().IsOK(), "fresh waiter is served under overload");
+
+    const std::string body = metrics.BuildExpositionBody();
+    Expect(body.find("xrootd_openverify_queue_admissions_total{result=\"shed\"} 1\n") != std::string::npos,
+           "shed waiter is counted");
+    Expect(body.find("xrootd_openverify_queue_overloaded 1\n") != std::string::npos, "overload gauge is set");
+}
+
+void Test_WeightedFairShareAcrossClasses() {
+    ConfigureBulkheads(1, 64, 8, 64);
+    setenv("XRD_OPENVERIFY_FAIR_WEIGHTS", "prod=3", 1);
+    OpenVerifyMetrics metrics;
+    OpenVerifySingleFlight sf(metrics);
+    unsetenv("XRD_OPENVERIFY_FAIR_WEIGHTS");
+
+    std::mutex order_mtx;
+    std::vector<std::string> order;
+    auto record = [&](const std::string& name) {
+        return [&, name]() {
+            std::lock_guard<std::mutex> lk(order_mtx);
+            order.push_back(name);
+            return XrdCl::XRootDStatus{};
+        };
+    };
+
+    std::promise<void> release_first;
+    std::shared_future<void> first_signal(release_first.get_future());
+    auto first = std::async(std::launch::async, [&]() {
+        return sf.Run("hold", "h:1094", "prod", [&]() {
+            first_signal.wait();
+            return XrdCl::XRootDStatus{};
+        });
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    // The analysis class queues first, then production; both on the same host.
+    std::vector<std::future<XrdCl::XRootDStatus>> queued;
+    for (const std::string cls : {"ana", "prod"}) {
+        for (int i = 1; i <= 6; ++i) {
+            const std::string name = cls + std::to_string(i);
+            queued.push_back(
+                std::async(std::launch::async, [&, name, cls]() { return sf.Run(name, "h:1094", cls, record(name)); }));
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    release_first.set_value();
+    first.get();
+    for (auto& f : queued) Expect(f.get().IsOK(), "queued leader should be admitted");
+
+    const std::vector<std::string> expected = {"ana1", "prod1", "prod2", "prod3", "ana2", "prod4", "prod5", "prod6"};
+    Expect(order.size() == 12 && std::vector<std::string>(order.begin(), order.begin() + 8) == expected,
+           "weight 3 class should get three admissions per turn of the weight 1 class");
+
+    const std::string body = metrics.BuildExpositionBody();
+    Expect(body.find("xrootd_openverify_class_queue_wait_seconds_count{class=\"prod\"} 7\n") != std::string::npos,
+           "queue wait should be exported per class");
+}
+
+void Test_FloodingClassIsPushedOutOfFullBacklog() {
+    ConfigureBulkheads(1, 4, 8, 64);
+    OpenVerifyMetrics metrics;
+    OpenVerifySingleFlight sf(metrics);
+
+    std::promise<void> release_first;
+    std::shared_future<void> first_signal(release_first.get_future());
+    auto first = std::async(std::launch::async, [&]() {
+        return sf.Run("hold", "h:1094", "ana", [&]() {
+            first_signal.wait();
+            return XrdCl::XRootDStatus{};
+        });
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    auto ok = []() { return XrdCl::XRootDStatus{}; };
+    std::vector<std::future<XrdCl::XRootDStatus>> ana;
+    for (int i = 1; i <= 4; ++i) {
+        const std::string name = "ana" + std::to_string(i);
+        ana.push_back(std::async(std::launch::async, [&, name]() { return sf.Run(name, "h:1094", "ana", ok); }));
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    auto prod = std::async(std::launch::async, [&]() { return sf.Run("prod1", "h:1094", "prod", ok); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    const auto ana5 = sf.Run("ana5", "h:1094", "ana", ok);
+    Expect(!ana5.IsOK() && ana5.GetErrorMessage() == "openverify_queue_full",
+           "the flooding class cannot push out its own waiters");
+    Expect(OpenVerifySingleFlight::IsOverloaded(ana5), "a refused admission is reported as overload");
+    Expect(!OpenVerifySingleFlight::IsWaitExpired(ana5), "a refused admission is not an expired wait");
+
+    release_first.set_value();
+    first.get();
+    Expect(prod.get().IsOK(), "a newcomer from another class gets a place in the full backlog");
+    const auto ana4 = ana[3].get();
+    Expect(!ana4.IsOK() && ana4.GetErrorMessage() == "openverify_queue_full",
+           "the newest waiter of the longest class is pushed out");
+    for (int i = 0; i < 3; ++i) Expect(ana[i].get().IsOK(), "older waiters of the flooding class are kept");
+}
+
+void Test_FollowerTimeout() {
+    ConfigureSmallLimits(2000);
+    setenv("XRD_OPENVERIFY_FOLLOWER_TIMEOUT_MS", "100", 1);
+    OpenVerifyMetrics metrics;
+    OpenVerifySingleFlight sf(metrics);
+
+    std::promise<void> release;
+    std::shared_future<void> release_signal(release.get_future());
+    auto leader = std::async(std::launch::async, [&]() {
+        return sf.Run("k", "h", [&]() {
+            release_signal.wait();
+            return XrdCl::XRootDStatus{};
+        });
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    auto follower = std::async(std::launch::async, [&]() { return sf.Run("k", "h", nullptr); });
+    const auto fst = follower.get();
+    Expect(!fst.IsOK() && fst.GetErrorMessage() == "openverify_follower_timeout",
+           "follower should give up after its own deadline");
+    Expect(OpenVerifySingleFlight::IsWaitExpired(fst), "follower timeout counts as an expired wait");
+
+    release.set_value();
+    Expect(leader.get().IsOK(), "the leader still gets its verify's result");
+
+    const std::string body = metrics.BuildExpositionBody();
+    Expect(body.find("xrootd_openverify_singleflight_timeouts_total{role=\"follower\"} 1\n") != std::string::npos,
+           "follower timeout should be counted");
+    unsetenv("XRD_OPENVERIFY_FOLLOWER_TIMEOUT_MS");
+}
+
+void Test_CallerDeadlineBoundsWaits() {
+    ConfigureSmallLimits(2000);
+    OpenVerifyMetrics metrics;
+    OpenVerifySingleFlight sf(metrics);
+
+    std::promise<void> release_leader;
+    std::shared_future<void> leader_signal(release_leader.get_future());
+    auto leader = std::async(std::launch::async, [&]() {
+        return sf.Run("k1", "h", [&]() {
+            leader_signal.wait();
+            return XrdCl::XRootDStatus{};
+        });
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto deadline = start + std::chrono::milliseconds(100);
+    auto follower = std::async(std::launch::async, [&]() { return sf.Run("k1", "h", "", deadline, nullptr); });
+    auto queued = std::async(std::launch::async, [&]() {
+        return sf.Run("k2", "h", "", deadline, []() { return XrdCl::XRootDStatus{}; });
+    });
+
+    const auto fst = follower.get();
+    const auto qst = queued.get();
+    const auto waited = std::chrono::steady_clock::now() - start;
+    Expect(!fst.IsOK() && fst.GetErrorMessage() == "openverify_follower_timeout",
+           "follower should stop waiting at the caller's deadline");
+    Expect(!qst.IsOK() && qst.GetErrorMessage() == "openverify_queue_timeout",
+           "queued leader should stop waiting at the caller's deadline");
+    Expect(waited < std::chrono::milliseconds(1000), "deadline should cut both waits well short of their timeouts");
+
+    release_leader.set_value();
+    Expect(leader.get().IsOK(), "leader without a deadline should still finish");
+}
+
+// A leader with a short deadline keeps its verify going for a follower with a longer one.
+void Test_VerifyDeadlineCoversFollowers() {
+    ConfigureSmallLimits(2000);
+    OpenVerifyMetrics metrics;
+    OpenVerifySingleFlight sf(metrics);
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto leader_deadline = start + std::chrono::milliseconds(50);
+    const auto follower_deadline = start + std::chrono::seconds(5);
+    std::promise<void> follower_joined;
+    std::shared_future<void> joined_signal(follower_joined.get_future());
+    std::chrono::steady_clock::time_point alone;
+    std::chrono::steady_clock::time_point followed;
+    auto leader = std::async(std::launch::async, [&]() {
+        return sf.Run("k", "h", "", leader_deadline, [&]() {
+            alone = sf.VerifyDeadline("k");
+            joined_signal.wait();
+            followed = sf.VerifyDeadline("k");
+            return XrdCl::XRootDStatus{};
+        });
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    auto follower = std::async(std::launch::async, [&]() { return sf.Run("k", "h", "", follower_deadline, nullptr); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    follower_joined.set_value();
+
+    Expect(leader.get().IsOK() && follower.get().IsOK(), "leader and follower share the verdict");
+    Expect(alone == leader_deadline, "an unshared verify runs to its leader's deadline");
+    Expect(followed == follower_deadline, "a shared verify runs to the last waiter's deadline");
+    Expect(sf.VerifyDeadline("k") == std::chrono::steady_clock::time_point::max(), "no deadline once finished");
+}
+
+// A detached verify kept alive by arriving followers does not hold its leader past the leader's
+// own deadline; the followers still get its verdict.
+void Test_DetachedLeaderReturnsByOwnDeadline() {
+    ConfigureSmallLimits(2000);
+    OpenVerifyMetrics metrics;
+    OpenVerifySingleFlight sf(metrics);
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto leader_deadline = start + std::chrono::milliseconds(100);
+    std::promise<void> release;
+    std::shared_future<void> release_signal(release.get_future());
+    std::thread verifier;
+    std::chrono::steady_clock::time_point leader_returned;
+    auto leader = std::async(std::launch::async, [&]() {
+        const auto st = sf.RunDetached("k", "h", "", leader_deadline, [&](OpenVerifySingleFlight::Done done) {
+            verifier = std::thread([release_signal, done]() {
+                release_signal.wait();
+                done(XrdCl::XRootDStatus{});
+            });
+        });
+        leader_returned = std::chrono::steady_clock::now();
+        return st;
+    });
+
+    std::vector<std::future<XrdCl::XRootDStatus>> followers;
+    while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(300)) {
+        followers.push_back(std::async(std::launch::async, [&]() {
+            return sf.Run("k", "h", "", start + std::chrono::seconds(5), nullptr);
+        }));
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    const auto lst = leader.get();
+    Expect(!lst.IsOK() && lst.GetErrorMessage() == "openverify_leader_timeout",
+           "leader should stop waiting at its own deadline");
+    Expect(OpenVerifySingleFlight::IsWaitExpired(lst), "leader timeout counts as an expired wait");
+    Expect(leader_returned - start < std::chrono::milliseconds(250),
+           "arriving followers should not hold the leader past its deadline");
+    Expect(sf.VerifyDeadline("k") == start + std::chrono::seconds(5), "the verify runs on for the followers");
+
+    release.set_value();
+    for (auto& f : followers) Expect(f.get().IsOK(), "followers get the detached verify's verdict");
+    sf.Drain();
+    verifier.join();
+    Expect(sf.VerifyDeadline("k") == std::chrono::steady_clock::time_point::max(), "no deadline once finished");
+
+    const std::string body = metrics.BuildExpositionBody();
+    Expect(body.find("xrootd_openverify_singleflight_timeouts_total{role=\"leader\"} 1\n") != std::string::npos,
+           "leader timeout should be counted");
+}
+
 }  // namespace
 
 int main() {
+    // Unlabelled samples and no metrics file.
+    setenv("XRD_OPENVERIFY_METRICS_PATH", "", 1);
+    setenv("XRD_OPENVERIFY_METRICS_INSTANCE", "", 1);
+
     Test_WaitSlotReleasedAfterQueueTimeout();
     Test_WaitSlotReleasedOnWaitToInFlightTransition();
+    Test_OccupancyGauges();
+    Test_SlowHostDoesNotStarveOthers();
+    Test_TimeoutsOnOneHostKeepLimitForOthers();
+    Test_RoundRobinAcrossHosts();
+    Test_CoDelShedsStaleWaitersAndServesNewest();
+    Test_WeightedFairShareAcrossClasses();
+    Test_FloodingClassIsPushedOutOfFullBacklog();
+    Test_FollowerTimeout();
+    Test_CallerDeadlineBoundsWaits();
+    Test_VerifyDeadlineCoversFollowers();
+    Test_DetachedLeaderReturnsByOwnDeadline();
 
     if (g_failures) {
         std::cerr << g_failures << " test(s) failed.\n";
@@ -0,0 +1,51 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "OpenVerifyStripedCounter.hh"
+
+namespace {
+
+int g_failures = 0;
+
+void Expect(bool cond, const std::string& msg) {
+    if (!cond) {
+        ++g_failures;
+        std::cerr << "FAIL: " << msg << "\n";
+    }
+}
+
+void Test_StripeCountRoundsToPowerOfTwo() {
+    Expect(OpenVerifyStripedCounter(1).Stripes() == 1, "Stripes: 1 stays 1");
+    Expect(OpenVerifyStripedCounter(5).Stripes() == 8, "Stripes: 5 rounds up to 8");
+    Expect(OpenVerifyStripedCounter(1000).Stripes() == OpenVerifyStripedCounter::kMaxStripes,
+           "Stripes: capped at kMaxStripes");
+}
+
+void Test_ConcurrentAddsSumExactly() {
+    OpenVerifyStripedCounter counter(4);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 10000; ++i) counter.Add();
+        });
+    }
+    for (auto& t : threads) t.join();
+    counter.Add(5);
+    Expect(counter.Load() == 80005, "ConcurrentAdds: sum over all slots must be exact");
+}
+
+}  // namespace
+
+int main() {
+    Test_StripeCountRoundsToPowerOfTwo();
+    Test_ConcurrentAddsSumExactly();
+
+    if (g_failures) {
+        std::cerr << g_failures << " test(s) failed.\n";
+        return 1;
+    }
+    std::cout << "All tests passed.\n";
+    return 0;
+}
@@ -0,0 +1,173 @@
+#include <coroutine>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "OpenVerifyTask.hh"
+#include "OpenVerifyXrdClAwait.hh"
+
+namespace {
+
+int g_failures = 0;
+
+void Expect(bool cond, const std::string& msg) {
+    if (!cond) {
+        ++g_failures;
+        std::cerr << "FAIL: " << msg << "\n";
+    }
+}
+
+// Runs `task` to its end and returns its value, or rethrows its exception.
+template <typename T>
+T RunToEnd(OpenVerifyTask<T> task) {
+    auto result = std::make_shared<std::promise<T>>();
+    auto value = result->get_future();
+    StartDetached(std::move(task), [result](OpenVerifyTask<T>& t) {
+        try {
+            result->set_value(t.Result());
+        } catch (...) {
+            result->set_exception(std::current_exception());
+        }
+    });
+    return value.get();
+}
+
+// Suspends the awaiting coroutine and resumes it from a new thread.
+struct ResumeOnNewThread {
+    std::thread* thread;
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h) {
+        *thread = std::thread([h] { h.resume(); });
+    }
+    void await_resume() noexcept {}
+};
+
+OpenVerifyTask<int> Value(int v) {
+    co_return v;
+}
+
+OpenVerifyTask<int> Sum() {
+    const int a = co_await Value(2);
+    const int b = co_await Value(3);
+    co_return a + b;
+}
+
+OpenVerifyTask<int> Throws() {
+    throw std::runtime_error("boom");
+    co_return 0;
+}
+
+OpenVerifyTask<int> CatchesInner() {
+    try {
+        co_await Throws();
+    } catch (const std::runtime_error&) {
+        co_return 1;
+    }
+    co_return 0;
+}
+
+OpenVerifyTask<std::thread::id> HopThread(std::thread* t) {
+    co_await ResumeOnNewThread{t};
+    co_return std::this_thread::get_id();
+}
+
+OpenVerifyTask<int> DeepChain(int depth) {
+    if (depth == 0) co_return 0;
+    co_return 1 + co_await DeepChain(depth - 1);
+}
+
+void Test_ReturnsValue() {
+    Expect(RunToEnd(Value(7)) == 7, "the task's value should come back");
+    Expect(RunToEnd(Sum()) == 5, "awaited subtasks should pass their values up");
+}
+
+void Test_ExceptionsReachTheAwaiter() {
+    Expect(RunToEnd(CatchesInner()) == 1, "an awaiting task should be able to catch a subtask's exception");
+    bool caught = false;
+    try {
+        RunToEnd(Throws());
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    Expect(caught, "the task's exception should come back");
+}
+
+void Test_ResumedFromAnotherThread() {
+    std::thread t;
+    const auto resumed_on = RunToEnd(HopThread(&t));
+    t.join();
+    Expect(resumed_on != std::this_thread::get_id(), "the task should finish on the thread that resumed it");
+}
+
+void Test_LazyStart() {
+    bool ran = false;
+    auto body = [&]() -> OpenVerifyTask<int> {
+        ran = true;
+        co_return 1;
+    };
+    auto task = body();
+    Expect(!ran, "a task should not run before it is awaited");
+    Expect(RunToEnd(std::move(task)) == 1 && ran, "StartDetached should start the task");
+}
+
+void Test_DeepChain() {
+    Expect(RunToEnd(DeepChain(1000)) == 1000, "a chain of awaited tasks should unwind with every value");
+}
+
+// The awaitable with a fake XrdCl: the "request" completes on another thread.
+void Test_XrdClAwaitableResumesOnResponder() {
+    std::thread responder;
+    std::thread::id responder_id;
+    std::thread::id resumed_on;
+
+    auto flow = [&]() -> OpenVerifyTask<int> {
+        auto r = co_await XrdClAwaitable<void>([&](XrdCl::ResponseHandler* h) {
+            responder = std::thread([h, &responder_id] {
+                responder_id = std::this_thread::get_id();
+                h->HandleResponse(new XrdCl::XRootDStatus(), nullptr);
+            });
+            return XrdCl::XRootDStatus();
+        });
+        resumed_on = std::this_thread::get_id();
+        co_return r.status.IsOK() ? 1 : 0;
+    };
+    Expect(RunToEnd(flow()) == 1, "the response status should reach the coroutine");
+    responder.join();
+    Expect(resumed_on == responder_id, "the coroutine should resume on the thread that delivered the response");
+}
+
+void Test_XrdClAwaitableRefusedCall() {
+    bool issued = false;
+    auto flow = [&]() -> OpenVerifyTask<int> {
+        auto r = co_await XrdClAwaitable<void>([&](XrdCl::ResponseHandler*) {
+            issued = true;
+            return XrdCl::XRootDStatus(XrdCl::stError, XrdCl::errInvalidArgs);
+        });
+        co_return r.status.IsOK() ? 0 : r.status.code;
+    };
+    Expect(RunToEnd(flow()) == XrdCl::errInvalidArgs, "a call XrdCl refuses should complete with its status");
+    Expect(issued, "the call should have been issued");
+}
+
+}  // namespace
+
+int main() {
+    Test_ReturnsValue();
+    Test_ExceptionsReachTheAwaiter();
+    Test_ResumedFromAnotherThread();
+    Test_LazyStart();
+    Test_DeepChain();
+    Test_XrdClAwaitableResumesOnResponder();
+    Test_XrdClAwaitableRefusedCall();
+
+    if (g_failures) {
+        std::cerr << g_failures << " test(s) failed.\n";
+        return 1;
+    }
+    std::cout << "All tests passed.\n";
+    return 0;
+}
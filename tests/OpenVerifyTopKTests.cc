@@ -0,0 +1,121 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "OpenVerifyMetrics.hh"
+#include "OpenVerifyTopK.hh"
+
+namespace {
+
+int g_failures = 0;
+
+void Expect(bool cond, const std::string& msg) {
+    if (!cond) {
+        ++g_failures;
+        std::cerr << "FAIL: " << msg << "\n";
+    }
+}
+
+struct Count {
+    uint64_t n{0};
+};
+
+const OpenVerifyTopK<Count>::Slot* Find(const OpenVerifyTopK<Count>& topk, const std::string& key) {
+    for (const auto& s : topk.Slots()) {
+        if (s.key == key) return &s;
+    }
+    return nullptr;
+}
+
+void Test_HeavyHittersSurviveChurn() {
+    OpenVerifyTopK<Count> topk(3);
+    uint64_t evicted_total = 0;
+    auto on_evict = [&](const OpenVerifyTopK<Count>::Slot& s) { evicted_total += s.payload.n; };
+    auto offer = [&](const std::string& key) { ++topk.Offer(key, on_evict).payload.n; };
+
+    // Two heavy keys interleaved with a long tail of one-off keys.
+    uint64_t total = 0;
+    for (int i = 0; i < 200; ++i) {
+        offer("heavy-a");
+        offer("heavy-b");
+        offer("tail-" + std::to_string(i));
+        total += 3;
+    }
+
+    Expect(topk.Slots().size() == 3, "table must stay at capacity");
+    const auto* a = Find(topk, "heavy-a");
+    const auto* b = Find(topk, "heavy-b");
+    Expect(a && a->payload.n == 200, "heavy-a must keep an exact count");
+    Expect(b && b->payload.n == 200, "heavy-b must keep an exact count");
+
+    uint64_t kept = 0;
+    for (const auto& s : topk.Slots()) {
+        kept += s.payload.n;
+        Expect(s.estimate >= s.payload.n, "estimate is an upper bound of the tracked count");
+        Expect(s.estimate - s.error <= s.payload.n, "estimate minus error is a lower bound");
+    }
+    Expect(kept + evicted_total == total, "evicted payloads plus kept payloads must cover every offer");
+}
+
+void Test_FreshFlag() {
+    OpenVerifyTopK<Count> topk(1);
+    auto ignore = [](const OpenVerifyTopK<Count>::Slot&) {};
+    bool fresh = false;
+    topk.Offer("x", ignore, &fresh);
+    Expect(fresh, "first offer of a key must report a fresh slot");
+    topk.Offer("x", ignore, &fresh);
+    Expect(!fresh, "repeat offer must not report a fresh slot");
+    topk.Offer("y", ignore, &fresh);
+    Expect(fresh, "taking over a slot must report it fresh");
+    Expect(topk.Slots()[0].payload.n == 0, "a taken-over slot starts with an empty payload");
+    Expect(topk.Slots()[0].error == 2, "a taken-over slot inherits the victim's estimate as error");
+}
+
+void Test_FailureSeriesBoundedWithOtherBucket() {
+    // 150 failures over K=4 slots: any target above 150/4 is guaranteed a series.
+    setenv("XRD_OPENVERIFY_FAILURE_HOSTS_MAX", "4", 1);
+    OpenVerifyMetrics metrics;
+    for (int i = 0; i < 50; ++i) {
+        metrics.RecordVerifyFailure("a.example", 1094, "timeout");
+        metrics.RecordVerifyFailure("b.example", 1094, "permission_denied");
+        metrics.RecordVerifyFailure("tail" + std::to_string(i) + ".example", 1094, "timeout");
+    }
+    const std::string body = metrics.BuildExpositionBody();
+    unsetenv("XRD_OPENVERIFY_FAILURE_HOSTS_MAX");
+
+    size_t series = 0;
+    uint64_t sum = 0;
+    for (size_t pos = body.find("\nxrootd_openverify_verify_failures_total{"); pos != std::string::npos;
+         pos = body.find("\nxrootd_openverify_verify_failures_total{", pos + 1)) {
+        ++series;
+        const size_t sp = body.find("} ", pos);
+        sum += std::strtoull(body.c_str() + sp + 2, nullptr, 10);
+    }
+    Expect(series <= 4 + 1, "at most K tracked targets plus one other series per reason");
+    Expect(sum == 150, "failure series must still add up to every recorded failure");
+    Expect(body.find("host=\"a.example\",port=\"1094\",reason=\"timeout\"} 50\n") != std::string::npos,
+           "heavy target a.example must be exported exactly");
+    Expect(body.find("host=\"other\",port=\"none\",reason=\"timeout\"}") != std::string::npos,
+           "tail targets must be folded into host=other");
+    Expect(body.find("runs_total{result=\"failure\"} 150\n") != std::string::npos,
+           "failure run counter is unaffected by the top-K table");
+}
+
+}  // namespace
+
+int main() {
+    setenv("XRD_OPENVERIFY_METRICS_PATH", "", 1);
+    setenv("XRD_OPENVERIFY_METRICS_INSTANCE", "", 1);
+
+    Test_HeavyHittersSurviveChurn();
+    Test_FreshFlag();
+    Test_FailureSeriesBoundedWithOtherBucket();
+
+    if (g_failures) {
+        std::cerr << g_failures << " test(s) failed.\n";
+        return 1;
+    }
+    std::cout << "All tests passed.\n";
+    return 0;
+}